@@ -0,0 +1,476 @@
+//tomergal40@gmail.com
+// Micro benchmarks for the engine hot paths
+//
+// Usage: BenchExec [--iterations N] [--max-threads T] [--max-games G]
+
+#include "../include/Agent.hpp"
+#include "../include/AlphaBeta.hpp"
+#include "../include/Evaluation.hpp"
+#include "../include/Game.hpp"
+#include "../include/GameHost.hpp"
+#include "../include/Ismcts.hpp"
+#include "../include/ParallelMcts.hpp"
+#include "../include/Playout.hpp"
+#include "../include/Tablebase.hpp"
+#include "../include/TimerWheel.hpp"
+#include "../include/TurnFlow.hpp"
+#include "../include/Baron.hpp"
+#include "../include/Spy.hpp"
+#include "../include/Merchant.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace coup;
+
+// Keeps results observable so the measured loops are not optimized away
+static volatile uint64_t sink = 0;
+
+// Runs `body` `iterations` times and returns the average nanoseconds per call
+template <typename Body>
+static double nanosPerCall(uint64_t iterations, Body body) {
+    auto start = chrono::steady_clock::now();
+    for (uint64_t i = 0; i < iterations; ++i) body(i);
+    chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+    return elapsed.count() / static_cast<double>(iterations);
+}
+
+static void report(const string& name, double nanos) {
+    cout << "  " << left << setw(34) << name << right << fixed << setprecision(1) << setw(10) << nanos << " ns" << endl;
+}
+
+// Compares the old role() string checks with the RoleId checks the rules use
+static void benchRoleChecks(uint64_t iterations) {
+    Game game;
+    vector<shared_ptr<Player>> players = {make_shared<Baron>(game, "Baron"), make_shared<Spy>(game, "Spy"),
+                                          make_shared<Merchant>(game, "Merchant")};
+
+    cout << "Role checks (per check):" << endl;
+    report("role() == \"Merchant\"", nanosPerCall(iterations, [&](uint64_t i) {
+        if (players[i % players.size()]->role() == "Merchant") sink = sink + 1;
+    }));
+    report("roleId() == RoleId::Merchant", nanosPerCall(iterations, [&](uint64_t i) {
+        if (players[i % players.size()]->roleId() == RoleId::Merchant) sink = sink + 1;
+    }));
+}
+
+// Baron bribe followed by the Spy's out-of-turn arrest of the Merchant: both
+// actions dispatch on the roles of the players involved
+static void benchActions(uint64_t iterations) {
+    Game game;
+    game.setEventSink(nullptr);
+    auto baron = make_shared<Baron>(game, "Baron");
+    auto spy = make_shared<Spy>(game, "Spy");
+    auto merchant = make_shared<Merchant>(game, "Merchant");
+    game.addPlayer(baron);
+    game.addPlayer(spy);
+    game.addPlayer(merchant);
+    game.startGame();
+    baron->setCoins(5);
+    merchant->setCoins(5);
+    GameState start = game.snapshot();
+
+    double nanos = nanosPerCall(iterations, [&](uint64_t) {
+        game.restore(start);
+        baron->bribe();
+        spy->arrest(*merchant);
+        sink = sink + game.hash();
+    });
+    cout << "Actions (per bribe + arrest, including restore):" << endl;
+    report("Baron::bribe + Spy::arrest", nanos);
+}
+
+// One decision of each heuristic agent on a mid-game position
+static void benchAgents(uint64_t iterations) {
+    const RoleId roles[] = {RoleId::Governor, RoleId::Spy, RoleId::Baron, RoleId::Merchant};
+    GameState state = rules::initialState(roles, 4);
+    state.seat(0).coins = 5;
+    state.seat(1).coins = 7;
+    state.seat(2).coins = 3;
+    state.seat(3).coins = 4;
+    state.seat(1).pending = 1u << static_cast<unsigned>(ActionType::Tax);
+    MoveList legal;
+    rules::legalMoves(state, 0, legal);
+    mt19937_64 rng(1);
+
+    RandomAgent random;
+    GreedyCoinsAgent greedy;
+    CoupFirstAgent coupFirst;
+    RoleAwareAgent roleAware;
+    LinearAgent linear;
+    Agent* agents[] = {&random, &greedy, &coupFirst, &roleAware, &linear};
+    cout << "Agents (per decide):" << endl;
+    for (Agent* agent : agents) {
+        report(agent->name(), nanosPerCall(iterations, [&](uint64_t) {
+            sink = sink + static_cast<uint64_t>(agent->decide(GameView{state, 0, legal, 0, rng}).target + 1);
+        }));
+    }
+}
+
+// Opening of a three player game, the position the search benchmarks use
+static GameState searchPosition() {
+    const RoleId roles[] = {RoleId::Governor, RoleId::Spy, RoleId::Merchant};
+    return rules::initialState(roles, 3);
+}
+
+// ISMCTS playouts per second for growing numbers of root parallel threads
+static void benchIsmcts(uint64_t iterations, unsigned maxThreads) {
+    GameState start = searchPosition();
+
+    cout << "ISMCTS (" << iterations << " iterations per thread):" << endl;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        IsmctsConfig config;
+        config.threads = threads;
+        config.budget.iterations = iterations;
+        SearchResult result = Ismcts(config).search(start, 0);
+        cout << "  " << setw(2) << threads << " threads: " << fixed << setprecision(0) << setw(10)
+             << result.playoutsPerSecond() << " playouts/s" << endl;
+        sink = sink + result.playouts;
+    }
+}
+
+// Shared-tree MCTS iterations per second for growing numbers of threads, all
+// working on the same decision
+static void benchTreeParallel(uint64_t iterations, unsigned maxThreads) {
+    GameState start = searchPosition();
+
+    cout << "Tree parallel MCTS (" << iterations << " iterations per decision):" << endl;
+    double single = 0.0;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        ParallelMctsConfig config;
+        config.threads = threads;
+        config.budget.iterations = iterations;
+        TreeParallelMcts search(config);
+        SearchResult result = search.search(start, 0);
+        if (threads == 1) single = result.playoutsPerSecond();
+        cout << "  " << setw(2) << threads << " threads: " << fixed << setprecision(0) << setw(10)
+             << result.playoutsPerSecond() << " iterations/s  (x" << setprecision(2)
+             << (single > 0.0 ? result.playoutsPerSecond() / single : 0.0) << ", " << search.treeSize()
+             << " nodes)" << endl;
+        sink = sink + result.playouts;
+    }
+}
+
+// Alpha-beta nodes per second on a Spy against Merchant duel
+static void benchAlphaBeta(int depth) {
+    const RoleId roles[] = {RoleId::Spy, RoleId::Merchant};
+    GameState start = rules::initialState(roles, 2);
+    start.seat(0).coins = 2;
+    start.seat(1).coins = 3;
+    start.bank = 95;
+
+    AlphaBetaConfig config;
+    config.maxDepth = depth;
+    AlphaBeta search(config);
+    AlphaBetaResult result = search.search(start, 0);
+    cout << "Alpha-beta (duel, depth " << result.depth << "):" << endl;
+    cout << "  " << result.nodes << " nodes in " << fixed << setprecision(3) << result.seconds << " s: "
+         << setprecision(0) << result.nodesPerSecond() << " nodes/s, best " << toString(result.best.type)
+         << ", value " << result.value << endl;
+    sink = sink + result.nodes;
+}
+
+// Linear evaluation of a batch of mid-game positions, AVX2 against scalar
+static void benchEvaluation(uint64_t iterations) {
+    const size_t positions = 4096;
+    const RoleId roles[] = {RoleId::Governor, RoleId::Spy, RoleId::Baron, RoleId::General, RoleId::Judge, RoleId::Merchant};
+    PositionBatch batch(positions);
+    mt19937_64 rng(1);
+    while (!batch.full()) {
+        GameState state = rules::initialState(roles, 6);
+        randomPlayout(state, randomBelow(rng, 60), 0, rng);
+        batch.add(state, state.currentTurn);
+    }
+    EvalWeights weights = EvalWeights::defaults();
+    vector<float> scores(positions);
+    uint64_t batches = iterations / positions + 1;
+
+    cout << "Evaluation (per position, batches of " << positions << "):" << endl;
+    double scalar = nanosPerCall(batches, [&](uint64_t) {
+        evaluateScalar(weights, batch, scores.data());
+        sink = sink + static_cast<uint64_t>(scores[0]);
+    }) / positions;
+    report("scalar", scalar);
+    if (!hasAvx2Evaluation()) {
+        cout << "  AVX2 not available on this CPU" << endl;
+        return;
+    }
+    double simd = nanosPerCall(batches, [&](uint64_t) {
+        evaluate(weights, batch, scores.data());
+        sink = sink + static_cast<uint64_t>(scores[0]);
+    }) / positions;
+    report("AVX2", simd);
+    cout << "  positions/sec: scalar " << setprecision(0) << 1e9 / scalar << ", AVX2 " << 1e9 / simd
+         << " (" << setprecision(1) << scalar / simd << "x)" << endl;
+}
+
+// Closed loop load on a GameHost: every game always has one move in flight,
+// and the completion of a move (on the game's shard) submits the next one
+struct HostDriver {
+    GameHost* host = nullptr;
+    GameState opening{};
+    atomic<int64_t> budget{0};
+    vector<chrono::steady_clock::time_point> submitted;  // Per game
+    vector<int> turnActions;                            // Per game
+    vector<int> mover;                                  // Per game: seat of the move in flight
+    vector<vector<uint32_t>> latencies;                 // Per shard, in nanoseconds
+    vector<mt19937_64> rngs;                            // Per shard
+
+    void step(Game& game, GameId id) {
+        if (budget.fetch_sub(1, memory_order_relaxed) <= 0) return;
+        if (game.isGameOver()) {
+            game.restore(opening);
+            turnActions[id] = 0;
+        }
+        MoveList legal;
+        int seat = game.snapshot().currentTurn;
+        game.legalMoves(seat, legal);
+        while (legal.empty() || turnActions[id] >= MAX_ACTIONS_PER_TURN) {
+            game.nextTurn();
+            turnActions[id] = 0;
+            seat = game.snapshot().currentTurn;
+            game.legalMoves(seat, legal);
+        }
+        mt19937_64& rng = rngs[host->shardOf(id)];
+        mover[id] = seat;
+        submitted[id] = chrono::steady_clock::now();
+        host->submit(id, seat, legal[static_cast<size_t>(randomBelow(rng, static_cast<int>(legal.size())))],
+                     [this, id](Game& next, MoveStatus) { completed(next, id); });
+    }
+
+    void completed(Game& game, GameId id) {
+        auto elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - submitted[id]);
+        latencies[host->shardOf(id)].push_back(static_cast<uint32_t>(min<int64_t>(elapsed.count(), UINT32_MAX)));
+        if (game.snapshot().currentTurn == mover[id]) ++turnActions[id];
+        else turnActions[id] = 0;
+        step(game, id);
+    }
+};
+
+static void benchGameHost(uint64_t iterations, unsigned maxThreads, uint64_t maxGames) {
+    const vector<RoleId> roles = {RoleId::Governor, RoleId::Spy, RoleId::Baron};
+    const RoleId openingRoles[] = {RoleId::Governor, RoleId::Spy, RoleId::Baron};
+    cout << "Game host (" << maxThreads << " threads, closed loop, one move in flight per game):" << endl;
+    cout << "  " << setw(8) << "games" << setw(14) << "actions/sec" << setw(11) << "p50 us" << setw(11) << "p99 us"
+         << setw(11) << "p99.9 us" << setw(10) << "steals" << endl;
+    for (uint64_t games = 10; games <= maxGames; games *= 10) {
+        GameHostConfig config;
+        config.threads = maxThreads;
+        GameHost host(config);
+        HostDriver driver;
+        driver.host = &host;
+        driver.opening = rules::initialState(openingRoles, 3);
+        driver.submitted.resize(games);
+        driver.turnActions.assign(games, 0);
+        driver.mover.assign(games, 0);
+        driver.latencies.resize(host.shardCount());
+        for (unsigned s = 0; s < host.shardCount(); ++s) driver.rngs.emplace_back(s + 1);
+        for (uint64_t g = 0; g < games; ++g) host.createGame(roles);
+        host.drain();
+
+        uint64_t actions = max<uint64_t>(iterations, 4 * games);
+        driver.budget.store(static_cast<int64_t>(actions));
+        auto start = chrono::steady_clock::now();
+        for (uint64_t g = 0; g < games; ++g)
+            host.post(static_cast<GameId>(g), [&driver, g](Game& game, MoveStatus) { driver.step(game, static_cast<GameId>(g)); });
+        host.drain();
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+        vector<uint32_t> all;
+        for (const auto& shard : driver.latencies) all.insert(all.end(), shard.begin(), shard.end());
+        sort(all.begin(), all.end());
+        auto percentile = [&all](double p) {
+            return all.empty() ? 0.0 : all[min(all.size() - 1, static_cast<size_t>(p * static_cast<double>(all.size())))] / 1000.0;
+        };
+        cout << "  " << setw(8) << games << setw(14) << setprecision(0) << static_cast<double>(all.size()) / elapsed.count()
+             << setprecision(1) << setw(11) << percentile(0.5) << setw(11) << percentile(0.99) << setw(11)
+             << percentile(0.999) << setw(10) << host.steals() << endl;
+        sink = sink + host.movesPlayed();
+    }
+}
+
+// Coroutine turn loops on one host thread, answered by a slow client: the
+// client collects the moves games wait for and sends them back in shuffled
+// batches, so almost every game is suspended at any time
+static void benchTurnFlow(uint64_t iterations, uint64_t maxGames) {
+    struct Request {
+        GameId game;
+        int seat;      // -1 for a reaction window to pass on
+        Move move;
+        uint32_t blockers;
+    };
+    mutex requestsMutex;
+    vector<Request> requests;
+    vector<mt19937_64> rngs;
+
+    GameHostConfig hostConfig;
+    hostConfig.threads = 1;
+    GameHost host(hostConfig);
+    for (unsigned s = 0; s < host.shardCount(); ++s) rngs.emplace_back(s + 1);
+    TurnFlowConfig config;
+    config.onAwaitMove = [&](GameId id, Game& game, int seat) {
+        MoveList legal;
+        game.legalMoves(seat, legal);
+        Move move = legal[static_cast<size_t>(randomBelow(rngs[host.shardOf(id)], static_cast<int>(legal.size())))];
+        lock_guard<mutex> lock(requestsMutex);
+        requests.push_back(Request{id, seat, move, 0});
+    };
+    config.onReactionWindow = [&](GameId id, Game&, uint32_t blockers) {
+        lock_guard<mutex> lock(requestsMutex);
+        requests.push_back(Request{id, -1, Move{}, blockers});
+    };
+    TurnFlow flow(host, config);
+
+    uint64_t games = min<uint64_t>(maxGames, 50000);
+    const vector<RoleId> roles = {RoleId::Governor, RoleId::Merchant, RoleId::Judge};
+    for (uint64_t g = 0; g < games; ++g) flow.start(host.createGame(roles));
+    host.drain();
+    cout << "Coroutine turn flow (1 host thread, " << games << " games, " << flow.waitingGames() << " suspended):" << endl;
+
+    uint64_t target = max<uint64_t>(iterations / 2, 2 * games);
+    uint64_t sent = 0;
+    uint64_t batches = 0;
+    mt19937_64 rng(99);
+    vector<Request> batch;
+    auto start = chrono::steady_clock::now();
+    while (sent < target) {
+        {
+            lock_guard<mutex> lock(requestsMutex);
+            batch.swap(requests);
+        }
+        if (batch.empty()) {
+            this_thread::yield();
+            continue;
+        }
+        shuffle(batch.begin(), batch.end(), rng);
+        for (const Request& request : batch) {
+            if (request.seat >= 0) {
+                flow.play(request.game, request.seat, request.move);
+            } else {
+                for (int seat = 0; seat < static_cast<int>(MAX_PLAYERS); ++seat)
+                    if (request.blockers & (1u << seat)) flow.pass(request.game, seat);
+            }
+        }
+        sent += batch.size();
+        ++batches;
+        batch.clear();
+    }
+    host.drain();
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    cout << "  " << sent << " answers in " << batches << " batches: " << fixed << setprecision(0)
+         << static_cast<double>(sent) / elapsed.count() << " resumes/sec, " << flow.finishedGames() << " games finished, "
+         << flow.waitingGames() << " still waiting" << endl;
+}
+
+// Timer churn as on a loaded host: every live game keeps one turn clock, and
+// most clocks are cancelled (the player moved) and replaced before they fire.
+// The baseline is an ordered set, the usual priority queue that can cancel.
+static void benchTimerWheel(uint64_t iterations, uint64_t maxGames) {
+    const uint64_t live = max<uint64_t>(maxGames, 1000);
+    const uint64_t horizon = 30000;   // Ticks: 30 s turn clocks on a 1 ms tick
+    cout << "Timer churn (" << live << " live timers, cancel + schedule, 1 tick per 64 ops):" << endl;
+
+    uint64_t firedWheel = 0;
+    TimerWheel wheel([&firedWheel](uint64_t data) { firedWheel += data; });
+    vector<TimerId> ids(live);
+    mt19937_64 rng(3);
+    for (uint64_t i = 0; i < live; ++i) ids[i] = wheel.schedule(1 + rng() % horizon, 1);
+    double nanosWheel = nanosPerCall(iterations, [&](uint64_t i) {
+        uint64_t victim = rng() % live;
+        wheel.cancel(ids[victim]);
+        ids[victim] = wheel.schedule(wheel.now() + 1 + rng() % horizon, 1);
+        if ((i & 63) == 63) wheel.advance(wheel.now() + 1);
+    });
+
+    uint64_t firedSet = 0;
+    uint64_t now = 0;
+    set<pair<uint64_t, uint64_t>> timers;   // (deadline, timer)
+    vector<uint64_t> deadlines(live);
+    rng.seed(3);
+    for (uint64_t i = 0; i < live; ++i) {
+        deadlines[i] = 1 + rng() % horizon;
+        timers.emplace(deadlines[i], i);
+    }
+    double nanosSet = nanosPerCall(iterations, [&](uint64_t i) {
+        uint64_t victim = rng() % live;
+        timers.erase({deadlines[victim], victim});
+        deadlines[victim] = now + 1 + rng() % horizon;
+        timers.emplace(deadlines[victim], victim);
+        if ((i & 63) == 63) {
+            ++now;
+            while (!timers.empty() && timers.begin()->first <= now) {
+                deadlines[timers.begin()->second] = UINT64_MAX;
+                timers.erase(timers.begin());
+                ++firedSet;
+            }
+        }
+    });
+    report("timer wheel cancel + schedule", nanosWheel);
+    report("ordered set cancel + insert", nanosSet);
+    cout << "  speedup " << setprecision(1) << nanosSet / nanosWheel << "x" << endl;
+    sink = sink + firedWheel + firedSet;
+}
+
+// Opening a Spy against Merchant tablebase file and probing it
+static void benchTablebase(uint64_t iterations) {
+    const char* path = "bench_tablebase.tb";
+    tablebase::generate(path, {{RoleId::Spy, RoleId::Merchant}});
+    auto start = chrono::steady_clock::now();
+    Tablebase table(path);
+    chrono::duration<double, micro> opened = chrono::steady_clock::now() - start;
+
+    const RoleId roles[] = {RoleId::Spy, RoleId::Merchant};
+    GameState state = rules::initialState(roles, 2);
+    cout << "Tablebase (Spy vs Merchant, " << table.positions() << " positions):" << endl;
+    cout << "  open and map: " << fixed << setprecision(1) << opened.count() << " us" << endl;
+    report("probe", nanosPerCall(iterations, [&](uint64_t i) {
+        state.seat(0).coins = static_cast<int16_t>(i % 7);
+        state.seat(1).coins = static_cast<int16_t>(i % 13);
+        sink = sink + table.probe(state).plies;
+    }));
+    remove(path);
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t iterations = 1000000;
+    unsigned maxThreads = max(1u, thread::hardware_concurrency());
+    uint64_t maxGames = 100000;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            iterations = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--max-threads" && i + 1 < argc) {
+            maxThreads = max(1u, static_cast<unsigned>(strtoul(argv[++i], nullptr, 10)));
+        } else if (arg == "--max-games" && i + 1 < argc) {
+            maxGames = strtoull(argv[++i], nullptr, 10);
+        } else {
+            cerr << "Usage: BenchExec [--iterations N] [--max-threads T] [--max-games G]" << endl;
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+    if (iterations == 0) iterations = 1;
+
+    benchRoleChecks(iterations);
+    benchActions(iterations / 10 + 1);
+    benchAgents(iterations);
+    benchEvaluation(iterations);
+    benchIsmcts(iterations / 100 + 1, maxThreads);
+    benchTreeParallel(iterations / 50 + 1, maxThreads);
+    benchAlphaBeta(16);
+    benchTablebase(iterations);
+    benchGameHost(iterations, maxThreads, maxGames);
+    benchTurnFlow(iterations, maxGames);
+    benchTimerWheel(iterations, maxGames);
+    return 0;
+}
@@ -0,0 +1,111 @@
+//tomergal40@gmail.com
+// Monte Carlo CFR trainer
+//
+// Usage: CfrExec [--roles r1,r2,...] [--iterations N] [--threads T] [--horizon H]
+//                [--seed S] [--checkpoint FILE] [--every N] [--resume]
+//
+// Trains from the opening of a game with the given roles (Governor,Spy by
+// default) and prints the average strategy of the first seat to move.
+// --resume continues from the checkpoint file instead of an empty table.
+
+#include "../include/Cfr.hpp"
+#include "../include/Exceptions.hpp"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace coup;
+
+static void printUsage() {
+    cerr << "Usage: CfrExec [--roles Governor,Spy,...] [--iterations N] [--threads T] [--horizon H]\n"
+         << "               [--seed S] [--checkpoint FILE] [--every N] [--resume]" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    CfrConfig config;
+    uint64_t iterations = 5000;
+    vector<RoleId> roles;
+    bool resume = false;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        }
+        if (arg == "--resume") {
+            resume = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            printUsage();
+            return 1;
+        }
+        string value = argv[++i];
+        if (arg == "--iterations") iterations = strtoull(value.c_str(), nullptr, 10);
+        else if (arg == "--threads") config.threads = static_cast<unsigned>(strtoul(value.c_str(), nullptr, 10));
+        else if (arg == "--horizon") config.horizon = atoi(value.c_str());
+        else if (arg == "--seed") config.seed = strtoull(value.c_str(), nullptr, 10);
+        else if (arg == "--checkpoint") config.checkpointPath = value;
+        else if (arg == "--every") config.checkpointEvery = strtoull(value.c_str(), nullptr, 10);
+        else if (arg == "--roles") {
+            stringstream stream(value);
+            string name;
+            while (getline(stream, name, ',')) {
+                RoleId role = roleIdFromName(name);
+                if (role == RoleId::Player) {
+                    cerr << "Unknown role: " << name << endl;
+                    return 1;
+                }
+                roles.push_back(role);
+            }
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (roles.empty()) roles = {RoleId::Governor, RoleId::Spy};
+    if (roles.size() < 2 || roles.size() > STATE_MAX_SEATS) {
+        cerr << "Error: need 2 to " << STATE_MAX_SEATS << " roles" << endl;
+        return 1;
+    }
+
+    try {
+        CfrTrainer trainer(config);
+        if (resume) {
+            if (config.checkpointPath.empty()) {
+                cerr << "Error: --resume needs --checkpoint FILE" << endl;
+                return 1;
+            }
+            trainer.load(config.checkpointPath);
+        }
+        GameState root = rules::initialState(roles.data(), static_cast<int>(roles.size()));
+        CfrResult result = trainer.train(root, iterations);
+
+        cout << "Iterations:     " << result.iterations << endl;
+        cout << "Elapsed:        " << fixed << setprecision(3) << result.seconds << " s" << endl;
+        cout << "Iterations/sec: " << fixed << setprecision(0) << result.iterationsPerSecond() << endl;
+        cout << "Nodes:          " << result.nodes << endl;
+        cout << "Info sets:      " << result.infoSets << " of " << trainer.table().capacity() << endl;
+        if (result.checkpoints) cout << "Checkpoints:    " << result.checkpoints << " to " << config.checkpointPath << endl;
+
+        MoveList moves;
+        double probabilities[MAX_MOVES];
+        trainer.averageStrategy(root, 0, moves, probabilities);
+        cout << "\nOpening strategy of seat 0 (" << toString(roles[0]) << "):" << endl;
+        for (size_t m = 0; m < moves.size(); ++m) {
+            cout << "  " << left << setw(20) << toString(moves[m].type) << right;
+            if (moves[m].target >= 0) cout << " -> " << moves[m].target;
+            else cout << "     ";
+            cout << setw(8) << setprecision(3) << probabilities[m] << endl;
+        }
+    } catch (const GameException& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
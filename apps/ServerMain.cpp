@@ -0,0 +1,163 @@
+//tomergal40@gmail.com
+// Game server speaking the binary protocol of Protocol.hpp
+//
+// Usage: CoupServer [--host H] [--port P | --unix PATH] [--loops N] [--threads T]
+//        CoupServer --bench CONNECTIONS [--rounds R] [--loops N] [--threads T] [--unix PATH]
+//
+// Without --bench the server runs until SIGINT or SIGTERM. With --bench it
+// starts in process, opens CONNECTIONS client connections with one game each
+// and plays random legal actions over them round by round, reporting the
+// round-trip latency of Action requests.
+
+#include "../include/CoupServer.hpp"
+#include "../include/Exceptions.hpp"
+#include "../include/GameState.hpp"
+#include "../include/Playout.hpp"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <sys/resource.h>
+#include <vector>
+
+using namespace std;
+using namespace coup;
+
+static void printUsage() {
+    cerr << "Usage: CoupServer [--host H] [--port P | --unix PATH] [--loops N] [--threads T]\n"
+         << "       CoupServer --bench CONNECTIONS [--rounds R] [--loops N] [--threads T] [--unix PATH]" << endl;
+}
+
+// Every connection needs a descriptor on both ends
+static void raiseFileLimit(size_t connections) {
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0) return;
+    rlim_t wanted = static_cast<rlim_t>(connections * 2 + 64);
+    if (limit.rlim_cur < wanted) {
+        limit.rlim_cur = min(wanted, limit.rlim_max);
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+static int runBench(ServerConfig config, size_t connections, int rounds) {
+    raiseFileLimit(connections);
+    config.port = 0;
+    CoupServer server(config);
+    server.start();
+
+    struct Seat {
+        CoupClient client;
+        GameId game;
+    };
+    const vector<RoleId> roles = {RoleId::Governor, RoleId::Spy};
+    vector<Seat> seats;
+    seats.reserve(connections);
+    for (size_t i = 0; i < connections; ++i) {
+        CoupClient client = config.unixPath.empty() ? CoupClient::connectTcp(config.host, server.port())
+                                                    : CoupClient::connectUnix(config.unixPath);
+        GameId game = client.createGame(roles);
+        seats.push_back(Seat{std::move(client), game});
+    }
+    cout << "Connected " << server.connections() << " clients on " << server.host().threads()
+         << " game threads" << endl;
+
+    // A finished game is released before its seat starts the next one
+    auto replay = [&roles](Seat& seat) {
+        seat.client.closeGame(seat.game);
+        seat.game = seat.client.createGame(roles);
+    };
+
+    mt19937_64 rng(1);
+    vector<double> latencies;
+    latencies.reserve(connections * static_cast<size_t>(rounds));
+    auto start = chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        for (Seat& seat : seats) {
+            GameState state = seat.client.state(seat.game);
+            MoveList moves;
+            rules::legalMoves(state, state.currentTurn, moves);
+            if (moves.empty() || rules::winner(state) >= 0) {
+                replay(seat);
+                continue;
+            }
+            const Move& move = moves[randomBelow(rng, static_cast<int>(moves.size()))];
+            auto sent = chrono::steady_clock::now();
+            ActionReply reply = seat.client.act(seat.game, state.currentTurn, move);
+            latencies.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - sent).count());
+            if (reply.gameOver) replay(seat);
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) {
+        return latencies.empty() ? 0.0 : latencies[min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()))];
+    };
+    cout << fixed << setprecision(1)
+         << "Action round trips: " << latencies.size()
+         << "  p50 " << percentile(0.50) << " us"
+         << "  p99 " << percentile(0.99) << " us"
+         << "  max " << (latencies.empty() ? 0.0 : latencies.back()) << " us\n"
+         << "Requests: " << server.requests() << " (" << setprecision(0) << server.requests() / seconds << "/s)"
+         << "  live games: " << server.host().liveGames() << endl;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    ServerConfig config;
+    size_t benchConnections = 0;
+    int rounds = 20;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            printUsage();
+            return 1;
+        }
+        string value = argv[++i];
+        if (arg == "--host") config.host = value;
+        else if (arg == "--port") config.port = atoi(value.c_str());
+        else if (arg == "--unix") config.unixPath = value;
+        else if (arg == "--loops") config.loops = static_cast<unsigned>(strtoul(value.c_str(), nullptr, 10));
+        else if (arg == "--threads") config.games.threads = static_cast<unsigned>(strtoul(value.c_str(), nullptr, 10));
+        else if (arg == "--bench") benchConnections = strtoull(value.c_str(), nullptr, 10);
+        else if (arg == "--rounds") rounds = atoi(value.c_str());
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    try {
+        if (benchConnections > 0) return runBench(config, benchConnections, rounds);
+
+        // Block the stop signals before any thread starts so only sigwait sees them
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+        CoupServer server(config);
+        server.start();
+        if (config.unixPath.empty()) cout << "Listening on " << config.host << ":" << server.port() << endl;
+        else cout << "Listening on " << config.unixPath << endl;
+
+        int received = 0;
+        sigwait(&signals, &received);
+        cout << "Stopping after " << server.requests() << " requests" << endl;
+        server.stop();
+    } catch (const GameException& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+//tomergal40@gmail.com
+// Headless batch simulation driver
+//
+// Usage: SimExec [--games N] [--threads T] [--players P] [--seed S]
+//                [--agents a1,a2,...] [--roles r1,r2,...] [--max-turns M]
+//                [--log FILE]
+
+#include "../include/Simulator.hpp"
+#include "../include/Exceptions.hpp"
+#include <cstdlib>
+#include <memory>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace coup;
+
+// Splits a comma separated list
+static vector<string> splitList(const string& text) {
+    vector<string> items;
+    stringstream stream(text);
+    string item;
+    while (getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+static void printUsage() {
+    cerr << "Usage: SimExec [--games N] [--threads T] [--players P] [--seed S]\n"
+         << "               [--agents random,greedy,...] [--roles Governor,Spy,...] [--max-turns M]\n"
+         << "               [--log FILE]" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    SimulationConfig config;
+    uint64_t games = 100000;
+    unsigned threads = 0;
+    vector<string> agentNames;
+    string logPath;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            printUsage();
+            return 1;
+        }
+        string value = argv[++i];
+        if (arg == "--games") games = strtoull(value.c_str(), nullptr, 10);
+        else if (arg == "--threads") threads = static_cast<unsigned>(strtoul(value.c_str(), nullptr, 10));
+        else if (arg == "--players") config.players = atoi(value.c_str());
+        else if (arg == "--seed") config.seed = strtoull(value.c_str(), nullptr, 10);
+        else if (arg == "--max-turns") config.maxTurns = atoi(value.c_str());
+        else if (arg == "--roles") config.roles = splitList(value);
+        else if (arg == "--agents") agentNames = splitList(value);
+        else if (arg == "--log") logPath = value;
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    try {
+        for (const auto& name : agentNames) config.agents.push_back(makeAgentFactory(name));
+        unique_ptr<AsyncFileEventSink> log;
+        if (!logPath.empty()) {
+            log = make_unique<AsyncFileEventSink>(logPath);
+            config.events = log.get();
+        }
+        Simulator simulator(config);
+        SimulationResult result = simulator.run(games, threads);
+
+        cout << "Games:          " << result.games << " (" << result.draws << " draws)" << endl;
+        cout << "Elapsed:        " << fixed << setprecision(3) << result.seconds << " s" << endl;
+        cout << "Games/sec:      " << fixed << setprecision(0) << result.gamesPerSecond() << endl;
+        cout << "Avg turns:      " << fixed << setprecision(2)
+             << (result.games ? static_cast<double>(result.turns) / static_cast<double>(result.games) : 0.0) << endl;
+        cout << "Actions:        " << result.actions << " accepted, " << result.rejectedMoves
+             << " rejected, " << result.forcedPasses << " forced passes" << endl;
+
+        cout << "\nWins by seat:" << endl;
+        for (int seat = 0; seat < config.players; ++seat) {
+            cout << "  seat " << seat << ": " << result.winsBySeat[static_cast<size_t>(seat)] << endl;
+        }
+        cout << "Wins by role:" << endl;
+        for (size_t role = 0; role < ROLE_NAMES.size(); ++role) {
+            cout << "  " << left << setw(9) << ROLE_NAMES[role] << right << ": " << result.winsByRole[role] << endl;
+        }
+    } catch (const GameException& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+//tomergal40@gmail.com
+// Two-player endgame tablebase generator
+//
+// Usage: TablebaseExec [--out FILE] [--roles r1,r2,...]
+//
+// Solves every pairing of the given roles (all six by default) and writes
+// the table that Tablebase maps at startup.
+
+#include "../include/Tablebase.hpp"
+#include "../include/Exceptions.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace coup;
+
+static void printUsage() {
+    cerr << "Usage: TablebaseExec [--out FILE] [--roles Governor,Spy,...]" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    string path = "coup.tb";
+    vector<RoleId> roles;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            printUsage();
+            return 1;
+        }
+        string value = argv[++i];
+        if (arg == "--out") {
+            path = value;
+        } else if (arg == "--roles") {
+            stringstream stream(value);
+            string name;
+            while (getline(stream, name, ',')) {
+                RoleId role = roleIdFromName(name);
+                if (role == RoleId::Player) {
+                    cerr << "Unknown role: " << name << endl;
+                    return 1;
+                }
+                roles.push_back(role);
+            }
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    vector<pair<RoleId, RoleId>> pairings;
+    if (roles.empty()) {
+        pairings = tablebase::allPairings();
+    } else {
+        for (RoleId mover : roles)
+            for (RoleId other : roles) pairings.emplace_back(mover, other);
+    }
+
+    try {
+        auto start = chrono::steady_clock::now();
+        vector<TablebaseSection> sections = tablebase::generate(path, pairings);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        size_t positions = 0;
+        cout << left << setw(10) << "To move" << setw(10) << "Other" << right << setw(10) << "Positions"
+             << setw(10) << "Wins" << setw(10) << "Losses" << setw(10) << "Draws" << endl;
+        for (const TablebaseSection& section : sections) {
+            positions += section.positions;
+            cout << left << setw(10) << toString(section.mover) << setw(10) << toString(section.other) << right
+                 << setw(10) << section.positions << setw(10) << section.wins << setw(10) << section.losses
+                 << setw(10) << section.draws << endl;
+        }
+        cout << "\nWrote " << positions << " positions to " << path << " in " << fixed << setprecision(2)
+             << seconds << " s" << endl;
+    } catch (const GameException& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+//tomergal40@gmail.com
+// Round robin tournament between agents
+//
+// Usage: TournamentExec [--agents a1,a2,...] [--roles r1,r2,...] [--games-per-match N]
+//                       [--threads T] [--max-turns M] [--seed S]
+//
+// Every ordered pair of agents plays every role assignment of the listed
+// roles; ratings are Bradley-Terry Elo with 95% confidence margins.
+
+#include "../include/Tournament.hpp"
+#include "../include/Exceptions.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace coup;
+
+// Splits a comma separated list
+static vector<string> splitList(const string& text) {
+    vector<string> items;
+    stringstream stream(text);
+    string item;
+    while (getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+static void printUsage() {
+    cerr << "Usage: TournamentExec [--agents random,greedy,...] [--roles Governor,Spy,...] [--games-per-match N]\n"
+         << "                      [--threads T] [--max-turns M] [--seed S]" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    TournamentConfig config;
+    config.agents = {"random", "greedy", "coup-first", "role-aware"};
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            printUsage();
+            return 1;
+        }
+        string value = argv[++i];
+        if (arg == "--agents") config.agents = splitList(value);
+        else if (arg == "--games-per-match") config.gamesPerMatch = strtoull(value.c_str(), nullptr, 10);
+        else if (arg == "--threads") config.threads = static_cast<unsigned>(strtoul(value.c_str(), nullptr, 10));
+        else if (arg == "--max-turns") config.maxTurns = atoi(value.c_str());
+        else if (arg == "--seed") config.seed = strtoull(value.c_str(), nullptr, 10);
+        else if (arg == "--roles") {
+            config.roles.clear();
+            for (const auto& name : splitList(value)) {
+                RoleId role = roleIdFromName(name);
+                if (role == RoleId::Player) {
+                    cerr << "Unknown role: " << name << endl;
+                    return 1;
+                }
+                config.roles.push_back(role);
+            }
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    try {
+        Tournament tournament(config);
+        cout << "Playing " << tournament.totalGames() << " games..." << endl;
+        TournamentResult result = tournament.run();
+
+        cout << "Games:          " << result.games << " (" << result.draws << " draws)" << endl;
+        cout << "Elapsed:        " << fixed << setprecision(3) << result.seconds << " s" << endl;
+        cout << "Games/sec:      " << fixed << setprecision(0) << result.gamesPerSecond() << endl;
+
+        vector<size_t> order(result.standings.size());
+        iota(order.begin(), order.end(), 0);
+        stable_sort(order.begin(), order.end(),
+                    [&](size_t a, size_t b) { return result.standings[a].elo > result.standings[b].elo; });
+
+        cout << "\n" << left << setw(14) << "Agent" << right << setw(8) << "Elo" << setw(8) << "+/-" << setw(10)
+             << "Games" << setw(10) << "Wins" << setw(10) << "Losses" << setw(10) << "Draws" << setw(8) << "Score" << endl;
+        for (size_t a : order) {
+            const AgentStanding& s = result.standings[a];
+            cout << left << setw(14) << s.name << right << setprecision(0) << setw(8) << s.elo << setw(8) << s.eloMargin
+                 << setw(10) << s.games << setw(10) << s.wins << setw(10) << s.losses << setw(10) << s.draws
+                 << setprecision(3) << setw(8) << s.score() << endl;
+        }
+
+        cout << "\nWins (row against column):" << endl;
+        cout << setw(14) << "";
+        for (size_t b : order) cout << setw(12) << result.standings[b].name;
+        cout << endl;
+        for (size_t a : order) {
+            cout << left << setw(14) << result.standings[a].name << right;
+            for (size_t b : order) {
+                if (a == b) cout << setw(12) << "-";
+                else cout << setw(12) << result.winsOf(a, b);
+            }
+            cout << endl;
+        }
+    } catch (const GameException& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -183,18 +183,18 @@ int main() {
             for (const auto& player : players) {
                 ImGui::BulletText("%s (%s) - %d coins", 
                                 player->getName().c_str(), 
-                                player->role().c_str(), 
+                                coup::toString(player->roleId()), 
                                 player->coins());
                 
                 // Add role explanation on hover
                 if (ImGui::IsItemHovered()) {
                     std::string tooltip = "Role: " + player->role() + "\n";
-                    if (player->role() == "Governor") tooltip += "- Tax: Gets 3 coins\n- Can undo other's tax";
-                    else if (player->role() == "Spy") tooltip += "- SpyOn: See coins, block arrest\n- Arrest: Target loses 1 coin";
-                    else if (player->role() == "Baron") tooltip += "- Invest: 3 coins -> 6 coins\n- Bribe: Costs 4 coins";
-                    else if (player->role() == "General") tooltip += "- Defend: Protect from coups (5 coins)\n- Gets compensation when arrested";
-                    else if (player->role() == "Judge") tooltip += "- Sanction: Blocks target's actions\n- Can block bribes";
-                    else if (player->role() == "Merchant") tooltip += "- Bonus coin with 3+ coins\n- Pays 2 when arrested";
+                    if (player->roleId() == coup::RoleId::Governor) tooltip += "- Tax: Gets 3 coins\n- Can undo other's tax";
+                    else if (player->roleId() == coup::RoleId::Spy) tooltip += "- SpyOn: See coins, block arrest\n- Arrest: Target loses 1 coin";
+                    else if (player->roleId() == coup::RoleId::Baron) tooltip += "- Invest: 3 coins -> 6 coins\n- Bribe: Costs 4 coins";
+                    else if (player->roleId() == coup::RoleId::General) tooltip += "- Defend: Protect from coups (5 coins)\n- Gets compensation when arrested";
+                    else if (player->roleId() == coup::RoleId::Judge) tooltip += "- Sanction: Blocks target's actions\n- Can block bribes";
+                    else if (player->roleId() == coup::RoleId::Merchant) tooltip += "- Bonus coin with 3+ coins\n- Pays 2 when arrested";
                     
                     ImGui::SetTooltip("%s", tooltip.c_str());
                 }
@@ -251,41 +251,41 @@ int main() {
                 ImGui::TextColored(ImVec4(0.2f, 1.0f, 0.2f, 1.0f), 
                                  "%s - You are a %s", 
                                  player->getName().c_str(), 
-                                 player->role().c_str());
+                                 coup::toString(player->roleId()));
                 
-                if (player->role() == "Governor") {
+                if (player->roleId() == coup::RoleId::Governor) {
                     ImGui::Text("  Powers:");
                     ImGui::BulletText("Tax: Get 3 coins instead of 2 (others get 2)");
                     ImGui::BulletText("Undo: Cancel another player's tax action");
                     ImGui::TextColored(ImVec4(0.8f, 0.8f, 0.2f, 1.0f), "  Strategy: Use tax for quick coins, undo to disrupt others");
                 }
-                else if (player->role() == "Spy") {
+                else if (player->roleId() == coup::RoleId::Spy) {
                     ImGui::Text("  Powers:");
                     ImGui::BulletText("SpyOn: See target's coins + block their next arrest (FREE - doesn't end turn)");
                     ImGui::BulletText("Arrest: Target loses 1 coin to you");
                     ImGui::TextColored(ImVec4(0.8f, 0.2f, 0.8f, 1.0f), "  Strategy: Spy first to gather info and protect yourself");
                 }
-                else if (player->role() == "Baron") {
+                else if (player->roleId() == coup::RoleId::Baron) {
                     ImGui::Text("  Powers:");
                     ImGui::BulletText("Invest: If you have EXACTLY 3 coins, get 6 coins total");
                     ImGui::BulletText("Bribe: Pay 4 coins for advantage (Judge can block this)");
                     ImGui::BulletText("Compensation: When sanctioned, lose only 1 coin max");
                     ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.2f, 1.0f), "  Strategy: Save up to exactly 3 coins, then invest for big gains");
                 }
-                else if (player->role() == "General") {
+                else if (player->roleId() == coup::RoleId::General) {
                     ImGui::Text("  Powers:");
                     ImGui::BulletText("Defend: Pay 5 coins to protect anyone from next coup");
                     ImGui::BulletText("Compensation: When arrested, you don't lose the coin");
                     ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "  Strategy: Save coins to protect yourself or allies from coups");
                 }
-                else if (player->role() == "Judge") {
+                else if (player->roleId() == coup::RoleId::Judge) {
                     ImGui::Text("  Powers:");
                     ImGui::BulletText("Sanction: Prevent target from gathering coins or using tax");
                     ImGui::BulletText("Block Bribe: Cancel Baron's bribe and make them lose 4 coins");
                     ImGui::BulletText("Compensation: Attackers pay extra when sanctioning you");
                     ImGui::TextColored(ImVec4(0.2f, 0.8f, 1.0f, 1.0f), "  Strategy: Control the game by blocking key actions");
                 }
-                else if (player->role() == "Merchant") {
+                else if (player->roleId() == coup::RoleId::Merchant) {
                     ImGui::Text("  Powers (All Automatic):");
                     ImGui::BulletText("Bonus: Get +1 coin when starting turn with 3+ coins");
                     ImGui::BulletText("Penalty: When arrested, pay 2 coins to treasury (not to attacker)");
@@ -371,12 +371,12 @@ int main() {
                         ImGui::TextColored(ImVec4(0.2f, 1.0f, 0.2f, 1.0f), 
                                          "-> %s (%s) - %d coins", 
                                          player->getName().c_str(), 
-                                         player->role().c_str(), 
+                                         coup::toString(player->roleId()), 
                                          player->coins());
                     } else {
                         ImGui::Text("   %s (%s) - %d coins", 
                                   player->getName().c_str(), 
-                                  player->role().c_str(), 
+                                  coup::toString(player->roleId()), 
                                   player->coins());
                     }
                 }
@@ -458,7 +458,7 @@ int main() {
                         ImGui::Text("Special Abilities:");
 
                         // GOVERNOR ABILITIES - Tax + Undo
-                        if (player->role() == "Governor") {
+                        if (player->roleId() == coup::RoleId::Governor) {
                             ImGui::TextColored(ImVec4(0.8f, 0.8f, 0.2f, 1.0f), "Governor Powers:");
                             
                             // Tax - Governor exclusive, gets 3 coins
@@ -496,7 +496,7 @@ int main() {
                         }
 
                         // SPY ABILITIES - Both spyOn and arrest
-                        else if (player->role() == "Spy") {
+                        else if (player->roleId() == coup::RoleId::Spy) {
                             ImGui::TextColored(ImVec4(0.8f, 0.2f, 0.8f, 1.0f), "Spy Powers:");
                             
                             // SpyOn - doesn't end turn, no cost
@@ -547,7 +547,7 @@ int main() {
                         }
 
                         // BARON ABILITIES - Invest (exactly 3 coins) + Bribe
-                        else if (player->role() == "Baron") {
+                        else if (player->roleId() == coup::RoleId::Baron) {
                             ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.2f, 1.0f), "Baron Powers:");
                             
                             // Invest - requires exactly 3 coins
@@ -608,7 +608,7 @@ int main() {
                         }
 
                         // GENERAL ABILITIES - Coup Defense
-                        else if (player->role() == "General") {
+                        else if (player->roleId() == coup::RoleId::General) {
                             ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "General Powers:");
                             
                             bool canDefend = (player->coins() >= 5);
@@ -644,7 +644,7 @@ int main() {
                         }
 
                         // JUDGE ABILITIES - Sanction + Block Bribe
-                        else if (player->role() == "Judge") {
+                        else if (player->roleId() == coup::RoleId::Judge) {
                             ImGui::TextColored(ImVec4(0.2f, 0.8f, 1.0f, 1.0f), "Judge Powers:");
                             
                             for (auto& target : players) {
@@ -683,7 +683,7 @@ int main() {
                         }
 
                         // MERCHANT ABILITIES - All passive
-                        else if (player->role() == "Merchant") {
+                        else if (player->roleId() == coup::RoleId::Merchant) {
                             ImGui::TextColored(ImVec4(0.4f, 1.0f, 0.4f, 1.0f), "Merchant Powers:");
                             ImGui::Text("All abilities are passive:");
                             ImGui::Text("- Gets +1 coin when starting turn with 3+ coins");
@@ -717,28 +717,28 @@ int main() {
                     auto currentPlayer = *helpPlayerIt;
                     ImGui::TextColored(ImVec4(0.8f, 0.8f, 0.2f, 1.0f), "%s's Quick Guide:", currentPlayer->getName().c_str());
                     
-                    if (currentPlayer->role() == "Governor") {
+                    if (currentPlayer->roleId() == coup::RoleId::Governor) {
                         ImGui::BulletText("Tax gives you 3 coins!");
                         ImGui::BulletText("You can undo others' tax");
-                    } else if (currentPlayer->role() == "Spy") {
+                    } else if (currentPlayer->roleId() == coup::RoleId::Spy) {
                         ImGui::BulletText("SpyOn first (free action)");
                         ImGui::BulletText("Then arrest or gather");
-                    } else if (currentPlayer->role() == "Baron") {
+                    } else if (currentPlayer->roleId() == coup::RoleId::Baron) {
                         if (currentPlayer->coins() == 3) {
                             ImGui::TextColored(ImVec4(0.2f, 1.0f, 0.2f, 1.0f), "Perfect! You can invest!");
                         } else {
                             ImGui::BulletText("Need exactly 3 coins to invest");
                         }
-                    } else if (currentPlayer->role() == "General") {
+                    } else if (currentPlayer->roleId() == coup::RoleId::General) {
                         if (currentPlayer->coins() >= 5) {
                             ImGui::BulletText("You can defend against coups!");
                         } else {
                             ImGui::BulletText("Save up to 5 coins for defense");
                         }
-                    } else if (currentPlayer->role() == "Judge") {
+                    } else if (currentPlayer->roleId() == coup::RoleId::Judge) {
                         ImGui::BulletText("Sanction to control others");
                         ImGui::BulletText("Block bribes for free");
-                    } else if (currentPlayer->role() == "Merchant") {
+                    } else if (currentPlayer->roleId() == coup::RoleId::Merchant) {
                         if (currentPlayer->coins() >= 3) {
                             ImGui::TextColored(ImVec4(0.2f, 1.0f, 0.2f, 1.0f), "You got bonus coin!");
                         }
@@ -787,7 +787,7 @@ int main() {
 
             for (const auto& blockingPlayer : players) {
                 // Governor can undo tax actions
-                if (blockingPlayer->role() == "Governor" && blockingPlayer->getName() != currentTurn) {
+                if (blockingPlayer->roleId() == coup::RoleId::Governor && blockingPlayer->getName() != currentTurn) {
                     for (const auto& target : players) {
                         if (target != blockingPlayer) {
                             std::string blockText = blockingPlayer->getName() + ": Block " + target->getName() + "'s Tax";
@@ -807,7 +807,7 @@ int main() {
                 }
 
                 // Judge can block bribes
-                if (blockingPlayer->role() == "Judge" && blockingPlayer->getName() != currentTurn) {
+                if (blockingPlayer->roleId() == coup::RoleId::Judge && blockingPlayer->getName() != currentTurn) {
                     for (const auto& target : players) {
                         if (target != blockingPlayer) {
                             std::string blockText = blockingPlayer->getName() + ": Block " + target->getName() + "'s Bribe";
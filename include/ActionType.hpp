@@ -0,0 +1,53 @@
+//tomergal40@gmail.com
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace coup {
+
+// Kinds of actions recorded in the game's pending action journal
+enum class ActionType : std::uint8_t {
+    Gather,
+    Tax,
+    Bribe,
+    Arrest,
+    Sanction,
+    Coup,
+    Invest,
+    Compensation,   // Baron's coin after being sanctioned
+    BlockCoup,      // General's prepared coup defense
+    BlockArrest     // Spy's arrest block
+};
+
+const std::size_t ACTION_TYPE_COUNT = 10;
+
+// Name used by the string based journal API ("tax", "block_coup", ...)
+inline const char* toString(ActionType type) {
+    switch (type) {
+        case ActionType::Gather: return "gather";
+        case ActionType::Tax: return "tax";
+        case ActionType::Bribe: return "bribe";
+        case ActionType::Arrest: return "arrest";
+        case ActionType::Sanction: return "sanction";
+        case ActionType::Coup: return "coup";
+        case ActionType::Invest: return "invest";
+        case ActionType::Compensation: return "compensation";
+        case ActionType::BlockCoup: return "block_coup";
+        case ActionType::BlockArrest: return "block_arrest";
+    }
+    return "unknown";
+}
+
+// Parse an action name; returns false for names that are not action types
+inline bool parseActionType(const std::string& name, ActionType& type) {
+    for (std::size_t i = 0; i < ACTION_TYPE_COUNT; ++i) {
+        if (name == toString(static_cast<ActionType>(i))) {
+            type = static_cast<ActionType>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace coup
@@ -0,0 +1,101 @@
+//tomergal40@gmail.com
+#pragma once
+#include "Evaluation.hpp"
+#include "GameState.hpp"
+#include "Ismcts.hpp"
+#include "Move.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+
+namespace coup {
+
+// Everything an agent gets when it has to move. The view only refers to
+// data owned by the caller, so building one costs nothing.
+struct GameView {
+    const GameState& state;
+    int seat;                        // Seat to move
+    const MoveList& legal;           // Legal moves of `seat`, never empty
+    int turnActions;                 // Actions already taken this turn
+    std::mt19937_64& rng;
+
+    const SeatState& self() const { return state.seat(seat); }
+};
+
+// Automated player of one seat. decide() returns one of view.legal. The
+// heuristic agents below work on the stack only, so a decision never
+// allocates and agent-vs-agent games cost what the rules engine costs.
+class Agent {
+public:
+    virtual ~Agent() = default;
+    virtual const char* name() const = 0;
+    virtual Move decide(const GameView& view) = 0;
+};
+
+// Uniformly random legal move
+class RandomAgent : public Agent {
+public:
+    const char* name() const override { return "random"; }
+    Move decide(const GameView& view) override;
+};
+
+// Coups as soon as it can afford it, otherwise collects as many coins as
+// possible (random target and random choice among equal moves)
+class GreedyCoinsAgent : public Agent {
+public:
+    const char* name() const override { return "greedy"; }
+    Move decide(const GameView& view) override;
+};
+
+// Coups the richest opponent whenever possible and otherwise only saves up
+// for the next coup: it never pays for bribes or sanctions
+class CoupFirstAgent : public Agent {
+public:
+    const char* name() const override { return "coup-first"; }
+    Move decide(const GameView& view) override;
+};
+
+// Plays its role: Governors and Judges undo their opponents' taxes and
+// bribes, Spies spy on the richest opponent, Barons invest, and everyone
+// arrests an opponent about to coup. Arrest targets are chosen so that the
+// arrest actually takes a coin (not a Merchant, who pays the bank instead).
+class RoleAwareAgent : public Agent {
+public:
+    const char* name() const override { return "role-aware"; }
+    Move decide(const GameView& view) override;
+};
+
+// Scores the position after each legal move with the linear evaluation, all
+// candidates in one batch, and plays the best one (the first on ties). The
+// batch is allocated with the agent, so decisions do not allocate either.
+class LinearAgent : public Agent {
+private:
+    EvalWeights _weights;
+    PositionBatch _batch;
+public:
+    explicit LinearAgent(const EvalWeights& weights = EvalWeights::defaults());
+    const char* name() const override { return "linear"; }
+    Move decide(const GameView& view) override;
+};
+
+// Plays the move an ISMCTS search finds best (single threaded, iteration
+// budget). Unlike the heuristic agents, the search allocates its tree.
+class IsmctsAgent : public Agent {
+private:
+    IsmctsConfig _config;
+public:
+    explicit IsmctsAgent(std::uint64_t iterations = 500);
+    const char* name() const override { return "ismcts"; }
+    Move decide(const GameView& view) override;
+};
+
+// Agents are created per worker thread so they never share state
+using AgentFactory = std::function<std::unique_ptr<Agent>()>;
+
+// Factory for a built-in agent: "random", "greedy", "coup-first",
+// "role-aware", "linear" or "ismcts"
+AgentFactory makeAgentFactory(const std::string& name);
+
+} // namespace coup
@@ -0,0 +1,95 @@
+//tomergal40@gmail.com
+#pragma once
+#include "Game.hpp"
+#include "GameState.hpp"
+#include "Move.hpp"
+#include "TranspositionTable.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace coup {
+
+struct AlphaBetaConfig {
+    int maxDepth = 12;               // Deepest iteration of the iterative deepening
+    double seconds = 0.0;            // Time limit (0 = depth limit only)
+    std::size_t ttMegabytes = 16;
+};
+
+struct AlphaBetaResult {
+    Move best;
+    int value = 0;                   // From the searching seat's point of view
+    int depth = 0;                   // Deepest completed iteration
+    std::uint64_t nodes = 0;
+    double seconds = 0.0;
+
+    double nodesPerSecond() const { return seconds > 0.0 ? static_cast<double>(nodes) / seconds : 0.0; }
+    bool provenWin() const;
+    bool provenLoss() const;
+};
+
+// Exact search for positions with two active players, where with visible
+// coins the game is a perfect information duel. Negamax alpha-beta with
+// iterative deepening works on a single GameState: a move is made in place
+// and reverted from a small undo record (the seats it can touch plus bank,
+// turn and hash) instead of copying positions. Moves that do not end the
+// turn (bribe, spyOn, undo, coup defense) keep the same side to move. The
+// transposition table is keyed by the incrementally updated Zobrist hash,
+// and moves are tried TT move first, then by a static priority.
+class AlphaBeta {
+public:
+    // Scores at least this large are forced wins (MATE minus the distance)
+    static const int MATE = 1000000;
+    static const int MATE_BOUND = MATE - 1000;
+
+private:
+    // Everything a move can change: the active seats, the target seat, and
+    // the bank, turn and hash
+    struct UndoRecord {
+        std::uint64_t hash;
+        std::int16_t bank;
+        std::uint8_t currentTurn;
+        std::int8_t count;
+        std::int8_t index[3];
+        SeatState seats[3];
+    };
+
+    AlphaBetaConfig _config;
+    TranspositionTable _table;
+    GameState _state;
+    std::uint64_t _hash = 0;
+    int _active[2] = {-1, -1};       // The two active seats at the root
+    std::uint64_t _nodes = 0;
+    bool _aborted = false;
+    std::chrono::steady_clock::time_point _deadline;
+
+    void make(const Move& move, UndoRecord& undo);
+    void makePass(UndoRecord& undo);
+    void unmake(const UndoRecord& undo);
+    void save(UndoRecord& undo, int target) const;
+    void rehash(const UndoRecord& undo);
+
+    int evaluate(int ply) const;
+    void orderMoves(MoveList& moves, const Move& ttMove) const;
+    int negamax(int depth, int ply, int alpha, int beta);
+    bool outOfTime();
+
+    void load(const GameState& state);
+    std::uint64_t perftFrom(int depth);
+
+public:
+    explicit AlphaBeta(AlphaBetaConfig config = AlphaBetaConfig());
+
+    // Best move for `seat`, the seat to play in a position with exactly two
+    // active players. The transposition table is kept between searches.
+    AlphaBetaResult search(const GameState& state, int seat);
+    AlphaBetaResult search(const Game& game, int seat);
+
+    // Number of move sequences of the given length, using make/unmake (for
+    // testing move generation and the undo records)
+    std::uint64_t perft(const GameState& state, int depth);
+
+    void clear();
+};
+
+} // namespace coup
@@ -0,0 +1,91 @@
+//tomergal40@gmail.com
+#pragma once
+#include "GameState.hpp"
+#include "Ismcts.hpp"
+#include "Move.hpp"
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace coup {
+
+// True if `viewer` cannot tell the two positions apart: everything but the
+// coins of other seats is public, and of those the viewer sees its own and
+// those of the seat it spied on last
+bool samePublicView(const GameState& a, const GameState& b, int viewer);
+
+struct BeliefConfig {
+    std::size_t particles = 512;
+    double resampleThreshold = 0.5;  // Resample when the effective sample size drops below this share
+    std::uint64_t seed = 1;
+};
+
+// What one seat believes about the coins it cannot see, as a weighted set of
+// complete positions (particles). Every public move is replayed on every
+// particle: a particle in which the move is illegal, or whose public view
+// afterwards differs from the real one (bank, sanctions, eliminations, spied
+// coins, ...), is dropped, and the others are weighted by the chance that an
+// opponent choosing uniformly among its legal moves picks that move. When
+// too much weight sits on too few particles they are resampled with
+// systematic resampling into preallocated storage, so tracking never
+// allocates after construction.
+class BeliefTracker {
+private:
+    BeliefConfig _config;
+    int _viewer;
+    std::vector<GameState> _particles;
+    std::vector<GameState> _scratch;      // Resampling target, swapped with _particles
+    std::vector<double> _weights;         // Normalized
+    std::mt19937_64 _rng;
+    std::uint64_t _resamples = 0;
+    std::uint64_t _resets = 0;
+
+    // Deal every particle anew from a position with the same public view
+    void reset(const GameState& state);
+    // Drop particles that disagree with `after`, normalize, resample if needed
+    void update(const GameState& after);
+
+public:
+    // Starts from `state` with the hidden coins dealt out at random (keeping
+    // their sum, which the bank reveals); throws GameException on a bad config
+    BeliefTracker(const GameState& state, int viewer, BeliefConfig config = BeliefConfig());
+
+    // `seat` played `move`, leading to `after` (only its public view is used)
+    void observe(int seat, const Move& move, const GameState& after);
+    // The seat to play had no legal move and passed, leading to `after`
+    void observePass(const GameState& after);
+
+    void resample();
+    double effectiveSampleSize() const;
+
+    double expectedCoins(int seat) const;
+    double probabilityAtLeast(int seat, int coins) const;
+
+    int viewer() const { return _viewer; }
+    std::size_t size() const { return _particles.size(); }
+    const GameState& particle(std::size_t i) const { return _particles[i]; }
+    double weight(std::size_t i) const { return _weights[i]; }
+    std::uint64_t resamples() const { return _resamples; }
+    // Times every particle was ruled out and the set was dealt anew
+    std::uint64_t resets() const { return _resets; }
+
+    // Determinizer drawing the hidden coins from a copy of the current
+    // beliefs, for searches run on behalf of the viewer
+    std::shared_ptr<const Determinizer> determinizer() const;
+};
+
+// Fills the hidden coins from a particle drawn by weight (binary search over
+// the cumulative weights, so a draw costs O(log n) and is thread safe)
+class BeliefDeterminizer : public Determinizer {
+private:
+    int _viewer;
+    std::vector<GameState> _particles;
+    std::vector<double> _cumulative;
+
+public:
+    BeliefDeterminizer(int viewer, std::vector<GameState> particles, const std::vector<double>& weights);
+    void determinize(GameState& state, int viewer, std::mt19937_64& rng) const override;
+};
+
+} // namespace coup
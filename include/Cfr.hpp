@@ -0,0 +1,138 @@
+//tomergal40@gmail.com
+#pragma once
+#include "GameState.hpp"
+#include "Move.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+
+namespace coup {
+
+// Regrets and average strategy weights of every information set seen so
+// far, shared by all training threads without locks. Slots are an open
+// addressing table keyed by information set hash; the first visit claims a
+// slot with a CAS on its key and then publishes a run of per-move counters
+// from a preallocated arena. Counters are updated with relaxed atomic adds,
+// so concurrent updates are never lost but may interleave.
+class RegretTable {
+public:
+    struct Action {
+        std::uint8_t code = 0;                    // Move encoded by moveCode()
+        std::atomic<float> regret{0.0f};          // Cumulative counterfactual regret
+        std::atomic<float> strategy{0.0f};        // Sum of the strategies played here
+    };
+
+private:
+    static const std::uint32_t NOT_READY = 0xFFFFFFFFu;
+
+    struct Slot {
+        std::atomic<std::uint64_t> key{0};        // 0 = empty
+        std::atomic<std::uint32_t> offset{NOT_READY};
+        std::uint8_t count = 0;                   // Written before offset is published
+    };
+
+    std::unique_ptr<Slot[]> _slots;
+    std::size_t _mask;
+    std::unique_ptr<Action[]> _actions;
+    std::size_t _actionCapacity;
+    std::atomic<std::size_t> _used{0};
+    std::atomic<std::size_t> _size{0};
+
+public:
+    // Capacity is rounded down to a power of two information sets, with room
+    // for `actionsPerSet` moves each on average
+    explicit RegretTable(std::size_t infoSets = 1 << 18, std::size_t actionsPerSet = 8);
+
+    RegretTable(const RegretTable&) = delete;
+    RegretTable& operator=(const RegretTable&) = delete;
+
+    static std::uint8_t moveCode(const Move& move);
+    static Move moveFromCode(std::uint8_t code);
+
+    // Counters of an information set, or nullptr if it was never visited
+    // (or is still being created by another thread)
+    Action* find(std::uint64_t key, int& count) const;
+    // Same, creating counters for `moves` on the first visit; nullptr when
+    // the table is full
+    Action* findOrCreate(std::uint64_t key, const MoveList& moves, int& count);
+
+    std::size_t size() const { return _size.load(std::memory_order_relaxed); }
+    std::size_t capacity() const { return _mask + 1; }
+
+    // Binary checkpoint of every counter. Not safe while training runs.
+    void save(const std::string& path) const;
+    // Adds the information sets of a checkpoint to an empty table
+    void load(const std::string& path);
+};
+
+struct CfrConfig {
+    unsigned threads = 0;                 // Training threads (0 = all cores)
+    int horizon = 8;                      // Decisions per traversal before a random playout takes over
+    int maxPlies = 400;                   // Playouts longer than this score as a draw
+    std::size_t infoSets = 1 << 18;       // Regret table capacity
+    std::string checkpointPath;           // Empty disables checkpoints
+    std::uint64_t checkpointEvery = 1000; // Iterations between checkpoints
+    std::uint64_t seed = 1;
+};
+
+struct CfrResult {
+    std::uint64_t iterations = 0;
+    std::uint64_t nodes = 0;              // Decision nodes visited
+    std::size_t infoSets = 0;
+    int checkpoints = 0;
+    double seconds = 0.0;
+
+    double iterationsPerSecond() const { return seconds > 0.0 ? static_cast<double>(iterations) / seconds : 0.0; }
+};
+
+// Monte Carlo counterfactual regret minimization with external sampling, on
+// the GameState rules (which mirror Player and the role classes). Each
+// iteration runs one traversal per seat: the traversing seat tries every
+// legal move and updates its regrets, the other seats sample one move from
+// their current regret matching strategy and add it to their average.
+//
+// An information set is what the seat to move sees: the position with the
+// coin counts of the other active seats hidden (except the seat it spied
+// on), plus the number of actions already taken this turn. History is not
+// part of it, which keeps the table small at the cost of perfect recall.
+// Traversals explore `horizon` decisions exactly and finish the game with a
+// random playout, which makes the long games of Coup tractable.
+class CfrTrainer {
+private:
+    CfrConfig _config;
+    RegretTable _table;
+
+    double traverse(GameState& state, int turnActions, int traverser, int depth, int plies,
+                    std::mt19937_64& rng, std::uint64_t& nodes);
+    // Regret matching over the legal moves; missing counters count as 0
+    static void currentStrategy(const RegretTable::Action* actions, int count, const MoveList& moves,
+                                double probabilities[MAX_MOVES]);
+
+public:
+    explicit CfrTrainer(CfrConfig config = CfrConfig());
+
+    const CfrConfig& config() const { return _config; }
+    const RegretTable& table() const { return _table; }
+
+    // Runs iterations from `root`, checkpointing every checkpointEvery
+    // iterations and once more at the end. Training continues from the
+    // current table, so it can be called repeatedly or after load().
+    CfrResult train(const GameState& root, std::uint64_t iterations);
+
+    void save(const std::string& path) const { _table.save(path); }
+    void load(const std::string& path) { _table.load(path); }
+
+    // Average strategy of the seat to move over its legal moves (uniform
+    // for an unseen information set, which returns false)
+    bool averageStrategy(const GameState& state, int turnActions, MoveList& moves,
+                         double probabilities[MAX_MOVES]) const;
+    // Most likely move of the average strategy
+    Move bestMove(const GameState& state, int turnActions = 0) const;
+
+    static std::uint64_t infoSetKey(const GameState& state, int turnActions);
+};
+
+} // namespace coup
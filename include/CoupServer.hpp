@@ -0,0 +1,128 @@
+//tomergal40@gmail.com
+#pragma once
+#include "GameHost.hpp"
+#include "GameState.hpp"
+#include "Move.hpp"
+#include "Protocol.hpp"
+#include "RoleId.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace coup {
+
+struct ServerConfig {
+    std::string host = "127.0.0.1";  // TCP address to listen on
+    int port = 7420;                 // 0 picks a free port (see CoupServer::port)
+    std::string unixPath;            // Listen on this Unix domain socket instead of TCP
+    unsigned loops = 0;              // Event loops, one thread each (0 = all cores)
+    std::size_t maxPendingOutput = 1 << 20; // Unsent reply bytes before a client that does not read is dropped
+    GameHostConfig games;            // Threads and shards running the games
+};
+
+// Serves hosted games over the binary protocol in Protocol.hpp. Every event
+// loop is one thread with its own epoll instance: for TCP each loop has its
+// own listening socket bound with SO_REUSEPORT, so the kernel spreads new
+// connections over the loops; a Unix socket is shared by all loops with
+// EPOLLEXCLUSIVE. A connection stays on the loop that accepted it. Requests
+// are parsed on the loop and run on the game's shard of a GameHost; the
+// shard formats the reply into the loop's mailbox and wakes the loop
+// through an eventfd, so games from any connection can be played from any
+// other connection without locks around the games themselves. A game is
+// released by CloseGame, or once it is over and every connection that used
+// it has gone.
+class CoupServer {
+private:
+    struct Loop;
+
+    ServerConfig _config;
+    std::vector<std::unique_ptr<Loop>> _loops;  // Before _host: the host drains into their mailboxes
+    // Per host shard: how many connections use each game of the shard. Only
+    // touched by tasks on that shard (and declared before _host for the same reason).
+    std::vector<std::unordered_map<GameId, unsigned>> _clients;
+    GameHost _host;
+    int _port = 0;
+    bool _started = false;
+    std::atomic<bool> _running{false};
+    std::atomic<std::uint64_t> _connections{0};
+    std::atomic<std::uint64_t> _requests{0};
+
+    void run(Loop& loop);
+    void accept(Loop& loop);
+    void receive(Loop& loop, int fd);
+    void flush(Loop& loop, int fd);
+    void deliver(Loop& loop);
+    void closeConnection(Loop& loop, int fd);
+    // Count the connection as a user of the game (once)
+    void join(Loop& loop, int fd, GameId game);
+    // A connection that used the game has gone; close it if it is over and was the last
+    void leave(GameId game);
+    // Handles one frame body; returns false if the connection must be closed
+    bool handle(Loop& loop, int fd, const char* body, std::size_t size);
+    // Queue a reply formatted on a game shard for a connection of `loop`
+    void post(Loop& loop, int fd, std::uint32_t generation, std::string frame);
+
+public:
+    explicit CoupServer(ServerConfig config = ServerConfig());
+    ~CoupServer();
+    CoupServer(const CoupServer&) = delete;
+    CoupServer& operator=(const CoupServer&) = delete;
+
+    // Bind and start the loops; throws GameException if the socket cannot be set up
+    void start();
+    // Stop the loops and close every connection; the server can be started again
+    void stop();
+
+    int port() const { return _port; }
+    std::uint64_t connections() const { return _connections.load(std::memory_order_relaxed); }
+    std::uint64_t requests() const { return _requests.load(std::memory_order_relaxed); }
+    GameHost& host() { return _host; }
+};
+
+// Reply to an Action request
+struct ActionReply {
+    MoveStatus status = MoveStatus::Ok;
+    int currentTurn = 0;
+    bool gameOver = false;
+    int bank = 0;
+    int coins = 0;                   // Coins of the acting seat afterwards
+};
+
+// Blocking client for one connection. Each call sends one request and waits
+// for its reply; an Error reply or a lost connection throws GameException.
+class CoupClient {
+private:
+    int _fd = -1;
+    std::string _in;
+    std::uint32_t _nextRequest = 1;
+
+    explicit CoupClient(int fd) : _fd(fd) {}
+    // Send the frame in `out` and return the body of the reply
+    std::string roundTrip(const std::string& out, std::uint32_t request);
+
+public:
+    static CoupClient connectTcp(const std::string& host, int port);
+    static CoupClient connectUnix(const std::string& path);
+    ~CoupClient();
+    CoupClient(CoupClient&& other) noexcept;
+    CoupClient& operator=(CoupClient&& other) noexcept;
+    CoupClient(const CoupClient&) = delete;
+    CoupClient& operator=(const CoupClient&) = delete;
+
+    // No roles creates an empty game for addPlayer/startGame
+    GameId createGame(const std::vector<RoleId>& roles);
+    int addPlayer(GameId game, RoleId role, const std::string& name);
+    void startGame(GameId game);
+    ActionReply act(GameId game, int seat, const Move& move);
+    GameState state(GameId game);
+    void closeGame(GameId game);
+
+    // Send raw bytes (for tests of malformed input)
+    void sendRaw(const std::string& bytes);
+};
+
+} // namespace coup
@@ -0,0 +1,82 @@
+//tomergal40@gmail.com
+#pragma once
+#include "GameState.hpp"
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace coup {
+// Forward declaration
+class Game;
+
+// Features of a position seen by one seat. The coup threat features use the
+// same thresholds as the rules: 7 coins pay for a coup, and with 10 or more
+// a player must coup (Player::mustCoup).
+enum class EvalFeature {
+    Active,                 // 1 while the seat is still in the game
+    Coins,
+    CanCoup,                // 1 with 7+ coins
+    MustCoup,               // 1 with 10+ coins
+    Sanctioned,
+    Opponents,              // Active opponents
+    RichestOpponent,        // Coins of the richest active opponent
+    OpponentThreats,        // Active opponents with 7+ coins
+    OpponentsSanctioned,    // Active opponents under sanction
+    Governor,               // One-hot role of the seat, in RoleId order
+    Spy,
+    Baron,
+    General,
+    Judge,
+    Merchant
+};
+
+const int EVAL_FEATURE_COUNT = 15;
+
+// Weights of the linear evaluation: score = bias + sum of weight * feature
+struct EvalWeights {
+    float bias = 0.0f;
+    std::array<float, EVAL_FEATURE_COUNT> weights{};
+
+    float& operator[](EvalFeature feature) { return weights[static_cast<std::size_t>(feature)]; }
+    float operator[](EvalFeature feature) const { return weights[static_cast<std::size_t>(feature)]; }
+
+    // Hand tuned weights: staying in the game and removing opponents dominate,
+    // then coup threats and coins
+    static EvalWeights defaults();
+};
+
+// Positions stored structure-of-arrays: one column of floats per feature,
+// so the evaluation reads every feature of 8 positions with one load. The
+// storage is allocated once; adding positions never allocates.
+class PositionBatch {
+private:
+    std::size_t _capacity;
+    std::size_t _size = 0;
+    std::vector<float> _columns;    // Feature f of position i at [f * _capacity + i]
+
+public:
+    explicit PositionBatch(std::size_t capacity);
+
+    std::size_t size() const { return _size; }
+    std::size_t capacity() const { return _capacity; }
+    bool full() const { return _size == _capacity; }
+    void clear() { _size = 0; }
+
+    // Append `state` as seen by `seat`; throws GameException when the batch is full
+    void add(const GameState& state, int seat);
+    void add(const Game& game, int seat);
+
+    const float* column(EvalFeature feature) const { return &_columns[static_cast<std::size_t>(feature) * _capacity]; }
+    float feature(std::size_t position, EvalFeature feature) const { return column(feature)[position]; }
+};
+
+// Score every position of the batch into scores[0 .. batch.size()). evaluate()
+// uses AVX2 when the CPU has it (checked once) and the scalar loop otherwise.
+// The AVX2 path uses fused multiply-add, so the two may differ in the last bits.
+void evaluate(const EvalWeights& weights, const PositionBatch& batch, float* scores);
+void evaluateScalar(const EvalWeights& weights, const PositionBatch& batch, float* scores);
+
+// True if this build and CPU can run the AVX2 path
+bool hasAvx2Evaluation();
+
+} // namespace coup
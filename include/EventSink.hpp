@@ -0,0 +1,114 @@
+//tomergal40@gmail.com
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+namespace coup {
+// Forward declaration
+class Game;
+
+// Everything the engine reports besides exceptions
+enum class EventType : std::uint8_t {
+    PlayerAdded,          // actor joined the game
+    MustCoup,             // actor starts a turn with 10+ coins
+    GovernorTax,          // actor (Governor) collected 3 coins
+    TaxUndone,            // actor (Governor) undid the tax of target
+    Invested,             // actor (Baron) invested 3 coins for 6
+    SanctionCompensation, // actor (Baron) got 1 coin after being sanctioned by target
+    CoupBlocked,          // actor (General) blocked the coup against target
+    ArrestRefund,         // actor (General) got back the coin taken by target
+    CoupDefensePrepared,  // actor (General) prepared to defend target
+    BribeBlocked,         // actor (Judge) blocked the bribe of target
+    JudgeSanctioned,      // actor (Judge) was sanctioned by target
+    MerchantBonus,        // actor (Merchant) got an extra coin at turn start
+    MerchantArrestFee,    // actor (Merchant) paid 2 coins when arrested by target
+    MerchantCannotPay,    // actor (Merchant) could not pay the arrest fee
+    SpiedOn,              // actor (Spy) saw that target has `amount` coins
+    ArrestBlocked         // actor (Spy) prevented target from arresting
+};
+
+// One engine event. Players are referred to by seat (-1 for none).
+struct Event {
+    EventType type;
+    std::int8_t actor;
+    std::int8_t target;
+    std::int16_t amount;
+};
+
+// Append the human readable line for an event (without a newline)
+void appendEvent(std::string& out, const Game& game, const Event& event);
+
+// Receives the events of every game it is attached to (see Game::setEventSink)
+class EventSink {
+public:
+    virtual ~EventSink() = default;
+    virtual void onEvent(const Game& game, const Event& event) = 0;
+};
+
+// Writes each event to std::cout as it happens. Shared by all games and
+// safe to use from several threads; lines never interleave.
+class ConsoleEventSink : public EventSink {
+private:
+    std::mutex _mutex;
+public:
+    void onEvent(const Game& game, const Event& event) override;
+
+    // The sink every new Game starts with
+    static ConsoleEventSink& instance();
+};
+
+// Collects formatted events in memory and writes them to a stream in large
+// chunks. Not thread safe: use one per thread, e.g. one per simulation worker.
+class BufferedEventSink : public EventSink {
+private:
+    std::ostream* _out;
+    std::string _buffer;
+    std::size_t _capacity;
+    std::uint64_t _events = 0;
+
+public:
+    // `out` may be nullptr to keep everything in memory until flush()
+    explicit BufferedEventSink(std::ostream* out = nullptr, std::size_t capacity = 64 * 1024);
+    ~BufferedEventSink() override;
+    BufferedEventSink(const BufferedEventSink&) = delete;
+    BufferedEventSink& operator=(const BufferedEventSink&) = delete;
+
+    void onEvent(const Game& game, const Event& event) override;
+
+    // Write the buffered lines to the output stream (if any) and empty the buffer
+    void flush();
+    const std::string& buffered() const { return _buffer; }
+    std::uint64_t eventCount() const { return _events; }
+};
+
+// Appends events to a file from a background thread. Producers only format
+// the line into a shared buffer; the writer thread swaps the buffer out and
+// does the file I/O, so games never wait on the disk.
+class AsyncFileEventSink : public EventSink {
+private:
+    std::ofstream _file;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::string _pending;
+    bool _stopping = false;
+    std::thread _writer;
+
+    void writerLoop();
+
+public:
+    // Throws GameException if the file cannot be opened
+    explicit AsyncFileEventSink(const std::string& path);
+    ~AsyncFileEventSink() override;
+    AsyncFileEventSink(const AsyncFileEventSink&) = delete;
+    AsyncFileEventSink& operator=(const AsyncFileEventSink&) = delete;
+
+    void onEvent(const Game& game, const Event& event) override;
+};
+
+} // namespace coup
@@ -1,6 +1,14 @@
 //tomergal40@gmail.com
 #pragma once
+#include "ActionType.hpp"
+#include "EventSink.hpp"
+#include "GameState.hpp"
+#include "Move.hpp"
+#include "RingBuffer.hpp"
+#include <array>
+#include <cstdint>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <memory>
 
@@ -8,28 +16,60 @@ namespace coup {
 // Forward declaration
 class Player;
 
+// Maximum number of seats in a game
+const std::size_t MAX_PLAYERS = 6;
+
+// Most recent pending actions kept for getPendingActions()
+const std::size_t PENDING_LOG_CAPACITY = 64;
+
 class Game {
 public:
-    // Structure to represent a pending action
+    // Structure to represent a pending action. Players are referred to by
+    // seat (-1 for none), so recording an action never allocates.
     struct PendingAction {
-        std::string playerName;
-        std::string actionType;
-        std::shared_ptr<Player> target;
-        std::shared_ptr<Player> victim;
+        int actor;
+        ActionType type;
+        int target;
+        int victim;
         
         // Constructor with all parameters
-        PendingAction(const std::string& name, const std::string& type, 
-                      std::shared_ptr<Player> t = nullptr, 
-                      std::shared_ptr<Player> v = nullptr)
-            : playerName(name), actionType(type), target(t), victim(v) {}
+        PendingAction(int a = -1, ActionType t = ActionType::Gather, int tgt = -1, int v = -1)
+            : actor(a), type(t), target(tgt), victim(v) {}
     };
     
 private:
+    // One journal slot per (seat, action type). Clearing a slot bumps its
+    // generation, which invalidates every log entry recorded under it.
+    // A player's slots expire when that player's next turn starts, so an
+    // action can only be undone until its author plays again.
+    struct JournalSlot {
+        PendingAction first;        // Oldest live action of this kind
+        std::uint32_t count = 0;    // Number of live actions of this kind
+        std::uint32_t generation = 0;
+    };
+    
+    // Entry of the insertion ordered log used by getPendingActions()
+    struct LogEntry {
+        PendingAction action;
+        std::uint32_t generation = 0;
+    };
+    
     std::vector<std::shared_ptr<Player>> _players;
     int _currentTurn;
     int _bank;
     bool _gameStarted;
-    std::vector<PendingAction> _pendingActions;
+    std::unordered_map<std::string, std::size_t> _seatByName;
+    std::array<std::array<JournalSlot, ACTION_TYPE_COUNT>, MAX_PLAYERS> _journal; // Indexed [seat][action type]
+    RingBuffer<LogEntry, PENDING_LOG_CAPACITY> _actionLog;
+    std::uint64_t _hash; // Zobrist hash of snapshot(), maintained incrementally
+    EventSink* _events;  // Not owned; nullptr is the null sink
+    
+    // Seat of a player by name (hash lookup), or -1 if no such player was added
+    int seatOf(const std::string& playerName) const;
+    bool isLive(const LogEntry& entry) const;
+    void clearSlot(std::size_t seat, ActionType type);
+    // Drop every pending action of a seat (called when its turn starts)
+    void expirePendingActions(std::size_t seat);
     
 public:
     Game();
@@ -38,35 +78,80 @@ public:
     void addPlayer(std::shared_ptr<Player> player);
     void removePlayer(const std::string& name);
     std::shared_ptr<Player> getPlayer(const std::string& name);
+    std::shared_ptr<Player> getPlayer(int seat);
     std::shared_ptr<Player> getCurrentPlayer();
     
     // Game state and turn management
-    std::string turn() const;
+    const std::string& turn() const;
     std::vector<std::string> players() const;
     std::string winner() const;
     void startGame();
     bool isGameOver() const;
     void nextTurn();
     
+    // Plain data snapshot of the whole position, and restoring one taken from
+    // a game with the same seats and roles. Pending action targets are not
+    // part of the snapshot.
+    GameState snapshot() const;
+    void restore(const GameState& state);
+    
+    // Zobrist hash of the current position (equal to zobrist::hash(snapshot())).
+    // Players report every change of hashed state through updateHash.
+    std::uint64_t hash() const;
+    void updateHash(std::uint64_t delta);
+    
+    // Exception-free move interface. legalMoves fills a stack allocated list
+    // using the same rules the action methods enforce (see rules::legalMoves);
+    // tryApply plays a move through the regular Player methods if it is legal
+    // and otherwise returns the reason instead of throwing.
+    void legalMoves(int seat, MoveList& moves) const;
+    MoveStatus checkMove(int seat, const Move& move) const;
+    MoveStatus tryApply(int seat, const Move& move);
+    
+    // Event log. New games report to ConsoleEventSink::instance(); nullptr
+    // discards events. The sink is not owned and must outlive the game.
+    // Building with COUP_NO_EVENTS compiles every emit() out of the engine.
+    void setEventSink(EventSink* sink);
+    EventSink* eventSink() const;
+    void emit(EventType type, int actor, int target = -1, int amount = 0) const {
+#ifndef COUP_NO_EVENTS
+        if (_events) {
+            _events->onEvent(*this, Event{type, static_cast<std::int8_t>(actor),
+                                          static_cast<std::int8_t>(target), static_cast<std::int16_t>(amount)});
+        }
+#else
+        (void)type; (void)actor; (void)target; (void)amount;
+#endif
+    }
+    // Name of the player at a seat ("?" for an invalid seat)
+    const std::string& playerName(int seat) const;
+    
     // Bank operations
     int getBank() const;
     void removeFromBank(int amount);
     void addToBank(int amount);
     
-    // Turn checking
+    // Turn checking (players are identified by seat, see Player::seat)
+    bool isPlayerTurn(int seat) const;
     bool isPlayerTurn(const std::string& playerName) const;
     int countActivePlayers() const;
     
-    // Pending actions management
-    void addPendingAction(const std::string& playerName, const std::string& actionType);
-    void addPendingAction(const std::string& playerName, const std::string& actionType, 
-                         std::shared_ptr<Player> target);
-    void addPendingAction(const std::string& playerName, const std::string& actionType, 
-                         std::shared_ptr<Player> target, std::shared_ptr<Player> victim);
-    bool hasPendingAction(const std::string& playerName, const std::string& actionType) const;
-    void clearPendingAction(const std::string& playerName, const std::string& actionType);
+    // Pending actions management (O(1) per player and action type)
+    void addPendingAction(int seat, ActionType type, int target = -1, int victim = -1);
+    void addPendingAction(const std::string& playerName, ActionType type, int target = -1, int victim = -1);
+    bool hasPendingAction(int seat, ActionType type) const;
+    bool hasPendingAction(const std::string& playerName, ActionType type) const;
+    void clearPendingAction(int seat, ActionType type);
+    void clearPendingAction(const std::string& playerName, ActionType type);
+    PendingAction getPendingAction(const std::string& playerName, ActionType type) const;
     void clearAllPendingActions(const std::string& playerName);
     std::vector<PendingAction> getPendingActions() const;
+    
+    // String keyed adapters, kept for existing callers
+    void addPendingAction(const std::string& playerName, const std::string& actionType,
+                         int target = -1, int victim = -1);
+    bool hasPendingAction(const std::string& playerName, const std::string& actionType) const;
+    void clearPendingAction(const std::string& playerName, const std::string& actionType);
     PendingAction getPendingAction(const std::string& playerName, const std::string& actionType) const;
 };
 
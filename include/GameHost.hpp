@@ -0,0 +1,174 @@
+//tomergal40@gmail.com
+#pragma once
+#include "Game.hpp"
+#include "Move.hpp"
+#include "MpscQueue.hpp"
+#include "RoleId.hpp"
+#include "WorkStealingPool.hpp"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace coup {
+
+using GameId = std::uint32_t;
+
+// Runs on the shard of the game with exclusive access to it. For moves the
+// status is the one tryApply returned; for posted tasks it is Ok.
+using GameCallback = std::function<void(Game& game, MoveStatus status)>;
+// Runs on the shard instead of a task or reaction whose game does not exist
+// (never created, or closed)
+using MissingCallback = std::function<void()>;
+
+struct GameHostConfig {
+    unsigned threads = 0;            // Pool threads (0 = all cores)
+    unsigned shards = 0;             // Game shards (0 = 8 per thread, so idle threads have shards to steal)
+};
+
+// Owns many games and plays the moves submitted for them. Game g lives on
+// shard g % shards for its whole life, and a shard is run by one pool thread
+// at a time, so games and their players are never touched by two threads at
+// once and need no locks of their own (Player's raw Game* stays valid since
+// every Game is heap allocated and never moves). Commands for a shard wait
+// in its inbox; submitting one schedules the shard on the work-stealing pool
+// if it is not scheduled yet, and the shard runs its inbox in batches.
+// Out-of-turn reactions skip the inbox: every shard has a lock-free queue
+// for them (see react()).
+class GameHost {
+private:
+    enum class CommandKind : std::uint8_t { Create, Move, Task, Close, React, Shard };
+
+    struct Command {
+        CommandKind kind = CommandKind::Task;
+        GameId game = 0;
+        int seat = -1;
+        Move move;
+        std::uint8_t players = 0;
+        std::array<RoleId, MAX_PLAYERS> roles{};
+        GameCallback done;
+        MissingCallback missing;
+        std::function<void()> shardTask;         // CommandKind::Shard; `game` holds the shard index
+    };
+
+    struct Reaction : MpscNode {
+        GameId game = 0;
+        int seat = -1;
+        Move move;
+        GameCallback done;
+        MissingCallback missing;
+        std::uint64_t after = 0;                 // Commands of the shard submitted before it
+    };
+
+    struct CloseHook {
+        const void* owner;
+        std::function<void()> hook;
+    };
+
+    struct alignas(64) Shard {
+        std::mutex inboxMutex;
+        std::vector<Command> inbox;              // Guarded by inboxMutex
+        bool scheduled = false;                  // Guarded by inboxMutex
+        std::atomic<std::uint64_t> submitted{0}; // Commands ever queued; written under inboxMutex
+        std::vector<Command> running;            // Owned by the thread running the shard
+        std::uint64_t executed = 0;              // Commands ever run, owned likewise
+        std::unordered_map<GameId, std::unique_ptr<Game>> games;
+        std::unordered_multimap<GameId, CloseHook> closeHooks;
+        std::atomic<std::uint64_t> moves{0};
+
+        // Reactions wait here until the commands submitted before them have
+        // run. `armed` is set while a React command is on its way, so a burst
+        // of reactions schedules the shard once.
+        MpscQueue reactions;
+        std::atomic<bool> armed{false};
+        Reaction* held = nullptr;                // Popped, but early: the next to run
+        std::uint64_t consumed = 0;              // Reactions taken off the queue in the running batch
+    };
+
+    unsigned _shardCount;
+    std::unique_ptr<Shard[]> _shards;
+    std::atomic<GameId> _nextGame{0};
+    std::atomic<std::uint64_t> _liveGames{0};
+    std::atomic<std::uint64_t> _dropped{0};
+    std::atomic<std::uint64_t> _failed{0};
+    std::atomic<std::uint64_t> _pending{0};
+    std::mutex _drainMutex;
+    std::condition_variable _drained;
+    WorkStealingPool _pool;                      // Last, so it stops before the shards go away
+
+    void enqueue(Command command);
+    void runShard(std::uint32_t shard);
+    void execute(Shard& shard, Command& command);
+    // Run a user callback; an exception it throws is counted and swallowed,
+    // as it would otherwise end the pool thread (and the process)
+    void invoke(const GameCallback& callback, Game& game, MoveStatus status);
+    // Count a command or reaction whose game is gone and run its `missing`
+    void drop(const MissingCallback& missing);
+    Game* find(Shard& shard, GameId game);
+    // Apply the shard's queued reactions, in push order, up to the first one
+    // still waiting for a command (reactions to games that are gone are dropped)
+    void runReactions(Shard& shard);
+
+public:
+    explicit GameHost(GameHostConfig config = GameHostConfig());
+    ~GameHost();
+    GameHost(const GameHost&) = delete;
+    GameHost& operator=(const GameHost&) = delete;
+
+    // Start a game with one player per role (named P0, P1, ...). The game is
+    // built on its shard; `ready`, if given, runs there once it has started.
+    // With no roles the game is left empty and unstarted, for players to be
+    // added by posted tasks.
+    GameId createGame(const std::vector<RoleId>& roles, GameCallback ready = nullptr);
+
+    // Play a move; `done` runs on the game's shard with the result. Commands
+    // for a game run in the order they were submitted from one thread.
+    // Commands for games that do not exist (or were closed) are dropped;
+    // post() and react() can run a MissingCallback instead.
+    void submit(GameId game, int seat, const Move& move, GameCallback done = nullptr);
+    // Play an out-of-turn reaction (an undo or a spy's peek) from any thread
+    // without a lock: it is pushed on the shard's reaction queue together
+    // with the number of commands submitted to the shard so far, and is
+    // applied once those have run, before any command submitted after
+    // react() returned. So a reaction keeps its place among the commands of
+    // its thread (a pipelined Tax then Undo undoes that tax) without taking
+    // the inbox lock. That defines the reaction window: the rules accept a
+    // block until the blocked action's author starts its next turn (later
+    // it gets IllegalMove).
+    void react(GameId game, int seat, const Move& move, GameCallback done = nullptr, MissingCallback missing = nullptr);
+    // Run `task` on the game's shard (it must not be empty), or `missing` if
+    // the game does not exist by then
+    void post(GameId game, GameCallback task, MissingCallback missing = nullptr);
+    void closeGame(GameId game);
+    // Run `hook` on the game's shard when the game is closed, before it is
+    // destroyed; `owner` tells hooks apart for forgetClose. Both may only be
+    // called on the game's shard (from a task for the game or its shard).
+    void onClose(GameId game, const void* owner, std::function<void()> hook);
+    void forgetClose(GameId game, const void* owner);
+    // Run `task` on a shard itself, ordered with its games' commands (for
+    // state kept per shard, like timers)
+    void postToShard(unsigned shard, std::function<void()> task);
+
+    // Wait until every submitted command has run
+    void drain();
+
+    unsigned shardCount() const { return _shardCount; }
+    unsigned shardOf(GameId game) const { return game % _shardCount; }
+    unsigned threads() const { return _pool.threads(); }
+    // Ids handed out so far: every id below this names a game (possibly closed).
+    // Ids are not reused; closed games leave nothing behind.
+    GameId gamesCreated() const { return _nextGame.load(std::memory_order_relaxed); }
+    std::uint64_t liveGames() const { return _liveGames.load(std::memory_order_relaxed); }
+    std::uint64_t movesPlayed() const;
+    std::uint64_t droppedCommands() const { return _dropped.load(std::memory_order_relaxed); }
+    // Callbacks and tasks that threw
+    std::uint64_t failedCallbacks() const { return _failed.load(std::memory_order_relaxed); }
+    std::uint64_t steals() const { return _pool.steals(); }
+};
+
+} // namespace coup
@@ -0,0 +1,104 @@
+//tomergal40@gmail.com
+#pragma once
+#include "ActionType.hpp"
+#include "Move.hpp"
+#include "RoleId.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace coup {
+
+// Seat flags stored in SeatState::flags
+const std::uint8_t SEAT_ACTIVE = 1 << 0;
+const std::uint8_t SEAT_SANCTIONED = 1 << 1;
+const std::uint8_t SEAT_CAN_GATHER = 1 << 2;
+const std::uint8_t SEAT_CAN_TAX = 1 << 3;
+
+const std::size_t STATE_MAX_SEATS = 6;
+
+// Packed state of one seat (8 bytes)
+struct SeatState {
+    std::int16_t coins;
+    RoleId role;
+    std::uint8_t flags;          // SEAT_* bits
+    std::int8_t lastArrested;    // Seat this player arrested last, -1 for none
+    std::int8_t spyTarget;       // Spy only: seat spied on last, -1 for none
+    std::uint16_t pending;       // Bit per ActionType with a live pending action
+
+    bool active() const { return flags & SEAT_ACTIVE; }
+    bool sanctioned() const { return flags & SEAT_SANCTIONED; }
+    bool hasPending(ActionType type) const { return pending & (1u << static_cast<unsigned>(type)); }
+    bool mustCoup() const { return coins >= 10; }
+
+    bool operator==(const SeatState& other) const = default;
+};
+
+// Complete position of a game as plain data. Copying it is a 56 byte memcpy,
+// which is what search and rollouts need instead of cloning Game and Players.
+struct GameState {
+    std::int16_t bank;
+    std::uint8_t playerCount;
+    std::uint8_t currentTurn;
+    std::uint8_t started;
+    std::uint8_t reserved[3];    // Keeps the layout free of uninitialized padding
+    SeatState seats[STATE_MAX_SEATS];
+
+    SeatState& seat(int index) { return seats[index]; }
+    const SeatState& seat(int index) const { return seats[index]; }
+
+    bool operator==(const GameState& other) const = default;
+};
+
+static_assert(std::is_trivially_copyable_v<GameState>, "GameState must be memcpy-able");
+static_assert(std::is_standard_layout_v<GameState>, "GameState must be plain data");
+static_assert(sizeof(SeatState) == 8, "SeatState is expected to pack into 8 bytes");
+
+// Result of checking or applying a move
+enum class MoveStatus : std::uint8_t {
+    Ok,
+    NotYourTurn,
+    NotEnoughCoins,
+    MustCoup,           // 10+ coins: only coup is allowed
+    Sanctioned,
+    TargetNotActive,
+    InvalidTarget,
+    RepeatedArrest,     // Same player arrested twice in a row
+    WrongRole,          // Role specific move by another role
+    BankEmpty,
+    IllegalMove         // Anything else the rules forbid (e.g. nothing to undo)
+};
+
+const char* toString(MoveStatus status);
+
+// Rules engine operating directly on GameState. The rules mirror Player and
+// its role subclasses exactly, including the order of the legality checks,
+// so a move is Ok here exactly when the matching Player call does not throw.
+namespace rules {
+
+// A fresh, started position for the given roles (bank 100, nobody has coins)
+GameState initialState(const RoleId* roles, int playerCount);
+
+MoveStatus check(const GameState& state, int seat, const Move& move);
+
+// Fill `moves` with every move `seat` may make now, in or out of turn.
+// Hostile moves against oneself are left out (only the coup defense may
+// target its own seat), and a Spy is offered spyOn once per turn since
+// repeating it changes nothing but the spied seat.
+void legalMoves(const GameState& state, int seat, MoveList& moves);
+
+// Check and, if legal, apply a move (ending the turn where the action does)
+MoveStatus apply(GameState& state, int seat, const Move& move);
+
+// Advance to the next active seat and run its start-of-turn effects
+void nextTurn(GameState& state);
+
+int countActive(const GameState& state);
+bool isGameOver(const GameState& state);
+
+// Seat of the last active player, or -1 while the game is running
+int winner(const GameState& state);
+
+} // namespace rules
+
+} // namespace coup
@@ -0,0 +1,91 @@
+//tomergal40@gmail.com
+#pragma once
+#include "Game.hpp"
+#include "GameState.hpp"
+#include "Move.hpp"
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace coup {
+
+// Turns a position into one that is consistent with what `viewer` knows,
+// filling in everything hidden from it with a plausible guess. Search calls
+// this from several threads at once, so implementations must not mutate
+// shared state in determinize().
+class Determinizer {
+public:
+    virtual ~Determinizer() = default;
+    virtual void determinize(GameState& state, int viewer, std::mt19937_64& rng) const = 0;
+};
+
+// Treats the position as fully visible (cheating bot / perfect information)
+class PerfectInformationDeterminizer : public Determinizer {
+public:
+    void determinize(GameState&, int, std::mt19937_64&) const override {}
+};
+
+// Opponents' coin counts are hidden, except for the last seat the viewer
+// spied on. Their sum still follows from the bank and the visible purses, so
+// it is kept and dealt out again one coin at a time to random hidden seats.
+class HiddenCoinsDeterminizer : public Determinizer {
+public:
+    void determinize(GameState& state, int viewer, std::mt19937_64& rng) const override;
+};
+
+// Stops a search at whichever limit is reached first; 0 disables a limit
+// (at least one must be set)
+struct SearchBudget {
+    std::uint64_t iterations = 10000;
+    double seconds = 0.0;
+};
+
+struct IsmctsConfig {
+    unsigned threads = 1;            // Independent trees merged at the root (0 = all cores)
+    SearchBudget budget;             // Per thread
+    double exploration = 0.7;        // UCB constant
+    int maxPlies = 400;              // Playouts longer than this score as a draw
+    std::uint64_t seed = 1;
+};
+
+// Root statistics of one candidate move, summed over all threads
+struct MoveStats {
+    Move move;
+    std::uint64_t visits = 0;
+    double reward = 0.0;             // Sum of the mover's rewards (1 per win)
+
+    double mean() const { return visits ? reward / static_cast<double>(visits) : 0.0; }
+};
+
+struct SearchResult {
+    Move best;
+    std::vector<MoveStats> moves;    // Root moves, most visited first
+    std::uint64_t playouts = 0;
+    double seconds = 0.0;
+
+    double playoutsPerSecond() const { return seconds > 0.0 ? static_cast<double>(playouts) / seconds : 0.0; }
+};
+
+// Single-observer Information Set Monte Carlo Tree Search. Every iteration
+// samples a determinization of the root, walks one shared tree of moves for
+// all players (UCB over the moves legal in that sample, weighted by how often
+// each was available), expands one move and finishes with a random playout.
+// Several threads each grow their own tree and their root visits are summed.
+class Ismcts {
+private:
+    IsmctsConfig _config;
+    std::shared_ptr<const Determinizer> _determinizer;
+
+public:
+    explicit Ismcts(IsmctsConfig config = IsmctsConfig(),
+                    std::shared_ptr<const Determinizer> determinizer = std::make_shared<HiddenCoinsDeterminizer>());
+
+    const IsmctsConfig& config() const { return _config; }
+
+    // Best move for `seat`, which must be the seat to play in `state`
+    SearchResult search(const GameState& state, int seat) const;
+    SearchResult search(const Game& game, int seat) const;
+};
+
+} // namespace coup
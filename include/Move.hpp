@@ -0,0 +1,83 @@
+//tomergal40@gmail.com
+#pragma once
+#include <array>
+#include <cstddef>
+
+namespace coup {
+
+// Every action a player can take, including the role-specific abilities
+enum class MoveType {
+    Gather,
+    Tax,
+    Bribe,
+    Arrest,
+    Sanction,
+    Coup,
+    Invest,             // Baron only
+    SpyOn,              // Spy only, does not end the turn
+    PrepareCoupDefense, // General only, does not end the turn
+    Undo                // Role specific block of another player's action
+};
+
+const int MOVE_TYPE_COUNT = 10;
+
+// A single move: the action and, for targeted actions, the target's seat index
+struct Move {
+    MoveType type = MoveType::Gather;
+    int target = -1;
+
+    bool operator==(const Move& other) const = default;
+};
+
+// Upper bound on the moves available to one seat: four untargeted moves plus
+// six targeted move types against up to six seats
+const std::size_t MAX_MOVES = 40;
+
+// Fixed-capacity move list that lives on the stack; filling it never allocates
+class MoveList {
+private:
+    std::array<Move, MAX_MOVES> _moves;
+    std::size_t _size = 0;
+
+public:
+    void push(const Move& move) { _moves[_size++] = move; }
+    void clear() { _size = 0; }
+    std::size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    const Move& operator[](std::size_t i) const { return _moves[i]; }
+    Move& operator[](std::size_t i) { return _moves[i]; }
+    const Move* begin() const { return _moves.data(); }
+    const Move* end() const { return _moves.data() + _size; }
+    Move* begin() { return _moves.data(); }
+    Move* end() { return _moves.data() + _size; }
+    bool contains(const Move& move) const {
+        for (const Move& m : *this)
+            if (m == move) return true;
+        return false;
+    }
+};
+
+// Human readable name of a move type (used in reports and logs)
+inline const char* toString(MoveType type) {
+    switch (type) {
+        case MoveType::Gather: return "gather";
+        case MoveType::Tax: return "tax";
+        case MoveType::Bribe: return "bribe";
+        case MoveType::Arrest: return "arrest";
+        case MoveType::Sanction: return "sanction";
+        case MoveType::Coup: return "coup";
+        case MoveType::Invest: return "invest";
+        case MoveType::SpyOn: return "spy_on";
+        case MoveType::PrepareCoupDefense: return "prepare_coup_defense";
+        case MoveType::Undo: return "undo";
+    }
+    return "unknown";
+}
+
+// True for moves that need a target seat
+inline bool isTargeted(MoveType type) {
+    return type == MoveType::Arrest || type == MoveType::Sanction || type == MoveType::Coup ||
+           type == MoveType::SpyOn || type == MoveType::PrepareCoupDefense || type == MoveType::Undo;
+}
+
+} // namespace coup
@@ -0,0 +1,69 @@
+//tomergal40@gmail.com
+#pragma once
+#include <atomic>
+
+namespace coup {
+
+// Link embedded in every element of an MpscQueue
+struct MpscNode {
+    std::atomic<MpscNode*> next{nullptr};
+};
+
+// Intrusive multi-producer single-consumer FIFO (Vyukov's queue). push() is
+// wait-free: one exchange on the head and one store, from any thread. pop()
+// must only be called by one consumer at a time. The queue never allocates;
+// callers own the nodes, and a popped node belongs to the consumer again.
+//
+// A producer is briefly between its exchange and its link store; pop() then
+// returns nullptr even though the queue is not empty, so consumers need a
+// way to be called again once the producer is done (GameHost re-arms), or
+// must tell the two apart with empty() and wait.
+class MpscQueue {
+private:
+    std::atomic<MpscNode*> _head;    // Last pushed node, written by producers
+    MpscNode* _tail;                 // Next node to pop, owned by the consumer
+    MpscNode _stub;
+
+public:
+    MpscQueue() : _head(&_stub), _tail(&_stub) {}
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(MpscNode* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        MpscNode* previous = _head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    // Oldest node, or nullptr if the queue is empty (or a push is half done)
+    MpscNode* pop() {
+        MpscNode* tail = _tail;
+        MpscNode* next = tail->next.load(std::memory_order_acquire);
+        if (tail == &_stub) {
+            if (!next) return nullptr;
+            _tail = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            _tail = next;
+            return tail;
+        }
+        if (tail != _head.load(std::memory_order_acquire)) return nullptr;
+        // `tail` is the last node: park the stub behind it so it can be taken
+        push(&_stub);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next) {
+            _tail = next;
+            return tail;
+        }
+        return nullptr;
+    }
+
+    // True once every push has been popped (consumer only)
+    bool empty() const {
+        return _tail == &_stub && _head.load(std::memory_order_acquire) == &_stub;
+    }
+};
+
+} // namespace coup
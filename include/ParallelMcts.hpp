@@ -0,0 +1,79 @@
+//tomergal40@gmail.com
+#pragma once
+#include "Game.hpp"
+#include "GameState.hpp"
+#include "Ismcts.hpp"
+#include "Move.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+
+namespace coup {
+
+struct ParallelMctsConfig {
+    unsigned threads = 0;            // Threads sharing the tree (0 = all cores)
+    SearchBudget budget;             // Shared by all threads
+    double exploration = 0.7;        // UCB constant
+    int virtualLoss = 1;             // Pending losses charged per thread walking through a node
+    int maxPlies = 400;              // Playouts longer than this score as a draw
+    std::size_t arenaNodes = 1 << 20; // Preallocated nodes; the tree stops growing when full
+    std::uint64_t seed = 1;
+};
+
+// Shared-tree (tree parallel) variant of the ISMCTS search in Ismcts.hpp.
+// All threads grow one tree whose nodes come from an arena allocated up
+// front, so a search never takes a lock or calls the allocator:
+//   - a node is claimed with a fetch_add on the arena cursor;
+//   - a child is published with a CAS on its parent's child list head, after
+//     checking that no other thread published the same move first;
+//   - visits, rewards (fixed point) and availability counts are atomics.
+// While a thread walks a path it charges each node a virtual loss, which
+// steers the other threads towards different branches until the playout
+// result is backed up.
+class TreeParallelMcts {
+private:
+    struct Node {
+        Move move;
+        std::int8_t mover = -1;
+        int parent = -1;
+        int sibling = -1;                         // Written before the node is published
+        std::atomic<int> firstChild{-1};
+        std::atomic<std::uint32_t> visits{0};
+        std::atomic<std::uint32_t> available{0};
+        std::atomic<std::int32_t> virtualLoss{0};
+        std::atomic<std::uint64_t> reward{0};     // Sum of the mover's rewards * REWARD_SCALE
+    };
+
+    ParallelMctsConfig _config;
+    std::shared_ptr<const Determinizer> _determinizer;
+    std::unique_ptr<Node[]> _nodes;
+    std::atomic<std::size_t> _used{0};
+
+    int allocate(const Move& move, int mover, int parent);
+    // Child of `node` for this move, creating it if needed; -1 if the arena is full
+    int childFor(int node, int mover, const Move& move, bool& created);
+    // One thread's share of a search; returns the playouts it completed
+    std::uint64_t runIterations(const GameState& root, int seat, std::atomic<std::uint64_t>& claimed,
+                                std::chrono::steady_clock::time_point start, std::mt19937_64& rng);
+
+public:
+    explicit TreeParallelMcts(ParallelMctsConfig config = ParallelMctsConfig(),
+                              std::shared_ptr<const Determinizer> determinizer = std::make_shared<HiddenCoinsDeterminizer>());
+
+    TreeParallelMcts(const TreeParallelMcts&) = delete;
+    TreeParallelMcts& operator=(const TreeParallelMcts&) = delete;
+
+    const ParallelMctsConfig& config() const { return _config; }
+    // Nodes used by the last search
+    std::size_t treeSize() const { return _used.load(std::memory_order_relaxed); }
+
+    // Best move for `seat`, which must be the seat to play. The arena is
+    // reused, so a searcher runs one search at a time.
+    SearchResult search(const GameState& state, int seat);
+    SearchResult search(const Game& game, int seat);
+};
+
+} // namespace coup
@@ -1,7 +1,8 @@
 //tomergal40@gmail.com
 #pragma once
+#include "RoleId.hpp"
+#include <cstdint>
 #include <string>
-#include <memory>
 
 namespace coup {
 // Forward declaration to prevent circular dependency
@@ -17,26 +18,30 @@ protected:
     bool _underSanction;
     Game* _game;
     Player* _lastArrested; // The last player arrested by this player
+    RoleId _roleId;
+    int _seat; // Stable player id: index in the game's player list, -1 until added to a game
     
-    // Helper method to create non-owning shared pointers
-    static std::shared_ptr<Player> createSafePtr(Player* ptr) {
-        return std::shared_ptr<Player>(ptr, [](Player*){/* empty deleter */});
-    }
+    // Used by the role classes to record their RoleId
+    Player(Game& game, const std::string& name, RoleId roleId);
     
 public:
     Player(Game& game, const std::string& name);
     virtual ~Player() = default;
     
-    // Role identification
+    // Role identification. roleId() is what the rules dispatch on; role()
+    // is the display name.
+    RoleId roleId() const { return _roleId; }
     virtual std::string role() const { return "Player"; }
     
     // getters
-    std::string getName() const;
+    const std::string& getName() const;
     int coins() const; // Changed from getCoins() to coins()
     bool isActive() const;
     bool canGather() const;
     bool canTax() const;
     bool isUnderSanction() const;
+    int seat() const;
+    std::uint8_t stateFlags() const; // SEAT_* bits as stored in GameState
     
     // Basic actions
     virtual void gather();
@@ -54,6 +59,10 @@ public:
     void setSanction(bool sanctioned);
     void addCoins(int amount);
     void removeCoins(int amount);
+    void setCoins(int amount);
+    Player* lastArrested() const;
+    void setLastArrested(Player* target);
+    void setSeat(int seat);
     
     // Reaction methods to other players' actions
     virtual void onSanctioned(Player& by);
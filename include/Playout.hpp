@@ -0,0 +1,32 @@
+//tomergal40@gmail.com
+#pragma once
+#include "GameState.hpp"
+#include "Move.hpp"
+#include <random>
+
+namespace coup {
+
+// Helpers shared by the searches that play games out on GameState
+
+// Same cap as the simulator: a turn made only of moves that do not end it
+// (bribe, spyOn, undo, ...) is passed after this many actions
+const int MAX_ACTIONS_PER_TURN = 8;
+
+// Play a legal move for the seat to play. The turn is passed if the move is
+// refused or the turn has seen MAX_ACTIONS_PER_TURN actions; `turnActions`
+// counts the actions of the current turn and is reset when it changes.
+void advance(GameState& state, const Move& move, int& turnActions);
+
+// Rewards of a finished (or abandoned) playout: 1 for the winner, and an
+// equal share for every surviving seat if the game is still running
+void scoreOutcome(const GameState& state, double rewards[STATE_MAX_SEATS]);
+
+// Uniformly random legal moves until the game ends or `maxPlies` moves have
+// been played (seats without a legal move pass); returns the plies played
+int randomPlayout(GameState& state, int maxPlies, int turnActions, std::mt19937_64& rng);
+
+inline int randomBelow(std::mt19937_64& rng, int bound) {
+    return static_cast<int>(rng() % static_cast<std::uint64_t>(bound));
+}
+
+} // namespace coup
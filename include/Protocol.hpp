@@ -0,0 +1,99 @@
+//tomergal40@gmail.com
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace coup {
+
+// Binary protocol of CoupServer. Every message is a frame: the body length
+// as a little endian uint16, then the body. A body starts with the message
+// type (uint8) and a request id (uint32) chosen by the client and echoed in
+// the reply, followed by the fields listed below. Integers are little
+// endian; strings are a uint8 length followed by the bytes.
+namespace protocol {
+
+const std::size_t HEADER_BYTES = 2;
+const std::size_t MAX_BODY_BYTES = 1024;
+
+enum class MessageType : std::uint8_t {
+    // Requests
+    CreateGame = 1,     // u8 count, count x u8 RoleId; no roles creates an empty game to join
+    AddPlayer = 2,      // u32 game, u8 RoleId, string name
+    StartGame = 3,      // u32 game
+    Action = 4,         // u32 game, u8 seat, u8 MoveType, i8 target (-1 for none)
+    GetState = 5,       // u32 game
+    CloseGame = 6,      // u32 game; later requests for it get UnknownGame
+
+    // Replies
+    GameCreated = 64,   // u32 game
+    PlayerAdded = 65,   // u8 seat
+    GameStarted = 66,
+    ActionResult = 67,  // u8 MoveStatus, u8 seat to play, u8 game over, i16 bank, i16 coins of the acting seat
+    State = 68,         // i16 bank, u8 seat to play, u8 started, u8 count, then count x SeatState fields:
+                        // i16 coins, u8 RoleId, u8 flags, i8 last arrested, i8 spy target, u16 pending
+    GameClosed = 69,
+    Error = 127         // u8 ErrorCode, string message
+};
+
+enum class ErrorCode : std::uint8_t {
+    Malformed = 1,      // The request could not be parsed
+    UnknownGame = 2,    // Never created, or closed
+    NotStarted = 3,     // Action before StartGame
+    Rejected = 4        // The game refused the request; the message says why
+};
+
+// Appends one frame to `out`: construct, write the fields, then finish()
+class FrameWriter {
+private:
+    std::string& _out;
+    std::size_t _start;
+
+public:
+    FrameWriter(std::string& out, MessageType type, std::uint32_t request);
+
+    FrameWriter& u8(std::uint8_t value);
+    FrameWriter& i8(std::int8_t value) { return u8(static_cast<std::uint8_t>(value)); }
+    FrameWriter& u16(std::uint16_t value);
+    FrameWriter& i16(std::int16_t value) { return u16(static_cast<std::uint16_t>(value)); }
+    FrameWriter& u32(std::uint32_t value);
+    FrameWriter& bytes(const void* data, std::size_t size);
+    FrameWriter& text(const std::string& value);    // Cut to 255 bytes
+
+    // Patch the length into the header; throws GameException if the body is too long
+    void finish();
+};
+
+// Reads the fields of one frame body. Reading past the end yields zeros and
+// clears ok(), so a handler can read every field and check once.
+class FrameReader {
+private:
+    const unsigned char* _data;
+    std::size_t _size;
+    std::size_t _pos = 0;
+    bool _ok = true;
+
+    bool need(std::size_t bytes);
+
+public:
+    FrameReader(const char* body, std::size_t size);
+
+    std::uint8_t u8();
+    std::int8_t i8() { return static_cast<std::int8_t>(u8()); }
+    std::uint16_t u16();
+    std::int16_t i16() { return static_cast<std::int16_t>(u16()); }
+    std::uint32_t u32();
+    bool bytes(void* out, std::size_t size);
+    std::string text();
+
+    bool ok() const { return _ok; }
+    bool atEnd() const { return _pos == _size; }
+};
+
+// Size of the first frame in `data` including its header, 0 while it is
+// still incomplete; throws GameException if the announced body is too long
+std::size_t frameLength(const char* data, std::size_t size);
+
+} // namespace protocol
+
+} // namespace coup
@@ -0,0 +1,40 @@
+//tomergal40@gmail.com
+#pragma once
+#include <array>
+#include <cstddef>
+
+namespace coup {
+
+// Fixed capacity FIFO buffer. Pushing into a full buffer overwrites the oldest
+// element, so memory use never grows past N elements.
+template <typename T, std::size_t N>
+class RingBuffer {
+private:
+    std::array<T, N> _items{};
+    std::size_t _head = 0;   // Index of the oldest element
+    std::size_t _size = 0;
+
+public:
+    static constexpr std::size_t capacity() { return N; }
+    std::size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    bool full() const { return _size == N; }
+
+    // Append an element, dropping the oldest one when the buffer is full
+    void push(const T& item) {
+        _items[(_head + _size) % N] = item;
+        if (_size < N) ++_size;
+        else _head = (_head + 1) % N;
+    }
+
+    // Element `i` counted from the oldest one
+    const T& operator[](std::size_t i) const { return _items[(_head + i) % N]; }
+    T& operator[](std::size_t i) { return _items[(_head + i) % N]; }
+
+    void clear() {
+        _head = 0;
+        _size = 0;
+    }
+};
+
+} // namespace coup
@@ -0,0 +1,43 @@
+//tomergal40@gmail.com
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace coup {
+
+// Compact role identifier. The six playable roles come first so they can be
+// used directly as array indices; Player is the plain base class.
+enum class RoleId : std::uint8_t {
+    Governor,
+    Spy,
+    Baron,
+    General,
+    Judge,
+    Merchant,
+    Player
+};
+
+const std::size_t PLAYABLE_ROLE_COUNT = 6;
+
+inline const char* toString(RoleId role) {
+    switch (role) {
+        case RoleId::Governor: return "Governor";
+        case RoleId::Spy: return "Spy";
+        case RoleId::Baron: return "Baron";
+        case RoleId::General: return "General";
+        case RoleId::Judge: return "Judge";
+        case RoleId::Merchant: return "Merchant";
+        case RoleId::Player: return "Player";
+    }
+    return "Player";
+}
+
+// Role id from a role() name; unknown names map to RoleId::Player
+inline RoleId roleIdFromName(const std::string& name) {
+    for (std::size_t i = 0; i < PLAYABLE_ROLE_COUNT; ++i) {
+        if (name == toString(static_cast<RoleId>(i))) return static_cast<RoleId>(i);
+    }
+    return RoleId::Player;
+}
+
+} // namespace coup
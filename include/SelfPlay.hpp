@@ -0,0 +1,115 @@
+//tomergal40@gmail.com
+#pragma once
+#include "GameState.hpp"
+#include "Move.hpp"
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace coup {
+
+// Fixed-width position features, seen from the seat to move: bank, player
+// count and actions already taken this turn, then six values per seat in
+// turn order starting with the mover (coins, role, flags, pending bits,
+// last arrested and spy target, both as seats relative to the mover).
+// Seats past the player count read as role -1 and zeros elsewhere.
+const int FEATURES_PER_SEAT = 6;
+const int FEATURE_COUNT = 3 + FEATURES_PER_SEAT * static_cast<int>(STATE_MAX_SEATS);
+
+void extractFeatures(const GameState& state, int seat, int turnActions, std::int16_t features[FEATURE_COUNT]);
+
+// Dense index of a move, used for the chosen move and the legal move mask:
+// type * (STATE_MAX_SEATS + 1) + target + 1, so untargeted moves use the
+// first slot of their type
+const int MOVE_INDEX_COUNT = MOVE_TYPE_COUNT * (static_cast<int>(STATE_MAX_SEATS) + 1);
+
+inline int moveIndex(const Move& move) {
+    return static_cast<int>(move.type) * (static_cast<int>(STATE_MAX_SEATS) + 1) + move.target + 1;
+}
+
+inline Move moveFromIndex(int index) {
+    const int slots = static_cast<int>(STATE_MAX_SEATS) + 1;
+    return Move{static_cast<MoveType>(index / slots), index % slots - 1};
+}
+
+// A block of decisions stored column by column: every field of record r is
+// at index r of its own vector, and feature f is the column features[f].
+// This is also the on-disk layout of a chunk, so a reader gets whole
+// columns with one read each.
+struct SelfPlayChunk {
+    std::vector<std::uint64_t> game;                           // Game number within the run
+    std::vector<std::uint16_t> ply;                            // Decision number within the game
+    std::vector<std::uint8_t> seat;                            // Seat that decided
+    std::array<std::vector<std::int16_t>, FEATURE_COUNT> features;
+    std::vector<std::uint64_t> legalLow;                       // Legal move mask, bits 0..63 of moveIndex
+    std::vector<std::uint64_t> legalHigh;                      // Bits 64.. of moveIndex
+    std::vector<std::uint8_t> move;                            // moveIndex of the chosen move
+    std::vector<std::int8_t> outcome;                          // 1 the seat won, -1 it lost, 0 draw
+
+    std::size_t size() const { return game.size(); }
+    void clear();
+    bool isLegal(std::size_t record, int index) const {
+        return index < 64 ? (legalLow[record] >> index) & 1 : (legalHigh[record] >> (index - 64)) & 1;
+    }
+};
+
+struct SelfPlayConfig {
+    std::string path = "selfplay.bin";        // Output file, replaced if it exists
+    int players = 2;                          // Seats per game (2..6)
+    std::vector<std::string> roles;           // Role per seat; empty means a random role per game
+    std::vector<std::string> agents;          // Agent name per seat; missing seats use "random"
+    int maxTurns = 500;                       // Games still running after this many turns are draws
+    std::uint64_t seed = 1;                   // Game g plays with stream (seed, g) on whichever thread
+    std::size_t chunkRecords = 1 << 16;       // Records a thread collects before handing a chunk over
+};
+
+struct SelfPlayResult {
+    std::uint64_t games = 0;
+    std::uint64_t draws = 0;
+    std::uint64_t records = 0;
+    std::uint64_t chunks = 0;
+    std::uint64_t bytes = 0;                  // File size, header included
+    double seconds = 0.0;
+
+    double recordsPerSecond() const { return seconds > 0.0 ? static_cast<double>(records) / seconds : 0.0; }
+};
+
+// Plays agent-vs-agent games on GameState and records every decision. Each
+// thread fills its own chunk and, once it holds chunkRecords records (and
+// the current game is over, so outcomes are known), serializes it and
+// queues it for a background writer thread. Simulation threads never touch
+// the file; the writer writes whole chunks sequentially.
+//
+// File layout (host byte order): the 8 byte magic "COUPSP01", then
+// FEATURE_COUNT and MOVE_INDEX_COUNT as uint32, then chunks. A chunk is its
+// record count as uint64 followed by the columns in SelfPlayChunk order.
+// Chunks from different threads may come in any order; game and ply say
+// where a record belongs.
+class SelfPlayGenerator {
+private:
+    SelfPlayConfig _config;
+
+public:
+    explicit SelfPlayGenerator(SelfPlayConfig config);
+
+    // Play `games` games on `threads` threads (0 = all cores) into the output file
+    SelfPlayResult run(std::uint64_t games, unsigned threads = 0) const;
+};
+
+// Reads a self-play file one chunk at a time
+class SelfPlayReader {
+private:
+    std::ifstream _file;
+    std::string _path;
+
+public:
+    // Throws GameException if the file cannot be opened or is not a self-play file
+    explicit SelfPlayReader(const std::string& path);
+
+    // Fill `chunk` with the next chunk; false at the end of the file
+    bool next(SelfPlayChunk& chunk);
+};
+
+} // namespace coup
@@ -0,0 +1,68 @@
+//tomergal40@gmail.com
+#pragma once
+#include "Agent.hpp"
+#include "Game.hpp"
+#include "Move.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace coup {
+
+// Create a player of the given role ("Governor", "Spy", "Baron", "General", "Judge", "Merchant")
+std::shared_ptr<Player> createPlayer(Game& game, const std::string& role, const std::string& name);
+
+// The six playable roles, in the order used for role statistics
+extern const std::array<const char*, 6> ROLE_NAMES;
+
+struct SimulationConfig {
+    int players = 2;                          // Seats per game (2..6)
+    std::vector<std::string> roles;           // Role per seat; empty means a random role per game
+    std::vector<AgentFactory> agents;         // Agent per seat; missing seats use "random"
+    int maxTurns = 500;                       // Games still running after this many turns are draws
+    std::uint64_t seed = 1;                   // Base seed; thread i uses stream (seed, i)
+    EventSink* events = nullptr;              // Event log of every game (shared by all threads); nullptr discards
+};
+
+// Aggregated outcome of a batch of games
+struct SimulationResult {
+    std::uint64_t games = 0;
+    std::uint64_t draws = 0;                  // Games stopped by the turn limit
+    std::uint64_t turns = 0;
+    std::uint64_t actions = 0;                // Accepted moves
+    std::uint64_t rejectedMoves = 0;          // Moves the rules refused
+    std::uint64_t forcedPasses = 0;           // Turns skipped because no legal move ended them
+    std::array<std::uint64_t, 6> winsBySeat{};
+    std::array<std::uint64_t, 6> winsByRole{}; // Indexed like ROLE_NAMES
+    double seconds = 0.0;                     // Wall clock time of the batch
+
+    double gamesPerSecond() const { return seconds > 0.0 ? static_cast<double>(games) / seconds : 0.0; }
+    SimulationResult& operator+=(const SimulationResult& other);
+};
+
+// Plays complete games between agents, by default without any event log. Moves
+// come from Game::legalMoves and are played with Game::tryApply, so the
+// simulation never goes through exception handling.
+class Simulator {
+private:
+    SimulationConfig _config;
+
+    // Play one game on the calling thread and accumulate it into `result`
+    void playGame(std::vector<std::unique_ptr<Agent>>& agents, std::mt19937_64& rng,
+                  SimulationResult& result) const;
+    std::vector<std::unique_ptr<Agent>> createAgents() const;
+
+public:
+    explicit Simulator(SimulationConfig config);
+
+    // Play a single game with the given RNG
+    SimulationResult runGame(std::mt19937_64& rng) const;
+
+    // Play `games` games split over `threads` threads (0 = all cores) and merge the results
+    SimulationResult run(std::uint64_t games, unsigned threads = 0) const;
+};
+
+} // namespace coup
@@ -7,6 +7,7 @@ namespace coup {
 class Spy : public Player {
 private:
     std::string lastTargetName;
+    int lastTargetSeat;
 
 public:
     Spy(Game& game, const std::string& name);
@@ -18,5 +19,10 @@ public:
     void spyOn(Player& target);
     void undo(Player& target) override;
     bool canUndoArrest() const override { return true; }
+    
+    // Last player spied on (empty name and seat -1 if none)
+    const std::string& lastTarget() const { return lastTargetName; }
+    int lastTargetSeatIndex() const { return lastTargetSeat; }
+    void setLastTarget(const Player* target);
 };
 } // namespace coup
\ No newline at end of file
@@ -0,0 +1,123 @@
+//tomergal40@gmail.com
+#pragma once
+#include "Game.hpp"
+#include "GameState.hpp"
+#include "Move.hpp"
+#include "RoleId.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace coup {
+
+// Game theoretic value of a duel position for the seat to move
+enum class TablebaseValue : std::uint8_t {
+    Unknown,    // Position is not covered by the table
+    Draw,       // Neither side can force a win (the game goes on forever)
+    Win,
+    Loss
+};
+
+struct TablebaseEntry {
+    TablebaseValue value = TablebaseValue::Unknown;
+    int plies = 0;              // Moves until the winning coup under best play (0 for draws)
+};
+
+// Per section statistics reported by the generator
+struct TablebaseSection {
+    RoleId mover;
+    RoleId other;
+    std::size_t positions = 0;
+    std::size_t wins = 0;
+    std::size_t losses = 0;
+    std::size_t draws = 0;
+};
+
+// Exact values of every position with two active players, one section per
+// ordered pairing of the six roles (role to move, other role). A position
+// is indexed relative to the seat to move by the few properties the rules
+// look at in a duel:
+//   - coins of both sides, clamped to 15: a mover with 7+ coins wins by
+//     coup, and an opponent with 12+ must coup next turn whatever the mover
+//     does first, so larger counts change nothing;
+//   - whether the opponent is sanctioned, and whether each side arrested
+//     the other last;
+//   - a Spy's spy target and arrest block;
+//   - only the pending actions the other role can undo (tax for a Governor,
+//     bribe for a Judge, coup for a General).
+// As in AlphaBeta, only the seat to move acts (no out-of-turn Spy arrests).
+// The bank is not indexed: the generator solves every position with
+// GENERATOR_BANK coins in it. Coins only leave the bank into the two
+// players' hands, and neither can hold more than 13 (9 before a move that
+// is not a forced coup, 3 from Tax or Invest, 1 from a Baron's compensation
+// or a Merchant's turn bonus), so over any line the bank falls by at most
+// 26. From MIN_BANK it therefore keeps the 3 coins the largest draw needs,
+// every move is allowed exactly as with GENERATOR_BANK, and the values hold
+// (29 would do; the rest is margin).
+//
+// Each entry is one byte: 0 is a draw, 1..127 a win in that many plies and
+// 128 + n a loss in n plies.
+namespace tablebase {
+
+const int MAX_COINS = 15;
+const int MIN_BANK = 36;
+const int GENERATOR_BANK = 64;
+const std::size_t SECTION_COUNT = PLAYABLE_ROLE_COUNT * PLAYABLE_ROLE_COUNT;
+
+// Every ordered role pairing, which is what generate() solves by default
+std::vector<std::pair<RoleId, RoleId>> allPairings();
+
+// Solve the given pairings by retrograde analysis and write the table to
+// `path`. A pairing is always solved together with its mirror, since every
+// turn switches between the two. Sections that were not requested are left
+// empty and probe as Unknown.
+std::vector<TablebaseSection> generate(const std::string& path,
+                                       const std::vector<std::pair<RoleId, RoleId>>& pairings = allPairings());
+
+} // namespace tablebase
+
+// Read-only view of a generated table. The file is memory mapped, so
+// opening it costs a few system calls and a probe is an index computation
+// and one byte read; pages are loaded by the OS on first use and shared
+// between processes.
+class Tablebase {
+private:
+    const std::uint8_t* _data = nullptr;
+    std::size_t _size = 0;
+    std::uint64_t _offsets[tablebase::SECTION_COUNT] = {};
+    std::uint32_t _lengths[tablebase::SECTION_COUNT] = {};
+
+    void release();
+    // Section holding the position and its key there, -1 if the table has
+    // no entry for it (the bank is checked by covers() only)
+    int locate(const GameState& state, std::uint32_t& key) const;
+    TablebaseEntry entry(int section, std::uint32_t key) const;
+
+public:
+    explicit Tablebase(const std::string& path);
+    ~Tablebase();
+
+    Tablebase(const Tablebase&) = delete;
+    Tablebase& operator=(const Tablebase&) = delete;
+    Tablebase(Tablebase&& other) noexcept;
+    Tablebase& operator=(Tablebase&& other) noexcept;
+
+    // Positions stored in all sections
+    std::size_t positions() const;
+    bool hasSection(RoleId mover, RoleId other) const;
+
+    // Whether the table has an exact value for this position
+    bool covers(const GameState& state) const;
+
+    // Value for the seat to move, Unknown when not covered
+    TablebaseEntry probe(const GameState& state) const;
+    TablebaseEntry probe(const Game& game) const;
+
+    // A move that keeps the best value: the fastest win, a drawing move, or
+    // the slowest loss. Returns false when the position is not covered.
+    bool bestMove(const GameState& state, Move& move) const;
+};
+
+} // namespace coup
@@ -0,0 +1,71 @@
+//tomergal40@gmail.com
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace coup {
+
+// Handle of a scheduled timer; 0 is never a valid handle
+using TimerId = std::uint64_t;
+
+// Hierarchical hashed timing wheel (Varghese and Lauck). Time is counted in
+// ticks. Four levels of 256 slots cover 2^32 ticks: a timer due within 256
+// ticks sits in the level 0 slot of its tick, later ones in the level whose
+// slot spans its deadline, and when level 0 wraps the next level's slot is
+// cascaded down. schedule() and cancel() are O(1) (timers are intrusive
+// list nodes in a pooled vector); advance() costs O(ticks passed + timers
+// fired + timers cascaded). Handles carry a generation, so cancelling a
+// timer that already fired or was cancelled is a harmless no-op.
+//
+// Like WorkStealingPool, expiry hands a 64-bit payload to one handler set
+// at construction. A wheel is not thread safe: one thread owns it.
+class TimerWheel {
+private:
+    static constexpr unsigned LEVELS = 4;
+    static constexpr unsigned SLOT_BITS = 8;
+    static constexpr unsigned SLOTS = 1u << SLOT_BITS;
+    static constexpr std::uint32_t NIL = UINT32_MAX;
+
+    struct Timer {
+        std::uint64_t deadline = 0;
+        std::uint64_t data = 0;
+        std::uint32_t prev = NIL;
+        std::uint32_t next = NIL;         // Also links the free list
+        std::uint32_t generation = 1;
+        std::uint16_t slot = 0;           // level * SLOTS + index, while live
+        bool live = false;
+    };
+
+    std::function<void(std::uint64_t data)> _expire;
+    std::vector<Timer> _timers;
+    std::uint32_t _free = NIL;
+    std::array<std::uint32_t, LEVELS * SLOTS> _slots;
+    std::uint64_t _now;
+    std::size_t _size = 0;
+
+    void link(std::uint32_t index);
+    void unlink(std::uint32_t index);
+    void release(std::uint32_t index);
+    void cascade(unsigned level);
+
+public:
+    explicit TimerWheel(std::function<void(std::uint64_t data)> expire, std::uint64_t now = 0);
+
+    // Fire `data` once the wheel reaches tick `deadline` (the next tick if
+    // that has passed)
+    TimerId schedule(std::uint64_t deadline, std::uint64_t data);
+    // Returns false if the timer already fired or was cancelled
+    bool cancel(TimerId id);
+    // Move time forward to tick `now`, firing every timer due by then in
+    // deadline order. The handler may schedule and cancel timers.
+    void advance(std::uint64_t now);
+
+    std::uint64_t now() const { return _now; }
+    std::size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+};
+
+} // namespace coup
@@ -0,0 +1,72 @@
+//tomergal40@gmail.com
+#pragma once
+#include "Agent.hpp"
+#include "RoleId.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace coup {
+
+struct TournamentConfig {
+    std::vector<std::string> agents;      // Built-in agent names (see makeAgentFactory), at least two
+    std::vector<RoleId> roles = {RoleId::Governor, RoleId::Spy, RoleId::Baron,
+                                 RoleId::General, RoleId::Judge, RoleId::Merchant};
+    std::uint64_t gamesPerMatch = 10;     // Games per agent pair, role assignment and seat order
+    int maxTurns = 500;                   // Games still running after this many turns are draws
+    unsigned threads = 0;                 // Worker threads (0 = all cores)
+    std::uint64_t seed = 1;               // Match m plays with stream (seed, m) on whichever thread
+};
+
+struct AgentStanding {
+    std::string name;
+    std::uint64_t games = 0;
+    std::uint64_t wins = 0;
+    std::uint64_t losses = 0;
+    std::uint64_t draws = 0;
+    double elo = 0.0;                     // Bradley-Terry rating on the Elo scale, mean 1500
+    double eloMargin = 0.0;               // Half width of the 95% confidence interval
+
+    double score() const { return games ? (static_cast<double>(wins) + 0.5 * static_cast<double>(draws)) / static_cast<double>(games) : 0.0; }
+};
+
+struct TournamentResult {
+    std::uint64_t games = 0;
+    std::uint64_t draws = 0;
+    std::size_t agentCount = 0;
+    std::vector<std::uint64_t> wins;      // wins[a * agentCount + b]: games agent a won against b
+    std::vector<std::uint64_t> drawn;     // drawn[a * agentCount + b], symmetric
+    std::vector<AgentStanding> standings; // In agent order
+    double seconds = 0.0;
+
+    double gamesPerSecond() const { return seconds > 0.0 ? static_cast<double>(games) / seconds : 0.0; }
+    std::uint64_t winsOf(std::size_t a, std::size_t b) const { return wins[a * agentCount + b]; }
+};
+
+// Round robin of two player games between agents over every role assignment
+// and both seat orders. A match (agent pair, roles, seat order) is the unit
+// of work: threads claim matches from an atomic counter, so each thread
+// keeps one Game per role assignment for its whole share and restores it to
+// the opening position between games instead of building players again.
+// Results are counted per thread and merged once all threads finish.
+class Tournament {
+private:
+    TournamentConfig _config;
+    std::vector<AgentFactory> _factories;
+
+public:
+    explicit Tournament(TournamentConfig config);
+
+    // Number of games run() plays
+    std::uint64_t totalGames() const;
+    TournamentResult run() const;
+
+    // Bradley-Terry maximum likelihood ratings of result.standings from the
+    // pairwise results (draws count half; every pair also gets one virtual
+    // draw so an agent that never scores still has a finite rating). The
+    // margin is 1.96 standard errors from the Fisher information.
+    static void rate(TournamentResult& result);
+};
+
+} // namespace coup
@@ -0,0 +1,61 @@
+//tomergal40@gmail.com
+#pragma once
+#include "Move.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace coup {
+
+// How a stored value relates to the true value of the position
+enum class Bound : std::uint8_t {
+    None,
+    Exact,
+    Lower,  // Value is at least this (search failed high)
+    Upper   // Value is at most this (search failed low)
+};
+
+// Result of a successful probe
+struct TTHit {
+    std::int32_t value;
+    std::int8_t depth;
+    Bound bound;
+    Move best;   // type Gather with target -1 if no move was stored
+};
+
+// Fixed-size transposition table keyed by Zobrist hash, shared by any number
+// of search threads without locks. Each entry stores its data word and the
+// key XORed with that data; a reader accepts an entry only if the two words
+// still XOR back to its key, so a torn write from a concurrent store is seen
+// as a miss instead of corrupt data.
+class TranspositionTable {
+private:
+    struct Entry {
+        std::atomic<std::uint64_t> check{0};  // key ^ data
+        std::atomic<std::uint64_t> data{0};
+    };
+
+    std::unique_ptr<Entry[]> _entries;
+    std::size_t _mask;
+
+    static std::uint64_t pack(std::int32_t value, int depth, Bound bound, const Move& best);
+
+public:
+    // Capacity is rounded down to a power of two entries (16 bytes each)
+    explicit TranspositionTable(std::size_t megabytes = 16);
+
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    std::size_t capacity() const { return _mask + 1; }
+
+    bool probe(std::uint64_t key, TTHit& hit) const;
+
+    // Keeps a deeper result for the same position; other positions are replaced
+    void store(std::uint64_t key, std::int32_t value, int depth, Bound bound, const Move& best = Move{});
+
+    void clear();
+};
+
+} // namespace coup
@@ -0,0 +1,151 @@
+//tomergal40@gmail.com
+#pragma once
+#include "GameHost.hpp"
+#include "TimerWheel.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace coup {
+
+// Result of a move played through a TurnFlow, reported on the game's shard
+using MoveCallback = std::function<void(MoveStatus status)>;
+
+// Coroutine owning one game's turn loop. It starts eagerly, runs until its
+// first co_await, and its frame is freed together with the FlowTask.
+class FlowTask {
+public:
+    struct promise_type {
+        FlowTask get_return_object() { return FlowTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { throw; }
+    };
+
+    FlowTask() = default;
+    explicit FlowTask(std::coroutine_handle<promise_type> handle) : _handle(handle) {}
+    FlowTask(FlowTask&& other) noexcept : _handle(other._handle) { other._handle = nullptr; }
+    FlowTask& operator=(FlowTask&& other) noexcept;
+    FlowTask(const FlowTask&) = delete;
+    FlowTask& operator=(const FlowTask&) = delete;
+    ~FlowTask();
+
+    bool done() const { return !_handle || _handle.done(); }
+
+private:
+    std::coroutine_handle<promise_type> _handle;
+};
+
+struct TurnFlowConfig {
+    // After a Tax, Bribe or Coup, hold the next turn until every seat able
+    // to block it has reacted, passed, or closeWindow() was called
+    bool reactionWindows = true;
+
+    // Clocks in milliseconds (0 = wait forever). A player whose turn runs
+    // out gets a default move: a coup if the player must coup, else gather
+    // (or the first legal move). A reaction window that runs out closes.
+    unsigned turnMillis = 0;
+    unsigned reactionMillis = 0;
+    unsigned tickMillis = 10;        // Clock resolution
+
+    // End a turn after this many accepted moves (0 = never). Spying and
+    // defending do not end a turn, so a bot table may want a cap like the
+    // simulator's MAX_ACTIONS_PER_TURN; the rules themselves have none.
+    unsigned maxActionsPerTurn = 0;
+
+    // Hooks run on the game's shard (they may call back into the TurnFlow)
+    std::function<void(GameId game, Game& state, int seat)> onAwaitMove;
+    std::function<void(GameId game, Game& state, std::uint32_t blockers)> onReactionWindow;  // Bit per seat
+    std::function<void(GameId game, Game& state)> onGameOver;
+    // No active seat has a legal move: the loop ends without a winner
+    std::function<void(GameId game, Game& state)> onStuck;
+};
+
+// Drives the turns of hosted games as coroutines. Each game's loop awaits
+// the current player's move, plays it, and for a blockable action awaits a
+// reaction window before the next turn. While a game waits it is only a
+// suspended frame, not a blocked thread, so one GameHost thread can drive
+// tens of thousands of games waiting on slow clients. Every entry point
+// posts to the game's shard, where the frame is resumed; frames and their
+// bookkeeping are therefore only touched by the thread running that shard.
+// The same goes for the clocks: each shard has a TimerWheel of its own, and
+// a ticker thread posts the wheel's advance to the shard every tick. A seat
+// without a legal move has its turn passed. Closing a game in the host
+// stops its loop as well.
+class TurnFlow {
+private:
+    struct FlowGame;
+    struct MoveAwaiter;
+    struct WindowAwaiter;
+
+    GameHost& _host;
+    TurnFlowConfig _config;
+    std::vector<std::vector<std::unique_ptr<FlowGame>>> _flows;  // Per shard, slot game / shards
+    std::atomic<std::uint64_t> _waiting{0};
+    std::atomic<std::uint64_t> _finished{0};
+    std::atomic<std::uint64_t> _stuck{0};
+    std::atomic<std::uint64_t> _timeouts{0};
+
+    std::vector<std::unique_ptr<TimerWheel>> _wheels;           // Per shard
+    std::chrono::steady_clock::time_point _epoch;
+    std::mutex _tickerMutex;
+    std::condition_variable _tickerWake;
+    bool _stopping = false;                                     // Guarded by _tickerMutex
+    std::thread _ticker;                                        // Only with a clock
+
+    std::unique_ptr<FlowGame>& slotOf(GameId game);
+    FlowGame* find(GameId game);
+    FlowTask run(FlowGame& flow);
+    void answer(FlowGame& flow, int seat);    // A blocker reacted or passed
+    void resume(FlowGame& flow);
+    void discard(GameId game);                // Free the frame, on the game's shard
+    std::uint64_t currentTick() const;
+    void arm(FlowGame& flow, unsigned millis, bool window);
+    void disarm(FlowGame& flow);
+    void expire(std::uint64_t data);
+    void tick();
+
+public:
+    explicit TurnFlow(GameHost& host, TurnFlowConfig config = TurnFlowConfig());
+    // Stops the clocks, waits for the host to drain, then frees every frame
+    ~TurnFlow();
+    TurnFlow(const TurnFlow&) = delete;
+    TurnFlow& operator=(const TurnFlow&) = delete;
+
+    // Start driving a started game of the host (no-op if already driven)
+    void start(GameId game);
+    // Offer the move the game waits for. Anything else is refused with
+    // NotYourTurn (wrong seat, or a reaction window is open), or with
+    // IllegalMove if the game is not driven, is over, or was closed.
+    void play(GameId game, int seat, const Move& move, MoveCallback done = nullptr);
+    // Play a move the rules allow out of turn: an Undo or a spy's peek,
+    // through the host's reaction queue, or a Spy's arrest of a Merchant.
+    // It counts as the seat's answer to an open reaction window. Any other
+    // move is refused with NotYourTurn without touching the game; turn
+    // moves go through play().
+    void react(GameId game, int seat, const Move& move, MoveCallback done = nullptr);
+    // A blocker declines to block
+    void pass(GameId game, int seat);
+    // End the open reaction window now (e.g. on a deadline)
+    void closeWindow(GameId game);
+    // Free the game's frame and keep the game (closing it does this too)
+    void stop(GameId game);
+
+    // Games suspended waiting for a move or for blockers
+    std::uint64_t waitingGames() const { return _waiting.load(std::memory_order_relaxed); }
+    std::uint64_t finishedGames() const { return _finished.load(std::memory_order_relaxed); }
+    // Loops ended because nobody could move (not counted as finished)
+    std::uint64_t stuckGames() const { return _stuck.load(std::memory_order_relaxed); }
+    // Default moves played and reaction windows closed by the clocks
+    std::uint64_t timeouts() const { return _timeouts.load(std::memory_order_relaxed); }
+};
+
+} // namespace coup
@@ -0,0 +1,55 @@
+//tomergal40@gmail.com
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace coup {
+
+// Fixed set of threads running integer jobs. Every worker has its own deque:
+// jobs pushed from a worker go to the back of its own deque and are taken
+// back from there (most recent first, while its data is still in cache);
+// jobs pushed from outside are dealt round robin. A worker whose deque is
+// empty steals the oldest job of another worker before going to sleep.
+// Jobs are plain numbers handed to one run function, so queueing a job
+// never allocates a closure.
+class WorkStealingPool {
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::uint32_t> jobs;
+    };
+
+    std::function<void(std::uint32_t)> _run;
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::vector<std::thread> _threads;
+    std::mutex _idleMutex;
+    std::condition_variable _idle;
+    std::atomic<std::uint64_t> _queued{0};
+    std::atomic<std::uint64_t> _steals{0};
+    std::atomic<unsigned> _nextWorker{0};
+    bool _stopping = false;
+
+    bool take(unsigned self, std::uint32_t& job);
+    void workerLoop(unsigned self);
+
+public:
+    // `threads` = 0 uses all cores
+    WorkStealingPool(unsigned threads, std::function<void(std::uint32_t)> run);
+    ~WorkStealingPool();
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void push(std::uint32_t job);
+
+    unsigned threads() const { return static_cast<unsigned>(_threads.size()); }
+    std::uint64_t steals() const { return _steals.load(std::memory_order_relaxed); }
+};
+
+} // namespace coup
@@ -0,0 +1,95 @@
+//tomergal40@gmail.com
+#pragma once
+#include "ActionType.hpp"
+#include "GameState.hpp"
+#include "RoleId.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace coup {
+
+// Zobrist hashing of game positions. Every hashed property (coins, role and
+// flags of each seat, last arrested seat, spy target, pending actions, turn
+// and bank) has a random 64 bit key per value, and the hash of a position is
+// the XOR of the keys of its current values. Changing one property therefore
+// costs two XORs: remove the old key, add the new one.
+namespace zobrist {
+
+const std::size_t COIN_KEYS = 64;   // Coins are hashed modulo 64
+const std::size_t BANK_KEYS = 256;  // Bank is hashed modulo 256
+const std::size_t FLAG_KEYS = 16;   // All combinations of the four SEAT_* flags
+const std::size_t SEAT_KEYS = STATE_MAX_SEATS + 1; // Seat indices plus "none"
+const std::size_t ROLE_KEYS = 7;
+
+struct Keys {
+    std::uint64_t coins[STATE_MAX_SEATS][COIN_KEYS];
+    std::uint64_t role[STATE_MAX_SEATS][ROLE_KEYS];
+    std::uint64_t flags[STATE_MAX_SEATS][FLAG_KEYS];
+    std::uint64_t lastArrested[STATE_MAX_SEATS][SEAT_KEYS];
+    std::uint64_t spyTarget[STATE_MAX_SEATS][SEAT_KEYS];
+    std::uint64_t pending[STATE_MAX_SEATS][ACTION_TYPE_COUNT];
+    std::uint64_t turn[STATE_MAX_SEATS];
+    std::uint64_t bank[BANK_KEYS];
+};
+
+// splitmix64 sequence, so the keys are identical across builds and runs
+constexpr Keys makeKeys() {
+    Keys keys{};
+    std::uint64_t x = 0x9E3779B97F4A7C15ull;
+    auto next = [&x]() {
+        x += 0x9E3779B97F4A7C15ull;
+        std::uint64_t z = x;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    };
+    for (std::size_t s = 0; s < STATE_MAX_SEATS; ++s) {
+        for (auto& key : keys.coins[s]) key = next();
+        for (auto& key : keys.role[s]) key = next();
+        for (auto& key : keys.flags[s]) key = next();
+        for (auto& key : keys.lastArrested[s]) key = next();
+        for (auto& key : keys.spyTarget[s]) key = next();
+        for (auto& key : keys.pending[s]) key = next();
+        keys.turn[s] = next();
+    }
+    for (auto& key : keys.bank) key = next();
+    return keys;
+}
+
+inline constexpr Keys KEYS = makeKeys();
+
+inline std::uint64_t coins(int seat, int value) {
+    return KEYS.coins[seat][static_cast<unsigned>(value) % COIN_KEYS];
+}
+inline std::uint64_t role(int seat, RoleId value) {
+    return KEYS.role[seat][static_cast<std::size_t>(value)];
+}
+inline std::uint64_t flags(int seat, std::uint8_t value) {
+    return KEYS.flags[seat][value % FLAG_KEYS];
+}
+// `target` is a seat index or -1 for none
+inline std::uint64_t lastArrested(int seat, int target) {
+    return KEYS.lastArrested[seat][target + 1];
+}
+inline std::uint64_t spyTarget(int seat, int target) {
+    return KEYS.spyTarget[seat][target + 1];
+}
+inline std::uint64_t pending(int seat, ActionType type) {
+    return KEYS.pending[seat][static_cast<std::size_t>(type)];
+}
+inline std::uint64_t turn(int seat) {
+    return KEYS.turn[seat];
+}
+inline std::uint64_t bank(int value) {
+    return KEYS.bank[static_cast<unsigned>(value) % BANK_KEYS];
+}
+
+// Combined key of everything stored for one seat
+std::uint64_t seat(int index, const SeatState& state);
+
+// Full hash of a position; incremental updates must always agree with it
+std::uint64_t hash(const GameState& state);
+
+} // namespace zobrist
+
+} // namespace coup
@@ -0,0 +1,181 @@
+//tomergal40@gmail.com
+#include "../include/Agent.hpp"
+#include "../include/Exceptions.hpp"
+#include "../include/Playout.hpp"
+
+namespace coup {
+
+namespace {
+
+// Coins a move brings in right away (0 for moves that are not income)
+int income(const GameView& view, const Move& move) {
+    switch (move.type) {
+        case MoveType::Gather: return 1;
+        case MoveType::Tax: return view.self().role == RoleId::Governor ? 3 : 2;
+        case MoveType::Invest: return 3;
+        default: return 0;
+    }
+}
+
+// Legal income move with the largest gain
+bool bestIncome(const GameView& view, Move& best) {
+    int bestGain = 0;
+    for (const Move& move : view.legal) {
+        int gain = income(view, move);
+        if (gain > bestGain) {
+            bestGain = gain;
+            best = move;
+        }
+    }
+    return bestGain > 0;
+}
+
+// Legal move of the given type whose target scores highest (ties go to the
+// lower seat); targets scoring below 0 are skipped
+template <typename Score>
+bool bestTargeted(const GameView& view, MoveType type, Score score, Move& best) {
+    int bestScore = -1;
+    for (const Move& move : view.legal) {
+        if (move.type != type || move.target < 0) continue;
+        int value = score(view.state.seat(move.target));
+        if (value > bestScore) {
+            bestScore = value;
+            best = move;
+        }
+    }
+    return bestScore >= 0;
+}
+
+int byCoins(const SeatState& target) { return target.coins; }
+
+// Arrests that actually move a coin to the arrester
+int arrestGain(const SeatState& target) {
+    if (target.role == RoleId::Merchant || target.coins < 1) return -1;
+    return target.coins;
+}
+
+// Richest active opponent, -1 if there is none
+int richestOpponent(const GameView& view) {
+    int richest = -1;
+    for (int i = 0; i < view.state.playerCount; ++i) {
+        const SeatState& seat = view.state.seat(i);
+        if (i == view.seat || !seat.active()) continue;
+        if (richest < 0 || seat.coins > view.state.seat(richest).coins) richest = i;
+    }
+    return richest;
+}
+
+// Any legal move that does not spend coins, falling back to the first one
+Move cheapest(const GameView& view) {
+    for (const Move& move : view.legal) {
+        if (move.type != MoveType::Bribe && move.type != MoveType::Sanction &&
+            move.type != MoveType::PrepareCoupDefense)
+            return move;
+    }
+    return view.legal[0];
+}
+
+} // namespace
+
+Move RandomAgent::decide(const GameView& view) {
+    return view.legal[static_cast<size_t>(randomBelow(view.rng, static_cast<int>(view.legal.size())))];
+}
+
+Move GreedyCoinsAgent::decide(const GameView& view) {
+    // Preference order; the first move type with a legal option wins
+    const MoveType preferred[] = {MoveType::Coup, MoveType::Invest, MoveType::Tax,
+                                  MoveType::Gather, MoveType::Arrest};
+    for (MoveType type : preferred) {
+        Move options[MAX_MOVES];
+        int count = 0;
+        for (const Move& move : view.legal)
+            if (move.type == type && (move.target < 0 || view.state.seat(move.target).active()))
+                options[count++] = move;
+        if (count > 0) return options[randomBelow(view.rng, count)];
+    }
+    return view.legal[0];
+}
+
+Move CoupFirstAgent::decide(const GameView& view) {
+    Move move;
+    if (bestTargeted(view, MoveType::Coup, byCoins, move)) return move;
+    if (bestIncome(view, move)) return move;
+    if (bestTargeted(view, MoveType::Arrest, arrestGain, move)) return move;
+    return cheapest(view);
+}
+
+Move RoleAwareAgent::decide(const GameView& view) {
+    Move move;
+    if (bestTargeted(view, MoveType::Coup, byCoins, move)) return move;
+
+    // Free moves that keep the turn: each can only be played once per target
+    // and turn, so they never loop
+    switch (view.self().role) {
+        case RoleId::Governor:
+        case RoleId::Judge:
+            if (bestTargeted(view, MoveType::Undo, byCoins, move)) return move;
+            break;
+        case RoleId::Spy:
+            if (bestTargeted(view, MoveType::SpyOn, byCoins, move)) return move;
+            break;
+        default:
+            break;
+    }
+
+    // An opponent who can coup next turn is pushed back below 7 coins: one
+    // at exactly 7 loses a coin, a Merchant at 7 or 8 pays 2 to the bank
+    // (a General gets the coin straight back)
+    int richest = richestOpponent(view);
+    if (richest >= 0) {
+        const SeatState& threat = view.state.seat(richest);
+        Move arrest{MoveType::Arrest, richest};
+        bool dropsBelowCoup = threat.role == RoleId::Merchant ? threat.coins >= 7 && threat.coins <= 8
+                                                              : threat.coins == 7 && threat.role != RoleId::General;
+        if (dropsBelowCoup && view.legal.contains(arrest)) return arrest;
+    }
+
+    if (bestIncome(view, move)) return move;
+    if (bestTargeted(view, MoveType::Arrest, arrestGain, move)) return move;
+    return cheapest(view);
+}
+
+LinearAgent::LinearAgent(const EvalWeights& weights) : _weights(weights), _batch(MAX_MOVES) {}
+
+Move LinearAgent::decide(const GameView& view) {
+    _batch.clear();
+    for (const Move& move : view.legal) {
+        GameState next = view.state;
+        rules::apply(next, view.seat, move);
+        _batch.add(next, view.seat);
+    }
+    float scores[MAX_MOVES];
+    evaluate(_weights, _batch, scores);
+    std::size_t best = 0;
+    for (std::size_t i = 1; i < view.legal.size(); ++i)
+        if (scores[i] > scores[best]) best = i;
+    return view.legal[best];
+}
+
+IsmctsAgent::IsmctsAgent(std::uint64_t iterations) {
+    _config.threads = 1; // Simulations already run one game per core
+    _config.budget.iterations = iterations;
+}
+
+Move IsmctsAgent::decide(const GameView& view) {
+    IsmctsConfig config = _config;
+    config.seed = view.rng();
+    Move best = Ismcts(config).search(view.state, view.seat).best;
+    return view.legal.contains(best) ? best : view.legal[0];
+}
+
+AgentFactory makeAgentFactory(const std::string& name) {
+    if (name == "random") return [] { return std::make_unique<RandomAgent>(); };
+    if (name == "greedy") return [] { return std::make_unique<GreedyCoinsAgent>(); };
+    if (name == "coup-first") return [] { return std::make_unique<CoupFirstAgent>(); };
+    if (name == "role-aware") return [] { return std::make_unique<RoleAwareAgent>(); };
+    if (name == "linear") return [] { return std::make_unique<LinearAgent>(); };
+    if (name == "ismcts") return [] { return std::make_unique<IsmctsAgent>(); };
+    throw GameException("Unknown agent: " + name);
+}
+
+} // namespace coup
@@ -0,0 +1,261 @@
+//tomergal40@gmail.com
+#include "../include/AlphaBeta.hpp"
+#include "../include/Exceptions.hpp"
+#include "../include/Zobrist.hpp"
+#include <algorithm>
+
+namespace coup {
+
+namespace {
+
+const int INFINITE_SCORE = AlphaBeta::MATE + 1;
+
+// Static move ordering, indexed by MoveType: decisive and blocking moves
+// first, moves that keep the turn last
+const int MOVE_PRIORITY[MOVE_TYPE_COUNT] = {
+    4,  // Gather
+    8,  // Tax
+    2,  // Bribe
+    6,  // Arrest
+    5,  // Sanction
+    10, // Coup
+    8,  // Invest
+    1,  // SpyOn
+    3,  // PrepareCoupDefense
+    9   // Undo
+};
+
+// Mate scores are stored relative to the node, not the root
+int toTable(int value, int ply) {
+    if (value >= AlphaBeta::MATE_BOUND) return value + ply;
+    if (value <= -AlphaBeta::MATE_BOUND) return value - ply;
+    return value;
+}
+
+int fromTable(int value, int ply) {
+    if (value >= AlphaBeta::MATE_BOUND) return value - ply;
+    if (value <= -AlphaBeta::MATE_BOUND) return value + ply;
+    return value;
+}
+
+} // namespace
+
+bool AlphaBetaResult::provenWin() const { return value >= AlphaBeta::MATE_BOUND; }
+bool AlphaBetaResult::provenLoss() const { return value <= -AlphaBeta::MATE_BOUND; }
+
+AlphaBeta::AlphaBeta(AlphaBetaConfig config) : _config(config), _table(config.ttMegabytes), _state{} {
+    if (_config.maxDepth <= 0) throw GameException("Search depth must be positive!");
+}
+
+void AlphaBeta::clear() { _table.clear(); }
+
+void AlphaBeta::load(const GameState& state) {
+    if (rules::countActive(state) != 2) throw GameException("Alpha-beta needs exactly two active players!");
+    _state = state;
+    _hash = zobrist::hash(state);
+    int found = 0;
+    for (int i = 0; i < state.playerCount; ++i)
+        if (state.seat(i).active()) _active[found++] = i;
+    _nodes = 0;
+    _aborted = false;
+}
+
+void AlphaBeta::save(UndoRecord& undo, int target) const {
+    undo.hash = _hash;
+    undo.bank = _state.bank;
+    undo.currentTurn = _state.currentTurn;
+    undo.count = 0;
+    for (int seat : _active) {
+        undo.index[undo.count] = static_cast<std::int8_t>(seat);
+        undo.seats[undo.count++] = _state.seat(seat);
+    }
+    if (target >= 0 && target != _active[0] && target != _active[1]) {
+        undo.index[undo.count] = static_cast<std::int8_t>(target);
+        undo.seats[undo.count++] = _state.seat(target);
+    }
+}
+
+void AlphaBeta::rehash(const UndoRecord& undo) {
+    std::uint64_t h = _hash ^ zobrist::bank(undo.bank) ^ zobrist::bank(_state.bank) ^
+                      zobrist::turn(undo.currentTurn) ^ zobrist::turn(_state.currentTurn);
+    for (int i = 0; i < undo.count; ++i) {
+        int seat = undo.index[i];
+        h ^= zobrist::seat(seat, undo.seats[i]) ^ zobrist::seat(seat, _state.seat(seat));
+    }
+    _hash = h;
+}
+
+void AlphaBeta::make(const Move& move, UndoRecord& undo) {
+    save(undo, move.target);
+    rules::apply(_state, _state.currentTurn, move);
+    rehash(undo);
+    ++_nodes;
+}
+
+void AlphaBeta::makePass(UndoRecord& undo) {
+    save(undo, -1);
+    rules::nextTurn(_state);
+    rehash(undo);
+    ++_nodes;
+}
+
+void AlphaBeta::unmake(const UndoRecord& undo) {
+    _state.bank = undo.bank;
+    _state.currentTurn = undo.currentTurn;
+    for (int i = 0; i < undo.count; ++i) _state.seat(undo.index[i]) = undo.seats[i];
+    _hash = undo.hash;
+}
+
+int AlphaBeta::evaluate(int ply) const {
+    int side = _state.currentTurn;
+    int winner = rules::winner(_state);
+    if (winner >= 0) return winner == side ? MATE - ply : -(MATE - ply);
+
+    int other = side == _active[0] ? _active[1] : _active[0];
+    if (side != _active[0] && side != _active[1]) return 0; // A blocked coup revived a third seat
+    const SeatState& self = _state.seat(side);
+    const SeatState& opponent = _state.seat(other);
+    int score = 100 * (self.coins - opponent.coins);
+    if (self.coins >= 7) score += 500;     // Can coup right now
+    if (opponent.coins >= 7) score -= 300; // Threatens to coup next turn
+    return score;
+}
+
+void AlphaBeta::orderMoves(MoveList& moves, const Move& ttMove) const {
+    auto priority = [&ttMove](const Move& move) {
+        return move == ttMove ? 100 : MOVE_PRIORITY[static_cast<int>(move.type)];
+    };
+    std::stable_sort(moves.begin(), moves.end(),
+                     [&](const Move& a, const Move& b) { return priority(a) > priority(b); });
+}
+
+bool AlphaBeta::outOfTime() {
+    if (_config.seconds > 0.0 && std::chrono::steady_clock::now() >= _deadline) _aborted = true;
+    return _aborted;
+}
+
+int AlphaBeta::negamax(int depth, int ply, int alpha, int beta) {
+    if (rules::isGameOver(_state) || rules::countActive(_state) != 2 || depth <= 0) return evaluate(ply);
+    if (_nodes % 1024 == 0 && outOfTime()) return 0;
+
+    int originalAlpha = alpha;
+    Move ttMove{MoveType::Gather, -2}; // Matches no real move
+    TTHit hit;
+    if (_table.probe(_hash, hit)) {
+        if (hit.bound != Bound::None) ttMove = hit.best;
+        if (hit.depth >= depth) {
+            int value = fromTable(hit.value, ply);
+            if (hit.bound == Bound::Exact) return value;
+            if (hit.bound == Bound::Lower && value >= beta) return value;
+            if (hit.bound == Bound::Upper && value <= alpha) return value;
+        }
+    }
+
+    int mover = _state.currentTurn;
+    MoveList moves;
+    rules::legalMoves(_state, mover, moves);
+    UndoRecord undo;
+    if (moves.empty()) {
+        makePass(undo);
+        int value = -negamax(depth - 1, ply + 1, -beta, -alpha);
+        unmake(undo);
+        return value;
+    }
+    orderMoves(moves, ttMove);
+
+    int best = -INFINITE_SCORE;
+    Move bestMove = moves[0];
+    for (const Move& move : moves) {
+        make(move, undo);
+        int value = _state.currentTurn == mover ? negamax(depth - 1, ply + 1, alpha, beta)
+                                                : -negamax(depth - 1, ply + 1, -beta, -alpha);
+        unmake(undo);
+        if (_aborted) return 0;
+        if (value > best) {
+            best = value;
+            bestMove = move;
+        }
+        if (value > alpha) alpha = value;
+        if (alpha >= beta) break;
+    }
+
+    Bound bound = best <= originalAlpha ? Bound::Upper : best >= beta ? Bound::Lower : Bound::Exact;
+    _table.store(_hash, toTable(best, ply), depth, bound, bestMove);
+    return best;
+}
+
+AlphaBetaResult AlphaBeta::search(const Game& game, int seat) {
+    return search(game.snapshot(), seat);
+}
+
+AlphaBetaResult AlphaBeta::search(const GameState& state, int seat) {
+    if (rules::isGameOver(state)) throw GameOverException();
+    if (seat != state.currentTurn) throw NotYourTurnException();
+    load(state);
+    MoveList moves;
+    rules::legalMoves(_state, seat, moves);
+    if (moves.empty()) throw IllegalMoveException("No legal move to search!");
+
+    auto start = std::chrono::steady_clock::now();
+    _deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                            std::chrono::duration<double>(_config.seconds));
+    AlphaBetaResult result;
+    result.best = moves[0];
+    Move previousBest = moves[0];
+
+    for (int depth = 1; depth <= _config.maxDepth; ++depth) {
+        orderMoves(moves, previousBest);
+        int alpha = -INFINITE_SCORE;
+        Move best = moves[0];
+        UndoRecord undo;
+        for (const Move& move : moves) {
+            make(move, undo);
+            int value = _state.currentTurn == seat ? negamax(depth - 1, 1, alpha, INFINITE_SCORE)
+                                                   : -negamax(depth - 1, 1, -INFINITE_SCORE, -alpha);
+            unmake(undo);
+            if (_aborted) break;
+            if (value > alpha) {
+                alpha = value;
+                best = move;
+            }
+        }
+        if (_aborted) break; // Keep the last completed iteration
+
+        result.best = previousBest = best;
+        result.value = alpha;
+        result.depth = depth;
+        _table.store(_hash, toTable(alpha, 0), depth, Bound::Exact, best);
+        if (result.provenWin() || result.provenLoss()) break;
+    }
+
+    result.nodes = _nodes;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+std::uint64_t AlphaBeta::perft(const GameState& state, int depth) {
+    load(state);
+    return perftFrom(depth);
+}
+
+std::uint64_t AlphaBeta::perftFrom(int depth) {
+    if (depth == 0 || rules::isGameOver(_state)) return 1;
+    MoveList moves;
+    rules::legalMoves(_state, _state.currentTurn, moves);
+    UndoRecord undo;
+    if (moves.empty()) {
+        makePass(undo);
+        std::uint64_t count = perftFrom(depth - 1);
+        unmake(undo);
+        return count;
+    }
+    std::uint64_t count = 0;
+    for (const Move& move : moves) {
+        make(move, undo);
+        count += perftFrom(depth - 1);
+        unmake(undo);
+    }
+    return count;
+}
+
+} // namespace coup
@@ -1,17 +1,16 @@
 #include "../include/Baron.hpp"
 #include "../include/Game.hpp"
 #include "../include/Exceptions.hpp"
-#include <iostream>
 //tomergal40@gmail.com
 
 namespace coup {
 
 Baron::Baron(Game& game, const std::string& name)
-    : Player(game, name) {}
+    : Player(game, name, RoleId::Baron) {}
 
 void Baron::invest() {
     // Check if it's the Baron's turn
-    if (!_game->isPlayerTurn(_name)) {
+    if (!_game->isPlayerTurn(_seat)) {
         throw NotYourTurnException();
     }
     
@@ -26,20 +25,20 @@ void Baron::invest() {
     }
     
     // Pay 3 coins for the investment
-    _coins -= 3;
+    removeCoins(3);
     _game->addToBank(3);
     
     // Get 6 coins in return (profit of 3 coins)
     _game->removeFromBank(6);
-    _coins += 6;
+    addCoins(6);
     
     // Add a pending action to track this investment
-    _game->addPendingAction(_name, "invest", createSafePtr(this), nullptr);
+    _game->addPendingAction(_seat, ActionType::Invest, _seat);
     
     // End the Baron's turn
     _game->nextTurn();
     
-    std::cout << "Baron " << _name << " invested 3 coins and received 6 in return!" << std::endl;
+    _game->emit(EventType::Invested, _seat);
 }
 
 void Baron::onSanctioned(Player& by) {
@@ -47,13 +46,12 @@ void Baron::onSanctioned(Player& by) {
     Player::onSanctioned(by);
     
     // Baron's special ability: get 1 coin compensation when sanctioned
-    _coins += 1;
     _game->removeFromBank(1);
-    _game->addPendingAction(_name, "compensation", createSafePtr(this), nullptr);
+    addCoins(1);
+    _game->addPendingAction(_seat, ActionType::Compensation, _seat);
     
     
-    std::cout << "Baron " << _name << " received 1 coin compensation after being sanctioned by "
-              << by.getName() << "!" << std::endl;
+    _game->emit(EventType::SanctionCompensation, _seat, by.seat());
 }
 
 } // namespace coup
\ No newline at end of file
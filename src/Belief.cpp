@@ -0,0 +1,142 @@
+//tomergal40@gmail.com
+#include "../include/Belief.hpp"
+#include "../include/Exceptions.hpp"
+#include <algorithm>
+
+namespace coup {
+
+bool samePublicView(const GameState& a, const GameState& b, int viewer) {
+    if (a.bank != b.bank || a.playerCount != b.playerCount || a.currentTurn != b.currentTurn || a.started != b.started)
+        return false;
+    int spied = a.seat(viewer).spyTarget;
+    for (int i = 0; i < a.playerCount; ++i) {
+        const SeatState& x = a.seat(i);
+        const SeatState& y = b.seat(i);
+        if (x.role != y.role || x.flags != y.flags || x.lastArrested != y.lastArrested ||
+            x.spyTarget != y.spyTarget || x.pending != y.pending)
+            return false;
+        if ((i == viewer || i == spied) && x.coins != y.coins) return false;
+    }
+    return true;
+}
+
+BeliefTracker::BeliefTracker(const GameState& state, int viewer, BeliefConfig config)
+    : _config(config), _viewer(viewer), _rng(config.seed) {
+    if (_config.particles == 0) throw GameException("Belief tracking needs at least one particle!");
+    if (_config.resampleThreshold < 0.0 || _config.resampleThreshold > 1.0)
+        throw GameException("Resample threshold must be between 0 and 1!");
+    if (viewer < 0 || viewer >= state.playerCount) throw GameException("Viewer is not a seat of this game!");
+    _particles.resize(_config.particles);
+    _scratch.resize(_config.particles);
+    _weights.resize(_config.particles);
+    reset(state);
+}
+
+void BeliefTracker::reset(const GameState& state) {
+    HiddenCoinsDeterminizer dealer;
+    for (GameState& particle : _particles) {
+        particle = state;
+        dealer.determinize(particle, _viewer, _rng);
+    }
+    std::fill(_weights.begin(), _weights.end(), 1.0 / static_cast<double>(_weights.size()));
+}
+
+void BeliefTracker::observe(int seat, const Move& move, const GameState& after) {
+    MoveList legal;
+    for (std::size_t i = 0; i < _particles.size(); ++i) {
+        if (_weights[i] == 0.0) continue;
+        GameState& particle = _particles[i];
+        if (rules::check(particle, seat, move) != MoveStatus::Ok) {
+            _weights[i] = 0.0;
+            continue;
+        }
+        // The viewer's own choices say nothing about the hidden coins
+        if (seat != _viewer) {
+            rules::legalMoves(particle, seat, legal);
+            _weights[i] /= static_cast<double>(std::max<std::size_t>(1, legal.size()));
+        }
+        rules::apply(particle, seat, move);
+    }
+    update(after);
+}
+
+void BeliefTracker::observePass(const GameState& after) {
+    for (std::size_t i = 0; i < _particles.size(); ++i)
+        if (_weights[i] != 0.0) rules::nextTurn(_particles[i]);
+    update(after);
+}
+
+void BeliefTracker::update(const GameState& after) {
+    double total = 0.0;
+    for (std::size_t i = 0; i < _particles.size(); ++i) {
+        if (_weights[i] != 0.0 && !samePublicView(_particles[i], after, _viewer)) _weights[i] = 0.0;
+        total += _weights[i];
+    }
+    if (total == 0.0) {
+        // Nothing we believed explains the observation: start over from what is public now
+        ++_resets;
+        reset(after);
+        return;
+    }
+    for (double& weight : _weights) weight /= total;
+    if (effectiveSampleSize() < _config.resampleThreshold * static_cast<double>(_particles.size())) resample();
+}
+
+void BeliefTracker::resample() {
+    const std::size_t n = _particles.size();
+    const double step = 1.0 / static_cast<double>(n);
+    double position = std::uniform_real_distribution<double>(0.0, step)(_rng);
+    double cumulative = _weights[0];
+    std::size_t source = 0;
+    for (std::size_t i = 0; i < n; ++i, position += step) {
+        while (position > cumulative && source + 1 < n) cumulative += _weights[++source];
+        _scratch[i] = _particles[source];
+    }
+    _particles.swap(_scratch);
+    std::fill(_weights.begin(), _weights.end(), step);
+    ++_resamples;
+}
+
+double BeliefTracker::effectiveSampleSize() const {
+    double squares = 0.0;
+    for (double weight : _weights) squares += weight * weight;
+    return squares > 0.0 ? 1.0 / squares : 0.0;
+}
+
+double BeliefTracker::expectedCoins(int seat) const {
+    double coins = 0.0;
+    for (std::size_t i = 0; i < _particles.size(); ++i) coins += _weights[i] * _particles[i].seat(seat).coins;
+    return coins;
+}
+
+double BeliefTracker::probabilityAtLeast(int seat, int coins) const {
+    double probability = 0.0;
+    for (std::size_t i = 0; i < _particles.size(); ++i)
+        if (_particles[i].seat(seat).coins >= coins) probability += _weights[i];
+    return probability;
+}
+
+std::shared_ptr<const Determinizer> BeliefTracker::determinizer() const {
+    return std::make_shared<BeliefDeterminizer>(_viewer, _particles, _weights);
+}
+
+BeliefDeterminizer::BeliefDeterminizer(int viewer, std::vector<GameState> particles, const std::vector<double>& weights)
+    : _viewer(viewer), _particles(std::move(particles)), _cumulative(weights.size()) {
+    if (_particles.empty() || _particles.size() != weights.size())
+        throw GameException("Beliefs need one weight per particle!");
+    double total = 0.0;
+    for (std::size_t i = 0; i < weights.size(); ++i) _cumulative[i] = total += weights[i];
+    if (total <= 0.0) throw GameException("Beliefs need a positive total weight!");
+}
+
+void BeliefDeterminizer::determinize(GameState& state, int viewer, std::mt19937_64& rng) const {
+    if (viewer != _viewer) throw GameException("Beliefs belong to another seat!");
+    double pick = std::uniform_real_distribution<double>(0.0, _cumulative.back())(rng);
+    std::size_t index = static_cast<std::size_t>(std::upper_bound(_cumulative.begin(), _cumulative.end(), pick) - _cumulative.begin());
+    const GameState& particle = _particles[std::min(index, _particles.size() - 1)];
+    int spied = state.seat(viewer).spyTarget;
+    for (int i = 0; i < state.playerCount; ++i)
+        if (i != viewer && i != spied) state.seat(i).coins = particle.seat(i).coins;
+}
+
+} // namespace coup
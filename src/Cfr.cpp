@@ -0,0 +1,329 @@
+//tomergal40@gmail.com
+#include "../include/Cfr.hpp"
+#include "../include/Exceptions.hpp"
+#include "../include/Playout.hpp"
+#include "../include/Zobrist.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+namespace coup {
+
+namespace {
+
+const char CHECKPOINT_MAGIC[8] = {'C', 'O', 'U', 'P', 'C', 'F', 'R', '\0'};
+const std::uint32_t CHECKPOINT_VERSION = 1;
+
+template <typename T>
+void writeValue(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool readValue(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+int findCode(const RegretTable::Action* actions, int count, std::uint8_t code) {
+    for (int i = 0; i < count; ++i)
+        if (actions[i].code == code) return i;
+    return -1;
+}
+
+} // namespace
+
+RegretTable::RegretTable(std::size_t infoSets, std::size_t actionsPerSet) {
+    if (infoSets < 2 || actionsPerSet == 0) throw GameException("Regret table is too small!");
+    std::size_t capacity = 1;
+    while (capacity * 2 <= infoSets) capacity *= 2;
+    _mask = capacity - 1;
+    _slots = std::make_unique<Slot[]>(capacity);
+    _actionCapacity = std::min<std::size_t>(capacity * actionsPerSet, NOT_READY);
+    _actions = std::make_unique<Action[]>(_actionCapacity);
+}
+
+std::uint8_t RegretTable::moveCode(const Move& move) {
+    return static_cast<std::uint8_t>(static_cast<int>(move.type) * 8 + move.target + 1);
+}
+
+Move RegretTable::moveFromCode(std::uint8_t code) {
+    return Move{static_cast<MoveType>(code / 8), code % 8 - 1};
+}
+
+RegretTable::Action* RegretTable::find(std::uint64_t key, int& count) const {
+    key = key ? key : 1;
+    for (std::size_t probe = 0, i = key & _mask; probe <= _mask; ++probe, i = (i + 1) & _mask) {
+        const Slot& slot = _slots[i];
+        std::uint64_t stored = slot.key.load(std::memory_order_acquire);
+        if (stored == 0) return nullptr;
+        if (stored != key) continue;
+        std::uint32_t offset = slot.offset.load(std::memory_order_acquire);
+        if (offset == NOT_READY) return nullptr;
+        count = slot.count;
+        return &_actions[offset];
+    }
+    return nullptr;
+}
+
+RegretTable::Action* RegretTable::findOrCreate(std::uint64_t key, const MoveList& moves, int& count) {
+    key = key ? key : 1;
+    for (std::size_t probe = 0, i = key & _mask; probe <= _mask; ++probe, i = (i + 1) & _mask) {
+        Slot& slot = _slots[i];
+        std::uint64_t stored = slot.key.load(std::memory_order_acquire);
+        if (stored == 0 && slot.key.compare_exchange_strong(stored, key, std::memory_order_acq_rel)) {
+            // Claimed: fill in the counters, then publish them
+            std::size_t offset = _used.fetch_add(moves.size(), std::memory_order_relaxed);
+            if (offset + moves.size() > _actionCapacity) return nullptr; // Arena full, slot stays unready
+            for (std::size_t m = 0; m < moves.size(); ++m) _actions[offset + m].code = moveCode(moves[m]);
+            slot.count = static_cast<std::uint8_t>(moves.size());
+            slot.offset.store(static_cast<std::uint32_t>(offset), std::memory_order_release);
+            _size.fetch_add(1, std::memory_order_relaxed);
+            count = static_cast<int>(moves.size());
+            return &_actions[offset];
+        }
+        if (stored != key) continue; // Another set, or lost the race to one
+        std::uint32_t offset = slot.offset.load(std::memory_order_acquire);
+        if (offset == NOT_READY) return nullptr;
+        count = slot.count;
+        return &_actions[offset];
+    }
+    return nullptr;
+}
+
+void RegretTable::save(const std::string& path) const {
+    // Written next to the target and renamed, so a crash never leaves a
+    // half written checkpoint behind
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) throw GameException("Cannot create checkpoint file " + path);
+        out.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+        writeValue(out, CHECKPOINT_VERSION);
+        writeValue(out, static_cast<std::uint64_t>(size()));
+        for (std::size_t i = 0; i <= _mask; ++i) {
+            const Slot& slot = _slots[i];
+            std::uint64_t key = slot.key.load(std::memory_order_acquire);
+            std::uint32_t offset = slot.offset.load(std::memory_order_acquire);
+            if (key == 0 || offset == NOT_READY) continue;
+            writeValue(out, key);
+            writeValue(out, slot.count);
+            for (int a = 0; a < slot.count; ++a) {
+                const Action& action = _actions[offset + static_cast<std::size_t>(a)];
+                writeValue(out, action.code);
+                writeValue(out, action.regret.load(std::memory_order_relaxed));
+                writeValue(out, action.strategy.load(std::memory_order_relaxed));
+            }
+        }
+        if (!out) throw GameException("Cannot write checkpoint file " + path);
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) throw GameException("Cannot write checkpoint file " + path);
+}
+
+void RegretTable::load(const std::string& path) {
+    if (size() != 0) throw GameException("Checkpoints can only be loaded into an empty table!");
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw GameException("Cannot open checkpoint file " + path);
+    char magic[sizeof(CHECKPOINT_MAGIC)];
+    std::uint32_t version = 0;
+    std::uint64_t sets = 0;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0 ||
+        !readValue(in, version) || version != CHECKPOINT_VERSION || !readValue(in, sets))
+        throw GameException("Not a checkpoint file of this version: " + path);
+
+    for (std::uint64_t s = 0; s < sets; ++s) {
+        std::uint64_t key = 0;
+        std::uint8_t count = 0;
+        if (!readValue(in, key) || !readValue(in, count) || count > MAX_MOVES)
+            throw GameException("Checkpoint file is corrupt: " + path);
+        MoveList moves;
+        float regrets[MAX_MOVES];
+        float strategies[MAX_MOVES];
+        for (int a = 0; a < count; ++a) {
+            std::uint8_t code = 0;
+            if (!readValue(in, code) || !readValue(in, regrets[a]) || !readValue(in, strategies[a]))
+                throw GameException("Checkpoint file is corrupt: " + path);
+            moves.push(moveFromCode(code));
+        }
+        int created = 0;
+        Action* actions = findOrCreate(key, moves, created);
+        if (!actions) throw GameException("Checkpoint does not fit in the regret table: " + path);
+        for (int a = 0; a < created; ++a) {
+            actions[a].regret.store(regrets[a], std::memory_order_relaxed);
+            actions[a].strategy.store(strategies[a], std::memory_order_relaxed);
+        }
+    }
+}
+
+CfrTrainer::CfrTrainer(CfrConfig config) : _config(config), _table(config.infoSets) {
+    if (_config.horizon <= 0) throw GameException("Traversal horizon must be positive!");
+    if (_config.maxPlies <= 0) throw GameException("Playout length must be positive!");
+    if (_config.checkpointEvery == 0) throw GameException("Checkpoint interval must be positive!");
+    if (_config.threads == 0) _config.threads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+std::uint64_t CfrTrainer::infoSetKey(const GameState& state, int turnActions) {
+    GameState seen = state;
+    int viewer = state.currentTurn;
+    int spied = state.seat(viewer).spyTarget;
+    for (int i = 0; i < seen.playerCount; ++i)
+        if (i != viewer && i != spied && seen.seat(i).active()) seen.seat(i).coins = 0;
+    return zobrist::hash(seen) ^ (static_cast<std::uint64_t>(turnActions + 1) * 0x9E3779B97F4A7C15ull);
+}
+
+void CfrTrainer::currentStrategy(const RegretTable::Action* actions, int count, const MoveList& moves,
+                                 double probabilities[MAX_MOVES]) {
+    double total = 0.0;
+    for (std::size_t m = 0; m < moves.size(); ++m) {
+        int index = actions ? findCode(actions, count, RegretTable::moveCode(moves[m])) : -1;
+        double regret = index >= 0 ? actions[index].regret.load(std::memory_order_relaxed) : 0.0;
+        probabilities[m] = regret > 0.0 ? regret : 0.0;
+        total += probabilities[m];
+    }
+    for (std::size_t m = 0; m < moves.size(); ++m)
+        probabilities[m] = total > 0.0 ? probabilities[m] / total : 1.0 / static_cast<double>(moves.size());
+}
+
+double CfrTrainer::traverse(GameState& state, int turnActions, int traverser, int depth, int plies,
+                            std::mt19937_64& rng, std::uint64_t& nodes) {
+    double rewards[STATE_MAX_SEATS];
+    MoveList moves;
+    while (!rules::isGameOver(state) && plies < _config.maxPlies) {
+        rules::legalMoves(state, state.currentTurn, moves);
+        if (!moves.empty()) break;
+        rules::nextTurn(state);
+        turnActions = 0;
+        ++plies;
+    }
+    if (rules::isGameOver(state) || plies >= _config.maxPlies) {
+        scoreOutcome(state, rewards);
+        return rewards[traverser];
+    }
+    if (depth >= _config.horizon) {
+        randomPlayout(state, _config.maxPlies - plies, turnActions, rng);
+        scoreOutcome(state, rewards);
+        return rewards[traverser];
+    }
+
+    ++nodes;
+    int count = 0;
+    RegretTable::Action* actions = _table.findOrCreate(infoSetKey(state, turnActions), moves, count);
+    double strategy[MAX_MOVES];
+    currentStrategy(actions, count, moves, strategy);
+
+    if (state.currentTurn != traverser) {
+        // Add the strategy to the average, then sample one move from it
+        if (actions) {
+            for (std::size_t m = 0; m < moves.size(); ++m) {
+                int index = findCode(actions, count, RegretTable::moveCode(moves[m]));
+                if (index >= 0) actions[index].strategy.fetch_add(static_cast<float>(strategy[m]), std::memory_order_relaxed);
+            }
+        }
+        double pick = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        std::size_t chosen = 0;
+        while (chosen + 1 < moves.size() && pick >= strategy[chosen]) pick -= strategy[chosen++];
+        advance(state, moves[chosen], turnActions);
+        return traverse(state, turnActions, traverser, depth + 1, plies + 1, rng, nodes);
+    }
+
+    // Try every move and accumulate the regret of not having played it
+    double values[MAX_MOVES];
+    double expected = 0.0;
+    for (std::size_t m = 0; m < moves.size(); ++m) {
+        GameState next = state;
+        int nextActions = turnActions;
+        advance(next, moves[m], nextActions);
+        values[m] = traverse(next, nextActions, traverser, depth + 1, plies + 1, rng, nodes);
+        expected += strategy[m] * values[m];
+    }
+    if (actions) {
+        for (std::size_t m = 0; m < moves.size(); ++m) {
+            int index = findCode(actions, count, RegretTable::moveCode(moves[m]));
+            if (index >= 0)
+                actions[index].regret.fetch_add(static_cast<float>(values[m] - expected), std::memory_order_relaxed);
+        }
+    }
+    return expected;
+}
+
+CfrResult CfrTrainer::train(const GameState& root, std::uint64_t iterations) {
+    if (rules::isGameOver(root)) throw GameOverException();
+
+    CfrResult result;
+    auto start = std::chrono::steady_clock::now();
+    unsigned threads = _config.threads;
+    std::uint64_t round = 0;
+    while (result.iterations < iterations) {
+        std::uint64_t batch = std::min(_config.checkpointEvery, iterations - result.iterations);
+        std::atomic<std::uint64_t> claimed{0};
+        std::vector<std::uint64_t> nodes(threads, 0);
+        std::vector<std::exception_ptr> errors(threads);
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([this, t, round, batch, &root, &claimed, &nodes, &errors] {
+                try {
+                    std::seed_seq seq{static_cast<std::uint32_t>(_config.seed), static_cast<std::uint32_t>(_config.seed >> 32),
+                                      t, static_cast<std::uint32_t>(round)};
+                    std::mt19937_64 rng(seq);
+                    while (claimed.fetch_add(1, std::memory_order_relaxed) < batch) {
+                        for (int traverser = 0; traverser < root.playerCount; ++traverser) {
+                            if (!root.seat(traverser).active()) continue;
+                            GameState state = root;
+                            traverse(state, 0, traverser, 0, 0, rng, nodes[t]);
+                        }
+                    }
+                } catch (...) {
+                    errors[t] = std::current_exception();
+                }
+            });
+        }
+        for (auto& worker : workers) worker.join();
+        for (const auto& error : errors)
+            if (error) std::rethrow_exception(error);
+
+        result.iterations += batch;
+        for (std::uint64_t count : nodes) result.nodes += count;
+        ++round;
+        if (!_config.checkpointPath.empty()) {
+            _table.save(_config.checkpointPath);
+            ++result.checkpoints;
+        }
+    }
+    result.infoSets = _table.size();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+bool CfrTrainer::averageStrategy(const GameState& state, int turnActions, MoveList& moves,
+                                 double probabilities[MAX_MOVES]) const {
+    rules::legalMoves(state, state.currentTurn, moves);
+    int count = 0;
+    const RegretTable::Action* actions = _table.find(infoSetKey(state, turnActions), count);
+    double total = 0.0;
+    for (std::size_t m = 0; m < moves.size(); ++m) {
+        int index = actions ? findCode(actions, count, RegretTable::moveCode(moves[m])) : -1;
+        probabilities[m] = index >= 0 ? actions[index].strategy.load(std::memory_order_relaxed) : 0.0;
+        total += probabilities[m];
+    }
+    for (std::size_t m = 0; m < moves.size(); ++m)
+        probabilities[m] = total > 0.0 ? probabilities[m] / total : 1.0 / static_cast<double>(moves.size());
+    return total > 0.0;
+}
+
+Move CfrTrainer::bestMove(const GameState& state, int turnActions) const {
+    MoveList moves;
+    double probabilities[MAX_MOVES];
+    averageStrategy(state, turnActions, moves, probabilities);
+    if (moves.empty()) throw IllegalMoveException("No legal move for the seat to play!");
+    std::size_t best = 0;
+    for (std::size_t m = 1; m < moves.size(); ++m)
+        if (probabilities[m] > probabilities[best]) best = m;
+    return moves[best];
+}
+
+} // namespace coup
@@ -0,0 +1,675 @@
+//tomergal40@gmail.com
+#include "../include/CoupServer.hpp"
+#include "../include/Exceptions.hpp"
+#include "../include/Player.hpp"
+#include "../include/Simulator.hpp"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace coup {
+
+using protocol::ErrorCode;
+using protocol::FrameReader;
+using protocol::FrameWriter;
+using protocol::MessageType;
+
+namespace {
+
+GameException socketError(const std::string& what) {
+    return GameException(what + ": " + std::strerror(errno));
+}
+
+void appendError(std::string& out, std::uint32_t request, ErrorCode code, const std::string& message) {
+    FrameWriter writer(out, MessageType::Error, request);
+    writer.u8(static_cast<std::uint8_t>(code)).text(message);
+    writer.finish();
+}
+
+void appendActionResult(std::string& out, std::uint32_t request, const Game& game, int seat, MoveStatus status) {
+    GameState state = game.snapshot();
+    FrameWriter writer(out, MessageType::ActionResult, request);
+    writer.u8(static_cast<std::uint8_t>(status)).u8(state.currentTurn).u8(game.isGameOver() ? 1 : 0).i16(state.bank);
+    writer.i16(seat < state.playerCount ? state.seat(seat).coins : 0);
+    writer.finish();
+}
+
+sockaddr_un unixAddress(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) throw GameException("Unix socket path too long: " + path);
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+} // namespace
+
+struct CoupServer::Loop {
+    struct Connection {
+        std::uint32_t generation = 0;   // Tells a reused fd apart from the connection a reply was meant for
+        std::string in;
+        std::string out;
+        bool writing = false;           // Registered for EPOLLOUT
+        std::unordered_set<GameId> games;   // Games it used, to leave when it goes
+    };
+
+    struct Outgoing {
+        int fd;
+        std::uint32_t generation;
+        std::string frame;
+    };
+
+    int epollFd = -1;
+    int listenFd = -1;
+    bool ownsListen = true;
+    int wakeFd = -1;
+    std::thread thread;
+    std::unordered_map<int, Connection> connections;
+    std::uint32_t nextGeneration = 1;
+
+    std::mutex mailboxMutex;
+    std::vector<Outgoing> mailbox;      // Replies from game shards, guarded by mailboxMutex
+    std::vector<Outgoing> delivering;   // Owned by the loop thread
+
+    ~Loop() {
+        for (auto& entry : connections) ::close(entry.first);
+        if (ownsListen && listenFd >= 0) ::close(listenFd);
+        if (wakeFd >= 0) ::close(wakeFd);
+        if (epollFd >= 0) ::close(epollFd);
+    }
+};
+
+CoupServer::CoupServer(ServerConfig config) : _config(std::move(config)), _host(_config.games) {
+    _clients.resize(_host.shardCount());
+}
+
+CoupServer::~CoupServer() {
+    stop();
+}
+
+void CoupServer::start() {
+    if (_started) throw GameException("Server already started!");
+    unsigned loops = _config.loops ? _config.loops : std::max(1u, std::thread::hardware_concurrency());
+    bool tcp = _config.unixPath.empty();
+    _loops.clear();
+    for (unsigned i = 0; i < loops; ++i) {
+        auto loop = std::make_unique<Loop>();
+        if (tcp) {
+            loop->listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (loop->listenFd < 0) throw socketError("socket");
+            int on = 1;
+            ::setsockopt(loop->listenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+            if (::setsockopt(loop->listenFd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) < 0) throw socketError("SO_REUSEPORT");
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(static_cast<std::uint16_t>(i == 0 ? _config.port : _port));
+            if (::inet_pton(AF_INET, _config.host.c_str(), &address.sin_addr) != 1)
+                throw GameException("Invalid listen address: " + _config.host);
+            if (::bind(loop->listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) throw socketError("bind");
+            if (::listen(loop->listenFd, SOMAXCONN) < 0) throw socketError("listen");
+            if (i == 0) {
+                socklen_t length = sizeof(address);
+                ::getsockname(loop->listenFd, reinterpret_cast<sockaddr*>(&address), &length);
+                _port = ntohs(address.sin_port);
+            }
+        } else if (i == 0) {
+            sockaddr_un address = unixAddress(_config.unixPath);
+            ::unlink(_config.unixPath.c_str());
+            loop->listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (loop->listenFd < 0) throw socketError("socket");
+            if (::bind(loop->listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) throw socketError("bind");
+            if (::listen(loop->listenFd, SOMAXCONN) < 0) throw socketError("listen");
+        } else {
+            loop->listenFd = _loops[0]->listenFd;
+            loop->ownsListen = false;
+        }
+
+        loop->epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+        loop->wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (loop->epollFd < 0 || loop->wakeFd < 0) throw socketError("epoll");
+        epoll_event event{};
+        event.events = EPOLLIN | (tcp ? 0u : static_cast<std::uint32_t>(EPOLLEXCLUSIVE));
+        event.data.fd = loop->listenFd;
+        if (::epoll_ctl(loop->epollFd, EPOLL_CTL_ADD, loop->listenFd, &event) < 0) throw socketError("epoll_ctl");
+        event.events = EPOLLIN;
+        event.data.fd = loop->wakeFd;
+        if (::epoll_ctl(loop->epollFd, EPOLL_CTL_ADD, loop->wakeFd, &event) < 0) throw socketError("epoll_ctl");
+        _loops.push_back(std::move(loop));
+    }
+
+    _running.store(true, std::memory_order_release);
+    _started = true;
+    for (auto& loop : _loops) {
+        Loop* raw = loop.get();
+        loop->thread = std::thread([this, raw] { run(*raw); });
+    }
+}
+
+void CoupServer::stop() {
+    if (!_started) return;
+    _running.store(false, std::memory_order_release);
+    for (auto& loop : _loops) {
+        std::uint64_t one = 1;
+        ssize_t written = ::write(loop->wakeFd, &one, sizeof(one));
+        (void)written;
+    }
+    for (auto& loop : _loops) loop->thread.join();
+    for (auto& loop : _loops) {
+        for (auto& entry : loop->connections) {
+            for (GameId game : entry.second.games) leave(game);
+            ::close(entry.first);
+        }
+        loop->connections.clear();
+    }
+    // Shard tasks still in flight post their replies into the loops, which
+    // the next start() frees
+    _host.drain();
+    if (!_config.unixPath.empty()) ::unlink(_config.unixPath.c_str());
+    _started = false;
+}
+
+void CoupServer::run(Loop& loop) {
+    epoll_event events[64];
+    while (_running.load(std::memory_order_acquire)) {
+        int count = ::epoll_wait(loop.epollFd, events, 64, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        for (int i = 0; i < count; ++i) {
+            int fd = events[i].data.fd;
+            std::uint32_t flags = events[i].events;
+            if (fd == loop.listenFd) {
+                accept(loop);
+            } else if (fd == loop.wakeFd) {
+                std::uint64_t value;
+                ssize_t got = ::read(loop.wakeFd, &value, sizeof(value));
+                (void)got;
+                deliver(loop);
+            } else if (flags & (EPOLLERR | EPOLLHUP)) {
+                closeConnection(loop, fd);
+            } else {
+                if (flags & EPOLLIN) receive(loop, fd);
+                if ((flags & EPOLLOUT) && loop.connections.count(fd)) flush(loop, fd);
+            }
+        }
+    }
+}
+
+void CoupServer::accept(Loop& loop) {
+    while (true) {
+        int fd = ::accept4(loop.listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return; // EAGAIN, or another loop took it
+        if (_config.unixPath.empty()) {
+            int on = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        }
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.fd = fd;
+        if (::epoll_ctl(loop.epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            ::close(fd);
+            continue;
+        }
+        Loop::Connection& connection = loop.connections[fd];
+        connection = Loop::Connection();
+        connection.generation = loop.nextGeneration++;
+        _connections.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void CoupServer::receive(Loop& loop, int fd) {
+    char buffer[16 * 1024];
+    while (true) {
+        ssize_t got = ::read(fd, buffer, sizeof(buffer));
+        if (got == 0 || (got < 0 && errno != EAGAIN && errno != EINTR)) {
+            closeConnection(loop, fd);
+            return;
+        }
+        if (got < 0) break;
+
+        std::string& in = loop.connections[fd].in;
+        in.append(buffer, static_cast<std::size_t>(got));
+        std::size_t offset = 0;
+        try {
+            for (std::size_t length; (length = protocol::frameLength(in.data() + offset, in.size() - offset)) > 0; offset += length)
+                if (!handle(loop, fd, in.data() + offset + protocol::HEADER_BYTES, length - protocol::HEADER_BYTES)) {
+                    closeConnection(loop, fd);
+                    return;
+                }
+        } catch (const GameException&) {
+            // Framing is lost: there is no way to find the next message
+            closeConnection(loop, fd);
+            return;
+        }
+        in.erase(0, offset);
+        // A client sending faster than it reads: flush() hangs up on it
+        if (loop.connections[fd].out.size() > _config.maxPendingOutput) break;
+    }
+    flush(loop, fd);
+}
+
+void CoupServer::flush(Loop& loop, int fd) {
+    auto found = loop.connections.find(fd);
+    if (found == loop.connections.end()) return;
+    Loop::Connection& connection = found->second;
+    std::size_t sent = 0;
+    while (sent < connection.out.size()) {
+        ssize_t n = ::send(fd, connection.out.data() + sent, connection.out.size() - sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            sent += static_cast<std::size_t>(n);
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EINTR)) break;
+        closeConnection(loop, fd);
+        return;
+    }
+    connection.out.erase(0, sent);
+    if (connection.out.size() > _config.maxPendingOutput) {
+        // Replies pile up for a client that does not read them
+        closeConnection(loop, fd);
+        return;
+    }
+
+    // Wait for room in the socket buffer only while something is left to send
+    bool writing = !connection.out.empty();
+    if (writing != connection.writing) {
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP | (writing ? static_cast<std::uint32_t>(EPOLLOUT) : 0u);
+        event.data.fd = fd;
+        ::epoll_ctl(loop.epollFd, EPOLL_CTL_MOD, fd, &event);
+        connection.writing = writing;
+    }
+}
+
+void CoupServer::deliver(Loop& loop) {
+    {
+        std::lock_guard<std::mutex> lock(loop.mailboxMutex);
+        loop.delivering.swap(loop.mailbox);
+    }
+    for (Loop::Outgoing& outgoing : loop.delivering) {
+        auto found = loop.connections.find(outgoing.fd);
+        if (found != loop.connections.end() && found->second.generation == outgoing.generation)
+            found->second.out += outgoing.frame;
+    }
+    for (Loop::Outgoing& outgoing : loop.delivering) {
+        auto found = loop.connections.find(outgoing.fd);
+        if (found != loop.connections.end() && !found->second.out.empty()) flush(loop, outgoing.fd);
+    }
+    loop.delivering.clear();
+}
+
+void CoupServer::closeConnection(Loop& loop, int fd) {
+    auto found = loop.connections.find(fd);
+    if (found == loop.connections.end()) return;
+    for (GameId game : found->second.games) leave(game);
+    loop.connections.erase(found);
+    ::epoll_ctl(loop.epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    _connections.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void CoupServer::post(Loop& loop, int fd, std::uint32_t generation, std::string frame) {
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(loop.mailboxMutex);
+        wake = loop.mailbox.empty();
+        loop.mailbox.push_back(Loop::Outgoing{fd, generation, std::move(frame)});
+    }
+    if (wake) {
+        std::uint64_t one = 1;
+        ssize_t written = ::write(loop.wakeFd, &one, sizeof(one));
+        (void)written;
+    }
+}
+
+void CoupServer::join(Loop& loop, int fd, GameId game) {
+    if (!loop.connections[fd].games.insert(game).second) return;
+    _host.post(game, [this, game](Game&, MoveStatus) { ++_clients[_host.shardOf(game)][game]; });
+}
+
+void CoupServer::leave(GameId game) {
+    _host.post(game, [this, game](Game& g, MoveStatus) {
+        std::unordered_map<GameId, unsigned>& clients = _clients[_host.shardOf(game)];
+        auto found = clients.find(game);
+        if (found == clients.end() || --found->second > 0) return;
+        clients.erase(found);
+        // An unfinished game stays: anyone may still connect and play it
+        if (g.snapshot().started && g.isGameOver()) _host.closeGame(game);
+    });
+}
+
+bool CoupServer::handle(Loop& loop, int fd, const char* body, std::size_t size) {
+    FrameReader reader(body, size);
+    MessageType type = static_cast<MessageType>(reader.u8());
+    std::uint32_t request = reader.u32();
+    if (!reader.ok()) return false;     // Not even a request id to answer
+    _requests.fetch_add(1, std::memory_order_relaxed);
+    Loop::Connection& connection = loop.connections[fd];
+    std::string& out = connection.out;
+    const std::uint32_t generation = connection.generation;
+    Loop* target = &loop;
+
+    if (type == MessageType::CreateGame) {
+        std::vector<RoleId> roles(reader.u8());
+        for (RoleId& role : roles) role = static_cast<RoleId>(reader.u8());
+        if (!reader.ok() || !reader.atEnd()) {
+            appendError(out, request, ErrorCode::Malformed, "Malformed CreateGame");
+            return true;
+        }
+        try {
+            GameId game = _host.createGame(roles);
+            join(loop, fd, game);
+            FrameWriter writer(out, MessageType::GameCreated, request);
+            writer.u32(game);
+            writer.finish();
+        } catch (const GameException& e) {
+            appendError(out, request, ErrorCode::Rejected, e.what());
+        }
+        return true;
+    }
+
+    GameId game = reader.u32();
+    if (!reader.ok()) {
+        appendError(out, request, ErrorCode::Malformed, "Missing game id");
+        return true;
+    }
+    if (game >= _host.gamesCreated()) {
+        appendError(out, request, ErrorCode::UnknownGame, "Unknown game");
+        return true;
+    }
+    // Closed by now, or by the time the request reaches the game's shard
+    auto unknown = [this, target, fd, generation, request] {
+        std::string reply;
+        appendError(reply, request, ErrorCode::UnknownGame, "Unknown game");
+        post(*target, fd, generation, std::move(reply));
+    };
+    if (type == MessageType::CloseGame) {
+        if (!reader.atEnd()) {
+            appendError(out, request, ErrorCode::Malformed, "Malformed CloseGame");
+            return true;
+        }
+        connection.games.erase(game);
+        _host.post(game, [this, target, fd, generation, request, game](Game&, MoveStatus) {
+            _clients[_host.shardOf(game)].erase(game);
+            _host.closeGame(game);
+            std::string reply;
+            FrameWriter(reply, MessageType::GameClosed, request).finish();
+            post(*target, fd, generation, std::move(reply));
+        }, unknown);
+        return true;
+    }
+    join(loop, fd, game);
+
+    switch (type) {
+        case MessageType::AddPlayer: {
+            RoleId role = static_cast<RoleId>(reader.u8());
+            std::string name = reader.text();
+            if (!reader.ok() || !reader.atEnd() || static_cast<std::size_t>(role) >= PLAYABLE_ROLE_COUNT) {
+                appendError(out, request, ErrorCode::Malformed, "Malformed AddPlayer");
+                return true;
+            }
+            _host.post(game, [this, target, fd, generation, request, role, name](Game& g, MoveStatus) {
+                std::string reply;
+                try {
+                    auto player = createPlayer(g, toString(role), name);
+                    g.addPlayer(player);
+                    FrameWriter writer(reply, MessageType::PlayerAdded, request);
+                    writer.u8(static_cast<std::uint8_t>(player->seat()));
+                    writer.finish();
+                } catch (const GameException& e) {
+                    appendError(reply, request, ErrorCode::Rejected, e.what());
+                }
+                post(*target, fd, generation, std::move(reply));
+            }, unknown);
+            return true;
+        }
+        case MessageType::StartGame:
+            if (!reader.atEnd()) break;
+            _host.post(game, [this, target, fd, generation, request](Game& g, MoveStatus) {
+                std::string reply;
+                try {
+                    if (g.snapshot().started) throw GameException("Game already started!");
+                    g.startGame();
+                    FrameWriter(reply, MessageType::GameStarted, request).finish();
+                } catch (const GameException& e) {
+                    appendError(reply, request, ErrorCode::Rejected, e.what());
+                }
+                post(*target, fd, generation, std::move(reply));
+            }, unknown);
+            return true;
+        case MessageType::Action: {
+            int seat = reader.u8();
+            int moveType = reader.u8();
+            int moveTarget = reader.i8();
+            if (!reader.ok() || !reader.atEnd() || moveType >= MOVE_TYPE_COUNT) break;
+            Move move{static_cast<MoveType>(moveType), moveTarget};
+            if (move.type == MoveType::Undo) {
+                // Blocks arrive out of turn, racing the turn player: they take
+                // the shard's lock-free reaction queue instead of the inbox
+                _host.react(game, seat, move, [this, target, fd, generation, request, seat](Game& g, MoveStatus status) {
+                    std::string reply;
+                    if (!g.snapshot().started) appendError(reply, request, ErrorCode::NotStarted, "Game has not started");
+                    else appendActionResult(reply, request, g, seat, status);
+                    post(*target, fd, generation, std::move(reply));
+                }, unknown);
+                return true;
+            }
+            _host.post(game, [this, target, fd, generation, request, seat, move](Game& g, MoveStatus) {
+                std::string reply;
+                if (!g.snapshot().started) appendError(reply, request, ErrorCode::NotStarted, "Game has not started");
+                else appendActionResult(reply, request, g, seat, g.tryApply(seat, move));
+                post(*target, fd, generation, std::move(reply));
+            }, unknown);
+            return true;
+        }
+        case MessageType::GetState:
+            if (!reader.atEnd()) break;
+            _host.post(game, [this, target, fd, generation, request](Game& g, MoveStatus) {
+                std::string reply;
+                GameState state = g.snapshot();
+                FrameWriter writer(reply, MessageType::State, request);
+                writer.i16(state.bank).u8(state.currentTurn).u8(state.started).u8(state.playerCount);
+                for (int seat = 0; seat < state.playerCount; ++seat) {
+                    const SeatState& s = state.seat(seat);
+                    writer.i16(s.coins).u8(static_cast<std::uint8_t>(s.role)).u8(s.flags);
+                    writer.i8(s.lastArrested).i8(s.spyTarget).u16(s.pending);
+                }
+                writer.finish();
+                post(*target, fd, generation, std::move(reply));
+            }, unknown);
+            return true;
+        default:
+            break;
+    }
+    appendError(out, request, ErrorCode::Malformed, "Malformed request");
+    return true;
+}
+
+CoupClient CoupClient::connectTcp(const std::string& host, int port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) throw socketError("socket");
+    CoupClient client(fd);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<std::uint16_t>(port));
+    if (::inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) throw GameException("Invalid server address: " + host);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) throw socketError("connect");
+    int on = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    return client;
+}
+
+CoupClient CoupClient::connectUnix(const std::string& path) {
+    sockaddr_un address = unixAddress(path);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) throw socketError("socket");
+    CoupClient client(fd);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) throw socketError("connect");
+    return client;
+}
+
+CoupClient::~CoupClient() {
+    if (_fd >= 0) ::close(_fd);
+}
+
+CoupClient::CoupClient(CoupClient&& other) noexcept
+    : _fd(other._fd), _in(std::move(other._in)), _nextRequest(other._nextRequest) {
+    other._fd = -1;
+}
+
+CoupClient& CoupClient::operator=(CoupClient&& other) noexcept {
+    if (this != &other) {
+        if (_fd >= 0) ::close(_fd);
+        _fd = other._fd;
+        _in = std::move(other._in);
+        _nextRequest = other._nextRequest;
+        other._fd = -1;
+    }
+    return *this;
+}
+
+void CoupClient::sendRaw(const std::string& bytes) {
+    std::size_t sent = 0;
+    while (sent < bytes.size()) {
+        ssize_t n = ::send(_fd, bytes.data() + sent, bytes.size() - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw socketError("send");
+        }
+        sent += static_cast<std::size_t>(n);
+    }
+}
+
+std::string CoupClient::roundTrip(const std::string& out, std::uint32_t request) {
+    sendRaw(out);
+    char buffer[4096];
+    while (true) {
+        std::size_t length = protocol::frameLength(_in.data(), _in.size());
+        if (length > 0) {
+            std::string body = _in.substr(protocol::HEADER_BYTES, length - protocol::HEADER_BYTES);
+            _in.erase(0, length);
+            FrameReader reader(body.data(), body.size());
+            MessageType type = static_cast<MessageType>(reader.u8());
+            if (reader.u32() != request) throw GameException("Reply to another request!");
+            if (type == MessageType::Error) {
+                reader.u8();
+                throw GameException(reader.text());
+            }
+            return body;
+        }
+        ssize_t got = ::read(_fd, buffer, sizeof(buffer));
+        if (got == 0) throw GameException("Server closed the connection!");
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            throw socketError("read");
+        }
+        _in.append(buffer, static_cast<std::size_t>(got));
+    }
+}
+
+GameId CoupClient::createGame(const std::vector<RoleId>& roles) {
+    std::string out;
+    std::uint32_t request = _nextRequest++;
+    FrameWriter writer(out, MessageType::CreateGame, request);
+    writer.u8(static_cast<std::uint8_t>(roles.size()));
+    for (RoleId role : roles) writer.u8(static_cast<std::uint8_t>(role));
+    writer.finish();
+    std::string body = roundTrip(out, request);
+    FrameReader reader(body.data(), body.size());
+    reader.u8();
+    reader.u32();
+    return reader.u32();
+}
+
+int CoupClient::addPlayer(GameId game, RoleId role, const std::string& name) {
+    std::string out;
+    std::uint32_t request = _nextRequest++;
+    FrameWriter writer(out, MessageType::AddPlayer, request);
+    writer.u32(game).u8(static_cast<std::uint8_t>(role)).text(name);
+    writer.finish();
+    std::string body = roundTrip(out, request);
+    FrameReader reader(body.data(), body.size());
+    reader.u8();
+    reader.u32();
+    return reader.u8();
+}
+
+void CoupClient::startGame(GameId game) {
+    std::string out;
+    std::uint32_t request = _nextRequest++;
+    FrameWriter writer(out, MessageType::StartGame, request);
+    writer.u32(game);
+    writer.finish();
+    roundTrip(out, request);
+}
+
+ActionReply CoupClient::act(GameId game, int seat, const Move& move) {
+    std::string out;
+    std::uint32_t request = _nextRequest++;
+    FrameWriter writer(out, MessageType::Action, request);
+    writer.u32(game).u8(static_cast<std::uint8_t>(seat)).u8(static_cast<std::uint8_t>(move.type)).i8(static_cast<std::int8_t>(move.target));
+    writer.finish();
+    std::string body = roundTrip(out, request);
+    FrameReader reader(body.data(), body.size());
+    reader.u8();
+    reader.u32();
+    ActionReply reply;
+    reply.status = static_cast<MoveStatus>(reader.u8());
+    reply.currentTurn = reader.u8();
+    reply.gameOver = reader.u8() != 0;
+    reply.bank = reader.i16();
+    reply.coins = reader.i16();
+    return reply;
+}
+
+GameState CoupClient::state(GameId game) {
+    std::string out;
+    std::uint32_t request = _nextRequest++;
+    FrameWriter writer(out, MessageType::GetState, request);
+    writer.u32(game);
+    writer.finish();
+    std::string body = roundTrip(out, request);
+    FrameReader reader(body.data(), body.size());
+    reader.u8();
+    reader.u32();
+    GameState state{};
+    state.bank = reader.i16();
+    state.currentTurn = reader.u8();
+    state.started = reader.u8();
+    state.playerCount = reader.u8();
+    if (state.playerCount > STATE_MAX_SEATS) throw GameException("Malformed state reply!");
+    for (int seat = 0; seat < state.playerCount; ++seat) {
+        SeatState& s = state.seat(seat);
+        s.coins = reader.i16();
+        s.role = static_cast<RoleId>(reader.u8());
+        s.flags = reader.u8();
+        s.lastArrested = reader.i8();
+        s.spyTarget = reader.i8();
+        s.pending = reader.u16();
+    }
+    if (!reader.ok() || !reader.atEnd()) throw GameException("Malformed state reply!");
+    return state;
+}
+
+void CoupClient::closeGame(GameId game) {
+    std::string out;
+    std::uint32_t request = _nextRequest++;
+    FrameWriter writer(out, MessageType::CloseGame, request);
+    writer.u32(game);
+    writer.finish();
+    roundTrip(out, request);
+}
+
+} // namespace coup
@@ -0,0 +1,147 @@
+//tomergal40@gmail.com
+#include "../include/Evaluation.hpp"
+#include "../include/Exceptions.hpp"
+#include "../include/Game.hpp"
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define COUP_EVAL_AVX2 1
+#endif
+
+namespace coup {
+
+namespace {
+
+#ifdef COUP_EVAL_AVX2
+// Compiled for AVX2 and FMA on its own, so the rest of the build keeps the
+// baseline instruction set; only called after checking the CPU
+__attribute__((target("avx2,fma")))
+void evaluateAvx2(const EvalWeights& weights, const PositionBatch& batch, float* scores) {
+    const std::size_t size = batch.size();
+    const float* columns[EVAL_FEATURE_COUNT];
+    __m256 w[EVAL_FEATURE_COUNT];
+    for (int f = 0; f < EVAL_FEATURE_COUNT; ++f) {
+        columns[f] = batch.column(static_cast<EvalFeature>(f));
+        w[f] = _mm256_set1_ps(weights.weights[static_cast<std::size_t>(f)]);
+    }
+    const __m256 bias = _mm256_set1_ps(weights.bias);
+
+    // Two independent accumulators hide the latency of the dependent FMAs
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m256 low = bias;
+        __m256 high = bias;
+        for (int f = 0; f < EVAL_FEATURE_COUNT; ++f) {
+            low = _mm256_fmadd_ps(w[f], _mm256_loadu_ps(columns[f] + i), low);
+            high = _mm256_fmadd_ps(w[f], _mm256_loadu_ps(columns[f] + i + 8), high);
+        }
+        _mm256_storeu_ps(scores + i, low);
+        _mm256_storeu_ps(scores + i + 8, high);
+    }
+    for (; i + 8 <= size; i += 8) {
+        __m256 sum = bias;
+        for (int f = 0; f < EVAL_FEATURE_COUNT; ++f)
+            sum = _mm256_fmadd_ps(w[f], _mm256_loadu_ps(columns[f] + i), sum);
+        _mm256_storeu_ps(scores + i, sum);
+    }
+    for (; i < size; ++i) {
+        float sum = weights.bias;
+        for (int f = 0; f < EVAL_FEATURE_COUNT; ++f) sum += weights.weights[static_cast<std::size_t>(f)] * columns[f][i];
+        scores[i] = sum;
+    }
+}
+#endif
+
+} // namespace
+
+EvalWeights EvalWeights::defaults() {
+    EvalWeights w;
+    w[EvalFeature::Active] = 100.0f;
+    w[EvalFeature::Coins] = 1.0f;
+    w[EvalFeature::CanCoup] = 3.0f;
+    w[EvalFeature::MustCoup] = -1.0f;
+    w[EvalFeature::Sanctioned] = -1.5f;
+    w[EvalFeature::Opponents] = -20.0f;
+    w[EvalFeature::RichestOpponent] = -0.8f;
+    w[EvalFeature::OpponentThreats] = -3.0f;
+    w[EvalFeature::OpponentsSanctioned] = 1.0f;
+    w[EvalFeature::Governor] = 0.5f;
+    w[EvalFeature::Spy] = 0.2f;
+    w[EvalFeature::Baron] = 0.3f;
+    w[EvalFeature::General] = 0.6f;
+    w[EvalFeature::Judge] = 0.3f;
+    w[EvalFeature::Merchant] = 0.4f;
+    return w;
+}
+
+PositionBatch::PositionBatch(std::size_t capacity)
+    : _capacity(capacity), _columns(capacity * EVAL_FEATURE_COUNT, 0.0f) {
+    if (capacity == 0) throw GameException("A position batch needs room for at least one position!");
+}
+
+void PositionBatch::add(const GameState& state, int seat) {
+    if (full()) throw GameException("Position batch is full!");
+    const SeatState& self = state.seat(seat);
+    float values[EVAL_FEATURE_COUNT] = {};
+    auto set = [&values](EvalFeature feature, float value) { values[static_cast<int>(feature)] = value; };
+
+    set(EvalFeature::Active, self.active() ? 1.0f : 0.0f);
+    set(EvalFeature::Coins, self.coins);
+    set(EvalFeature::CanCoup, self.coins >= 7 ? 1.0f : 0.0f);
+    set(EvalFeature::MustCoup, self.mustCoup() ? 1.0f : 0.0f);
+    set(EvalFeature::Sanctioned, self.sanctioned() ? 1.0f : 0.0f);
+    int opponents = 0, richest = 0, threats = 0, sanctioned = 0;
+    for (int i = 0; i < state.playerCount; ++i) {
+        const SeatState& other = state.seat(i);
+        if (i == seat || !other.active()) continue;
+        ++opponents;
+        richest = std::max(richest, static_cast<int>(other.coins));
+        if (other.coins >= 7) ++threats;
+        if (other.sanctioned()) ++sanctioned;
+    }
+    set(EvalFeature::Opponents, static_cast<float>(opponents));
+    set(EvalFeature::RichestOpponent, static_cast<float>(richest));
+    set(EvalFeature::OpponentThreats, static_cast<float>(threats));
+    set(EvalFeature::OpponentsSanctioned, static_cast<float>(sanctioned));
+    if (static_cast<std::size_t>(self.role) < PLAYABLE_ROLE_COUNT)
+        values[static_cast<int>(EvalFeature::Governor) + static_cast<int>(self.role)] = 1.0f;
+
+    for (int f = 0; f < EVAL_FEATURE_COUNT; ++f) _columns[static_cast<std::size_t>(f) * _capacity + _size] = values[f];
+    ++_size;
+}
+
+void PositionBatch::add(const Game& game, int seat) {
+    add(game.snapshot(), seat);
+}
+
+void evaluateScalar(const EvalWeights& weights, const PositionBatch& batch, float* scores) {
+    const std::size_t size = batch.size();
+    std::fill(scores, scores + size, weights.bias);
+    for (int f = 0; f < EVAL_FEATURE_COUNT; ++f) {
+        const float w = weights.weights[static_cast<std::size_t>(f)];
+        const float* column = batch.column(static_cast<EvalFeature>(f));
+        for (std::size_t i = 0; i < size; ++i) scores[i] += w * column[i];
+    }
+}
+
+bool hasAvx2Evaluation() {
+#ifdef COUP_EVAL_AVX2
+    static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+void evaluate(const EvalWeights& weights, const PositionBatch& batch, float* scores) {
+#ifdef COUP_EVAL_AVX2
+    if (hasAvx2Evaluation()) {
+        evaluateAvx2(weights, batch, scores);
+        return;
+    }
+#endif
+    evaluateScalar(weights, batch, scores);
+}
+
+} // namespace coup
@@ -0,0 +1,167 @@
+//tomergal40@gmail.com
+#include "../include/EventSink.hpp"
+#include "../include/Game.hpp"
+#include "../include/Exceptions.hpp"
+#include <chrono>
+#include <iostream>
+
+namespace coup {
+
+namespace {
+
+// Chunk size at which the async writer is woken before its timer
+const std::size_t ASYNC_WAKE_BYTES = 64 * 1024;
+
+// Serializes BufferedEventSink flushes to streams shared between threads
+std::mutex flushMutex;
+
+// Appends every part in place, without building temporaries
+template <typename... Parts>
+void append(std::string& out, const Parts&... parts) {
+    ((out += parts), ...);
+}
+
+} // namespace
+
+void appendEvent(std::string& out, const Game& game, const Event& event) {
+    const std::string& actor = game.playerName(event.actor);
+    const std::string& target = game.playerName(event.target);
+    switch (event.type) {
+        case EventType::PlayerAdded:
+            append(out, "Added player: ", actor);
+            break;
+        case EventType::MustCoup:
+            append(out, "You have 10+ coins and must perform a coup this turn!");
+            break;
+        case EventType::GovernorTax:
+            append(out, "Governor ", actor, " collected 3 coins in tax");
+            break;
+        case EventType::TaxUndone:
+            append(out, "Governor ", actor, " undid the tax collection by ", target);
+            break;
+        case EventType::Invested:
+            append(out, "Baron ", actor, " invested 3 coins and received 6 in return!");
+            break;
+        case EventType::SanctionCompensation:
+            append(out, "Baron ", actor, " received 1 coin compensation after being sanctioned by ",
+                   target, "!");
+            break;
+        case EventType::CoupBlocked:
+            append(out, "General ", actor, " blocked the coup against ", target);
+            break;
+        case EventType::ArrestRefund:
+            append(out, "General ", actor, " got back the coin taken by ", target);
+            break;
+        case EventType::CoupDefensePrepared:
+            append(out, "General ", actor, " prepared to defend ", target, " against a coup");
+            break;
+        case EventType::BribeBlocked:
+            append(out, "Judge ", actor, " blocked the bribe by ", target,
+                   ", making them lose the 4 coins they paid");
+            break;
+        case EventType::JudgeSanctioned:
+            append(out, "Judge ", actor, " was sanctioned by ", target,
+                   ", who had to pay an extra coin as penalty");
+            break;
+        case EventType::MerchantBonus:
+            append(out, "Merchant ", actor, " received an extra coin at the start of their turn");
+            break;
+        case EventType::MerchantArrestFee:
+            append(out, "Merchant ", actor, " paid 2 coins to the treasury when arrested by ", target);
+            break;
+        case EventType::MerchantCannotPay:
+            append(out, "Merchant ", actor, " doesn't have enough coins to pay the arrest fee");
+            break;
+        case EventType::SpiedOn:
+            append(out, "Spy ", actor, " spied on ", target, " and discovered they have ",
+                   std::to_string(event.amount), " coins.");
+            break;
+        case EventType::ArrestBlocked:
+            append(out, "Spy prevents ", target, " from arresting this turn.");
+            break;
+    }
+}
+
+void ConsoleEventSink::onEvent(const Game& game, const Event& event) {
+    thread_local std::string line;
+    line.clear();
+    appendEvent(line, game, event);
+    line += '\n';
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::cout << line;
+}
+
+ConsoleEventSink& ConsoleEventSink::instance() {
+    static ConsoleEventSink sink;
+    return sink;
+}
+
+BufferedEventSink::BufferedEventSink(std::ostream* out, std::size_t capacity)
+    : _out(out), _capacity(capacity) {
+    _buffer.reserve(capacity);
+}
+
+BufferedEventSink::~BufferedEventSink() {
+    if (_out) flush();
+}
+
+void BufferedEventSink::onEvent(const Game& game, const Event& event) {
+    appendEvent(_buffer, game, event);
+    _buffer += '\n';
+    ++_events;
+    if (_out && _buffer.size() >= _capacity) flush();
+}
+
+void BufferedEventSink::flush() {
+    if (_out && !_buffer.empty()) {
+        std::lock_guard<std::mutex> lock(flushMutex);
+        _out->write(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+    }
+    _buffer.clear();
+}
+
+AsyncFileEventSink::AsyncFileEventSink(const std::string& path) : _file(path, std::ios::app) {
+    if (!_file) throw GameException("Cannot open event log: " + path);
+    _writer = std::thread(&AsyncFileEventSink::writerLoop, this);
+}
+
+AsyncFileEventSink::~AsyncFileEventSink() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _wake.notify_one();
+    _writer.join();
+}
+
+void AsyncFileEventSink::onEvent(const Game& game, const Event& event) {
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        appendEvent(_pending, game, event);
+        _pending += '\n';
+        wake = _pending.size() >= ASYNC_WAKE_BYTES;
+    }
+    if (wake) _wake.notify_one();
+}
+
+void AsyncFileEventSink::writerLoop() {
+    std::string chunk;
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _wake.wait_for(lock, std::chrono::milliseconds(100),
+                       [this] { return _stopping || _pending.size() >= ASYNC_WAKE_BYTES; });
+        chunk.swap(_pending);
+        bool stopping = _stopping;
+        lock.unlock();
+        if (!chunk.empty()) {
+            _file.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+            _file.flush();
+            chunk.clear();
+        }
+        if (stopping) return;
+        lock.lock();
+    }
+}
+
+} // namespace coup
@@ -2,34 +2,40 @@
 #include "../include/Game.hpp"
 #include "../include/Player.hpp" // Include Player.hpp before using Player methods
 #include "../include/Exceptions.hpp"
+#include "../include/Spy.hpp"
+#include "../include/Baron.hpp"
+#include "../include/General.hpp"
+#include "../include/Zobrist.hpp"
 #include <algorithm>
-#include <iostream>
 
 namespace coup {
 
-Game::Game() : _currentTurn(0), _bank(100), _gameStarted(false) {}
+Game::Game()
+    : _currentTurn(0), _bank(100), _gameStarted(false), _hash(zobrist::bank(100)),
+      _events(&ConsoleEventSink::instance()) {}
 
 void Game::addPlayer(std::shared_ptr<Player> player) {
     if (_gameStarted) throw GameException("Cannot add player after game has started!");
-    if (_players.size() >= 6) throw TooManyPlayersException();
-    for (const auto& p : _players)
-        if (p->getName() == player->getName())
-            throw PlayerAlreadyInGameException();
+    if (_players.size() >= MAX_PLAYERS) throw TooManyPlayersException();
+    if (_seatByName.count(player->getName())) throw PlayerAlreadyInGameException();
+    _seatByName[player->getName()] = _players.size();
+    player->setSeat(static_cast<int>(_players.size()));
     _players.push_back(player);
-    std::cout << "Added player: " << player->getName() << "\n";
+    _hash = zobrist::hash(snapshot());
+    emit(EventType::PlayerAdded, player->seat());
 }
 
 void Game::removePlayer(const std::string& name) {
-    auto it = std::find_if(_players.begin(), _players.end(), [&](auto& p){ return p->getName() == name; });
-    if (it == _players.end()) throw PlayerNotFoundException();
-    (*it)->setActive(false);
+    getPlayer(name)->setActive(false);
 }
 
 std::shared_ptr<Player> Game::getPlayer(const std::string& name) {
-    for (auto& p : _players)
-        if (p->getName() == name)
-            return p;
-    throw PlayerNotFoundException();
+    return getPlayer(seatOf(name));
+}
+
+std::shared_ptr<Player> Game::getPlayer(int seat) {
+    if (seat < 0 || static_cast<size_t>(seat) >= _players.size()) throw PlayerNotFoundException();
+    return _players[static_cast<size_t>(seat)];
 }
 
 std::shared_ptr<Player> Game::getCurrentPlayer() {
@@ -37,7 +43,7 @@ std::shared_ptr<Player> Game::getCurrentPlayer() {
     return _players.at(static_cast<size_t>(_currentTurn));
 }
 
-std::string Game::turn() const {
+const std::string& Game::turn() const {
     if (_players.empty()) throw GameException("No players in the game!");
     return _players.at(static_cast<size_t>(_currentTurn))->getName();
 }
@@ -71,6 +77,7 @@ void Game::startGame() {
     if (static_cast<size_t>(_currentTurn) >= _players.size()) {
         throw GameException("No active players to start!");
     }
+    _hash = zobrist::hash(snapshot());
 }
 
 bool Game::isGameOver() const {
@@ -78,10 +85,15 @@ bool Game::isGameOver() const {
 }
 
 void Game::nextTurn() {
+    int previous = _currentTurn;
     if (isGameOver()) {
         if (countActivePlayers() == 0) throw GameOverException();
         for (size_t i = 0; i < _players.size(); ++i)
-            if (_players[i]->isActive()) { _currentTurn = static_cast<int>(i); return; }
+            if (_players[i]->isActive()) {
+                _currentTurn = static_cast<int>(i);
+                _hash ^= zobrist::turn(previous) ^ zobrist::turn(_currentTurn);
+                return;
+            }
     }
 
     int count = 0;
@@ -97,68 +109,242 @@ void Game::nextTurn() {
             throw GameException("No active players remaining!");
         }
     } while (!_players[static_cast<size_t>(_currentTurn)]->isActive());
+    _hash ^= zobrist::turn(previous) ^ zobrist::turn(_currentTurn);
     
+    // The new turn closes the window for undoing this player's previous actions
+    expirePendingActions(static_cast<size_t>(_currentTurn));
     _players[static_cast<size_t>(_currentTurn)]->startTurn();
 }
 
+GameState Game::snapshot() const {
+    GameState state{};
+    state.bank = static_cast<std::int16_t>(_bank);
+    state.playerCount = static_cast<std::uint8_t>(_players.size());
+    state.currentTurn = static_cast<std::uint8_t>(_currentTurn);
+    state.started = _gameStarted ? 1 : 0;
+
+    for (size_t i = 0; i < _players.size(); ++i) {
+        const Player& player = *_players[i];
+        SeatState& seat = state.seats[i];
+        seat.coins = static_cast<std::int16_t>(player.coins());
+        seat.role = player.roleId();
+        seat.flags = player.stateFlags();
+        seat.lastArrested = -1;
+        for (size_t j = 0; j < _players.size(); ++j)
+            if (_players[j].get() == player.lastArrested()) seat.lastArrested = static_cast<std::int8_t>(j);
+        seat.spyTarget = -1;
+        if (auto spy = dynamic_cast<const Spy*>(&player))
+            seat.spyTarget = static_cast<std::int8_t>(spy->lastTargetSeatIndex());
+        for (size_t type = 0; type < ACTION_TYPE_COUNT; ++type)
+            if (_journal[i][type].count > 0) seat.pending = static_cast<std::uint16_t>(seat.pending | (1u << type));
+    }
+    return state;
+}
+
+void Game::restore(const GameState& state) {
+    if (state.playerCount != _players.size())
+        throw GameException("Snapshot does not match the players of this game!");
+    for (size_t i = 0; i < _players.size(); ++i)
+        if (state.seats[i].role != _players[i]->roleId())
+            throw GameException("Snapshot does not match the players of this game!");
+
+    _bank = state.bank;
+    _currentTurn = state.currentTurn;
+    _gameStarted = state.started != 0;
+    _actionLog.clear();
+
+    for (size_t i = 0; i < _players.size(); ++i) {
+        Player& player = *_players[i];
+        const SeatState& seat = state.seats[i];
+        player.setCoins(seat.coins);
+        player.setActive(seat.active());
+        player.setSanction(seat.sanctioned());
+        player.setLastArrested(seat.lastArrested >= 0 ? _players[static_cast<size_t>(seat.lastArrested)].get() : nullptr);
+        if (auto spy = dynamic_cast<Spy*>(&player))
+            spy->setLastTarget(seat.spyTarget >= 0 ? _players[static_cast<size_t>(seat.spyTarget)].get() : nullptr);
+
+        expirePendingActions(i);
+        for (size_t type = 0; type < ACTION_TYPE_COUNT; ++type)
+            if (seat.pending & (1u << type))
+                addPendingAction(static_cast<int>(i), static_cast<ActionType>(type));
+    }
+    _hash = zobrist::hash(snapshot());
+}
+
+void Game::legalMoves(int seat, MoveList& moves) const {
+    rules::legalMoves(snapshot(), seat, moves);
+}
+
+MoveStatus Game::checkMove(int seat, const Move& move) const {
+    return rules::check(snapshot(), seat, move);
+}
+
+MoveStatus Game::tryApply(int seat, const Move& move) {
+    GameState before = snapshot();
+    MoveStatus status = rules::check(before, seat, move);
+    if (status != MoveStatus::Ok) return status;
+
+    Player& player = *_players[static_cast<size_t>(seat)];
+    Player* target = isTargeted(move.type) ? _players[static_cast<size_t>(move.target)].get() : nullptr;
+    // rules::check is meant to refuse everything the Player methods throw on
+    // (see the agreement test). Should they still throw, the position is put
+    // back so the move is never left half applied.
+    try {
+        switch (move.type) {
+            case MoveType::Gather: player.gather(); break;
+            case MoveType::Tax: player.tax(); break;
+            case MoveType::Bribe: player.bribe(); break;
+            case MoveType::Arrest: player.arrest(*target); break;
+            case MoveType::Sanction: player.sanction(*target); break;
+            case MoveType::Coup: player.coup(*target); break;
+            case MoveType::Invest: static_cast<Baron&>(player).invest(); break;
+            case MoveType::SpyOn: static_cast<Spy&>(player).spyOn(*target); break;
+            case MoveType::PrepareCoupDefense: static_cast<General&>(player).prepareCoupDefense(*target); break;
+            case MoveType::Undo: player.undo(*target); break;
+        }
+    } catch (const GameException&) {
+        restore(before);
+        return MoveStatus::IllegalMove;
+    }
+    return MoveStatus::Ok;
+}
+
+void Game::setEventSink(EventSink* sink) { _events = sink; }
+EventSink* Game::eventSink() const { return _events; }
+
+const std::string& Game::playerName(int seat) const {
+    static const std::string unknown = "?";
+    if (seat < 0 || static_cast<size_t>(seat) >= _players.size()) return unknown;
+    return _players[static_cast<size_t>(seat)]->getName();
+}
+
+std::uint64_t Game::hash() const { return _hash; }
+void Game::updateHash(std::uint64_t delta) { _hash ^= delta; }
+
 int Game::getBank() const { return _bank; }
 void Game::removeFromBank(int amount) {
     if (_bank < amount) throw GameException("Not enough coins in bank!");
+    _hash ^= zobrist::bank(_bank) ^ zobrist::bank(_bank - amount);
     _bank -= amount;
 }
-void Game::addToBank(int amount) { _bank += amount; }
+void Game::addToBank(int amount) {
+    _hash ^= zobrist::bank(_bank) ^ zobrist::bank(_bank + amount);
+    _bank += amount;
+}
+
+bool Game::isPlayerTurn(int seat) const {
+    return !_players.empty() && seat == _currentTurn;
+}
 
 bool Game::isPlayerTurn(const std::string& name) const {
-    return !_players.empty() && _players[static_cast<size_t>(_currentTurn)]->getName() == name;
+    return isPlayerTurn(seatOf(name));
 }
 
 int Game::countActivePlayers() const {
     return std::count_if(_players.begin(), _players.end(), [](auto& p) { return p->isActive(); });
 }
 
-// Add the missing overloads of addPendingAction
-void Game::addPendingAction(const std::string& playerName, const std::string& actionType) {
-    _pendingActions.push_back({playerName, actionType, nullptr, nullptr});
+int Game::seatOf(const std::string& playerName) const {
+    auto it = _seatByName.find(playerName);
+    return it == _seatByName.end() ? -1 : static_cast<int>(it->second);
 }
 
-void Game::addPendingAction(const std::string& playerName, const std::string& actionType,
-                           std::shared_ptr<Player> target) {
-    _pendingActions.push_back({playerName, actionType, target, nullptr});
+bool Game::isLive(const LogEntry& entry) const {
+    const JournalSlot& slot = _journal[static_cast<size_t>(entry.action.actor)][static_cast<size_t>(entry.action.type)];
+    return slot.count > 0 && slot.generation == entry.generation;
 }
 
-void Game::addPendingAction(const std::string& playerName, const std::string& actionType,
-                            std::shared_ptr<Player> target, std::shared_ptr<Player> victim) {
-    _pendingActions.push_back({playerName, actionType, target, victim});
+void Game::clearSlot(size_t seat, ActionType type) {
+    JournalSlot& slot = _journal[seat][static_cast<size_t>(type)];
+    if (slot.count > 0) _hash ^= zobrist::pending(static_cast<int>(seat), type);
+    slot.first = PendingAction();
+    slot.count = 0;
+    ++slot.generation;
 }
 
-bool Game::hasPendingAction(const std::string& playerName, const std::string& actionType) const {
-    for (const auto& act : _pendingActions)
-        if (act.playerName == playerName && act.actionType == actionType) return true;
-    return false;
+void Game::expirePendingActions(size_t seat) {
+    for (size_t type = 0; type < ACTION_TYPE_COUNT; ++type)
+        if (_journal[seat][type].count > 0) clearSlot(seat, static_cast<ActionType>(type));
 }
 
-void Game::clearPendingAction(const std::string& playerName, const std::string& actionType) {
-    _pendingActions.erase(
-        std::remove_if(_pendingActions.begin(), _pendingActions.end(),
-            [&](const auto& a) { return a.playerName == playerName && a.actionType == actionType; }),
-        _pendingActions.end());
+void Game::addPendingAction(int seat, ActionType type, int target, int victim) {
+    if (seat < 0 || static_cast<size_t>(seat) >= _players.size()) throw PlayerNotFoundException();
+    JournalSlot& slot = _journal[static_cast<size_t>(seat)][static_cast<size_t>(type)];
+    PendingAction action(seat, type, target, victim);
+    if (slot.count == 0) {
+        slot.first = action;
+        _hash ^= zobrist::pending(seat, type);
+    }
+    ++slot.count;
+    _actionLog.push({action, slot.generation});
+}
+
+void Game::addPendingAction(const std::string& playerName, ActionType type, int target, int victim) {
+    int seat = seatOf(playerName);
+    if (seat < 0) throw PlayerNotFoundException();
+    addPendingAction(seat, type, target, victim);
+}
+
+bool Game::hasPendingAction(int seat, ActionType type) const {
+    return seat >= 0 && static_cast<size_t>(seat) < _players.size() &&
+           _journal[static_cast<size_t>(seat)][static_cast<size_t>(type)].count > 0;
+}
+
+bool Game::hasPendingAction(const std::string& playerName, ActionType type) const {
+    return hasPendingAction(seatOf(playerName), type);
+}
+
+void Game::clearPendingAction(int seat, ActionType type) {
+    if (seat < 0 || static_cast<size_t>(seat) >= _players.size()) return;
+    clearSlot(static_cast<size_t>(seat), type);
+}
+
+void Game::clearPendingAction(const std::string& playerName, ActionType type) {
+    clearPendingAction(seatOf(playerName), type);
+}
+
+Game::PendingAction Game::getPendingAction(const std::string& playerName, ActionType type) const {
+    int seat = seatOf(playerName);
+    if (seat >= 0) {
+        const JournalSlot& slot = _journal[static_cast<size_t>(seat)][static_cast<size_t>(type)];
+        if (slot.count > 0) return slot.first;
+    }
+    throw GameException("No such pending action");
 }
 
 void Game::clearAllPendingActions(const std::string& playerName) {
-    _pendingActions.erase(
-        std::remove_if(_pendingActions.begin(), _pendingActions.end(),
-            [&](const auto& a) { return a.playerName == playerName; }),
-        _pendingActions.end());
+    for (size_t type = 0; type < ACTION_TYPE_COUNT; ++type)
+        clearPendingAction(playerName, static_cast<ActionType>(type));
 }
 
 std::vector<Game::PendingAction> Game::getPendingActions() const {
-    return _pendingActions;
+    std::vector<PendingAction> result;
+    for (size_t i = 0; i < _actionLog.size(); ++i)
+        if (isLive(_actionLog[i])) result.push_back(_actionLog[i].action);
+    return result;
+}
+
+void Game::addPendingAction(const std::string& playerName, const std::string& actionType,
+                            int target, int victim) {
+    ActionType type;
+    if (!parseActionType(actionType, type)) throw GameException("Unknown action type: " + actionType);
+    addPendingAction(playerName, type, target, victim);
+}
+
+bool Game::hasPendingAction(const std::string& playerName, const std::string& actionType) const {
+    ActionType type;
+    return parseActionType(actionType, type) && hasPendingAction(playerName, type);
+}
+
+void Game::clearPendingAction(const std::string& playerName, const std::string& actionType) {
+    ActionType type;
+    if (parseActionType(actionType, type)) clearPendingAction(playerName, type);
 }
 
 Game::PendingAction Game::getPendingAction(const std::string& playerName, const std::string& actionType) const {
-    for (const auto& act : _pendingActions)
-        if (act.playerName == playerName && act.actionType == actionType) return act;
-    throw GameException("No such pending action");
+    ActionType type;
+    if (!parseActionType(actionType, type)) throw GameException("No such pending action");
+    return getPendingAction(playerName, type);
 }
 
 } // namespace coup
\ No newline at end of file
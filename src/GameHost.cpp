@@ -0,0 +1,299 @@
+//tomergal40@gmail.com
+#include "../include/GameHost.hpp"
+#include "../include/Exceptions.hpp"
+#include "../include/Simulator.hpp"
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace coup {
+
+namespace {
+
+unsigned poolThreads(const GameHostConfig& config) {
+    return config.threads ? config.threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+} // namespace
+
+GameHost::GameHost(GameHostConfig config)
+    : _shardCount(config.shards ? config.shards : 8 * poolThreads(config)),
+      _shards(std::make_unique<Shard[]>(_shardCount)),
+      _pool(poolThreads(config), [this](std::uint32_t shard) { runShard(shard); }) {}
+
+GameHost::~GameHost() {
+    // Drained, so every reaction queue is empty
+    drain();
+}
+
+GameId GameHost::createGame(const std::vector<RoleId>& roles, GameCallback ready) {
+    if (roles.size() == 1 || roles.size() > MAX_PLAYERS) throw GameException("A hosted game needs 2 to 6 roles (or none)!");
+    for (RoleId role : roles)
+        if (static_cast<std::size_t>(role) >= PLAYABLE_ROLE_COUNT) throw GameException("Hosted games need playable roles!");
+    GameId id = _nextGame.load(std::memory_order_relaxed);
+    do {
+        if (id == std::numeric_limits<GameId>::max()) throw GameException("Too many hosted games!");
+    } while (!_nextGame.compare_exchange_weak(id, id + 1, std::memory_order_relaxed));
+
+    Command command;
+    command.kind = CommandKind::Create;
+    command.game = id;
+    command.players = static_cast<std::uint8_t>(roles.size());
+    std::copy(roles.begin(), roles.end(), command.roles.begin());
+    command.done = std::move(ready);
+    enqueue(std::move(command));
+    return id;
+}
+
+void GameHost::submit(GameId game, int seat, const Move& move, GameCallback done) {
+    Command command;
+    command.kind = CommandKind::Move;
+    command.game = game;
+    command.seat = seat;
+    command.move = move;
+    command.done = std::move(done);
+    enqueue(std::move(command));
+}
+
+void GameHost::react(GameId game, int seat, const Move& move, GameCallback done, MissingCallback missing) {
+    Shard& shard = _shards[shardOf(game)];
+    Reaction* reaction = new Reaction;
+    reaction->game = game;
+    reaction->seat = seat;
+    reaction->move = move;
+    reaction->done = std::move(done);
+    reaction->missing = std::move(missing);
+    reaction->after = shard.submitted.load(std::memory_order_acquire);
+    _pending.fetch_add(1, std::memory_order_relaxed);
+    shard.reactions.push(reaction);
+
+    // Only the first reaction of a burst goes through the shard's inbox
+    if (!shard.armed.exchange(true, std::memory_order_acq_rel)) {
+        Command command;
+        command.kind = CommandKind::React;
+        command.game = game;
+        enqueue(std::move(command));
+    }
+}
+
+void GameHost::post(GameId game, GameCallback task, MissingCallback missing) {
+    if (!task) throw GameException("Cannot post an empty task!");
+    Command command;
+    command.kind = CommandKind::Task;
+    command.game = game;
+    command.done = std::move(task);
+    command.missing = std::move(missing);
+    enqueue(std::move(command));
+}
+
+void GameHost::closeGame(GameId game) {
+    Command command;
+    command.kind = CommandKind::Close;
+    command.game = game;
+    enqueue(std::move(command));
+}
+
+void GameHost::onClose(GameId game, const void* owner, std::function<void()> hook) {
+    _shards[shardOf(game)].closeHooks.emplace(game, CloseHook{owner, std::move(hook)});
+}
+
+void GameHost::forgetClose(GameId game, const void* owner) {
+    Shard& shard = _shards[shardOf(game)];
+    auto range = shard.closeHooks.equal_range(game);
+    for (auto it = range.first; it != range.second;) {
+        if (it->second.owner == owner) it = shard.closeHooks.erase(it);
+        else ++it;
+    }
+}
+
+void GameHost::postToShard(unsigned shard, std::function<void()> task) {
+    if (shard >= _shardCount) throw GameException("No such shard!");
+    if (!task) throw GameException("Cannot post an empty task!");
+    Command command;
+    command.kind = CommandKind::Shard;
+    command.game = shard;
+    command.shardTask = std::move(task);
+    enqueue(std::move(command));
+}
+
+void GameHost::enqueue(Command command) {
+    unsigned index = shardOf(command.game);
+    Shard& shard = _shards[index];
+    _pending.fetch_add(1, std::memory_order_relaxed);
+    bool schedule;
+    {
+        std::lock_guard<std::mutex> lock(shard.inboxMutex);
+        shard.inbox.push_back(std::move(command));
+        shard.submitted.store(shard.submitted.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        schedule = !shard.scheduled;
+        shard.scheduled = true;
+    }
+    if (schedule) _pool.push(index);
+}
+
+void GameHost::runShard(std::uint32_t index) {
+    Shard& shard = _shards[index];
+    {
+        std::lock_guard<std::mutex> lock(shard.inboxMutex);
+        shard.running.swap(shard.inbox);
+    }
+    // Reactions are let through between the commands submitted before and
+    // after them
+    for (Command& command : shard.running) {
+        runReactions(shard);
+        execute(shard, command);
+        ++shard.executed;
+    }
+    runReactions(shard);
+    std::size_t ran = shard.running.size() + shard.consumed;
+    shard.running.clear();
+    shard.consumed = 0;
+
+    // Commands queued meanwhile go back to the pool as a new job instead of
+    // being run here, so one busy shard cannot keep a thread to itself
+    bool again;
+    {
+        std::lock_guard<std::mutex> lock(shard.inboxMutex);
+        again = !shard.inbox.empty();
+        shard.scheduled = again;
+    }
+    if (again) _pool.push(index);
+
+    if (_pending.fetch_sub(ran, std::memory_order_acq_rel) == ran) {
+        std::lock_guard<std::mutex> lock(_drainMutex);
+        _drained.notify_all();
+    }
+}
+
+void GameHost::execute(Shard& shard, Command& command) {
+    if (command.kind == CommandKind::Shard) {
+        try {
+            command.shardTask();
+        } catch (...) {
+            _failed.fetch_add(1, std::memory_order_relaxed);
+        }
+        return;
+    }
+    if (command.kind == CommandKind::Create) {
+        auto game = std::make_unique<Game>();
+        game->setEventSink(nullptr);
+        for (int seat = 0; seat < command.players; ++seat)
+            game->addPlayer(createPlayer(*game, toString(command.roles[static_cast<std::size_t>(seat)]), "P" + std::to_string(seat)));
+        if (command.players > 0) game->startGame();
+        Game& created = *game;
+        shard.games[command.game] = std::move(game);
+        _liveGames.fetch_add(1, std::memory_order_relaxed);
+        invoke(command.done, created, MoveStatus::Ok);
+        return;
+    }
+    if (command.kind == CommandKind::React) {
+        // Disarm before draining: a reaction pushed from now on schedules
+        // another React command, so none is left behind by a half done push
+        shard.armed.exchange(false, std::memory_order_acq_rel);
+        runReactions(shard);
+        return;
+    }
+
+    Game* game = find(shard, command.game);
+    if (!game) {
+        drop(command.missing);
+        return;
+    }
+    switch (command.kind) {
+        case CommandKind::Move: {
+            MoveStatus status = game->tryApply(command.seat, command.move);
+            if (status == MoveStatus::Ok) shard.moves.fetch_add(1, std::memory_order_relaxed);
+            invoke(command.done, *game, status);
+            break;
+        }
+        case CommandKind::Task:
+            invoke(command.done, *game, MoveStatus::Ok);
+            break;
+        case CommandKind::Close: {
+            auto range = shard.closeHooks.equal_range(command.game);
+            std::vector<CloseHook> hooks;
+            for (auto it = range.first; it != range.second; ++it) hooks.push_back(std::move(it->second));
+            shard.closeHooks.erase(range.first, range.second);
+            for (CloseHook& hook : hooks) {
+                try {
+                    hook.hook();
+                } catch (...) {
+                    _failed.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            shard.games.erase(command.game);
+            _liveGames.fetch_sub(1, std::memory_order_relaxed);
+            break;
+        }
+        case CommandKind::Create:
+        case CommandKind::React:
+        case CommandKind::Shard:
+            break;
+    }
+}
+
+Game* GameHost::find(Shard& shard, GameId game) {
+    auto found = shard.games.find(game);
+    return found != shard.games.end() ? found->second.get() : nullptr;
+}
+
+void GameHost::runReactions(Shard& shard) {
+    for (;;) {
+        if (!shard.held) {
+            MpscNode* node = shard.reactions.pop();
+            if (!node) {
+                if (shard.reactions.empty()) return;
+                // A producer is between its exchange and its link: wait for
+                // it rather than let a later command overtake its reaction
+                std::this_thread::yield();
+                continue;
+            }
+            shard.held = static_cast<Reaction*>(node);
+        }
+        if (shard.held->after > shard.executed) return;
+        std::unique_ptr<Reaction> reaction(std::exchange(shard.held, nullptr));
+        ++shard.consumed;
+        Game* game = find(shard, reaction->game);
+        if (!game) {
+            drop(reaction->missing);
+            continue;
+        }
+        MoveStatus status = game->tryApply(reaction->seat, reaction->move);
+        if (status == MoveStatus::Ok) shard.moves.fetch_add(1, std::memory_order_relaxed);
+        invoke(reaction->done, *game, status);
+    }
+}
+
+void GameHost::invoke(const GameCallback& callback, Game& game, MoveStatus status) {
+    if (!callback) return;
+    try {
+        callback(game, status);
+    } catch (...) {
+        _failed.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void GameHost::drop(const MissingCallback& missing) {
+    _dropped.fetch_add(1, std::memory_order_relaxed);
+    if (!missing) return;
+    try {
+        missing();
+    } catch (...) {
+        _failed.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void GameHost::drain() {
+    std::unique_lock<std::mutex> lock(_drainMutex);
+    _drained.wait(lock, [this] { return _pending.load(std::memory_order_acquire) == 0; });
+}
+
+std::uint64_t GameHost::movesPlayed() const {
+    std::uint64_t moves = 0;
+    for (unsigned s = 0; s < _shardCount; ++s) moves += _shards[s].moves.load(std::memory_order_relaxed);
+    return moves;
+}
+
+} // namespace coup
@@ -0,0 +1,358 @@
+//tomergal40@gmail.com
+#include "../include/GameState.hpp"
+
+namespace coup {
+
+const char* toString(MoveStatus status) {
+    switch (status) {
+        case MoveStatus::Ok: return "ok";
+        case MoveStatus::NotYourTurn: return "not your turn";
+        case MoveStatus::NotEnoughCoins: return "not enough coins";
+        case MoveStatus::MustCoup: return "must coup with 10+ coins";
+        case MoveStatus::Sanctioned: return "player is under sanction";
+        case MoveStatus::TargetNotActive: return "target is not active";
+        case MoveStatus::InvalidTarget: return "invalid target";
+        case MoveStatus::RepeatedArrest: return "cannot arrest the same player twice in a row";
+        case MoveStatus::WrongRole: return "role cannot perform this move";
+        case MoveStatus::BankEmpty: return "not enough coins in bank";
+        case MoveStatus::IllegalMove: return "illegal move";
+    }
+    return "unknown";
+}
+
+namespace rules {
+
+namespace {
+
+void setPending(SeatState& seat, ActionType type) {
+    seat.pending = static_cast<std::uint16_t>(seat.pending | (1u << static_cast<unsigned>(type)));
+}
+
+void clearPending(SeatState& seat, ActionType type) {
+    seat.pending = static_cast<std::uint16_t>(seat.pending & ~(1u << static_cast<unsigned>(type)));
+}
+
+void setSanction(SeatState& seat, bool sanctioned) {
+    if (sanctioned)
+        seat.flags = static_cast<std::uint8_t>((seat.flags | SEAT_SANCTIONED) & ~(SEAT_CAN_GATHER | SEAT_CAN_TAX));
+    else
+        seat.flags = static_cast<std::uint8_t>((seat.flags & ~SEAT_SANCTIONED) | SEAT_CAN_GATHER | SEAT_CAN_TAX);
+}
+
+bool isTurnOf(const GameState& state, int seat) {
+    return state.playerCount > 0 && state.currentTurn == seat;
+}
+
+// Player::onArrested and the General / Merchant overrides
+void onArrested(GameState& state, SeatState& target, SeatState& by) {
+    switch (target.role) {
+        case RoleId::General:
+            // Loses the coin to the arrester and gets it straight back
+            if (target.coins < 1) return;
+            by.coins += 1;
+            return;
+        case RoleId::Merchant:
+            if (target.coins >= 2) {
+                target.coins -= 2;
+                state.bank += 2;
+            }
+            return;
+        default:
+            if (target.coins < 1) return;
+            target.coins -= 1;
+            by.coins += 1;
+            return;
+    }
+}
+
+// Player::onSanctioned and the Baron / Judge overrides
+void onSanctioned(GameState& state, SeatState& target, SeatState& by) {
+    setSanction(target, true);
+    if (target.role == RoleId::Baron) {
+        target.coins += 1;
+        state.bank -= 1;
+        setPending(target, ActionType::Compensation);
+    } else if (target.role == RoleId::Judge) {
+        by.coins -= 1;
+        state.bank += 1;
+    }
+}
+
+MoveStatus checkUndo(const GameState& state, const SeatState& self, int target) {
+    const SeatState& victim = state.seat(target);
+    switch (self.role) {
+        case RoleId::Governor:
+            if (victim.hasPending(ActionType::Tax)) {
+                int amount = victim.role == RoleId::Governor ? 3 : 2;
+                return victim.coins < amount ? MoveStatus::NotEnoughCoins : MoveStatus::Ok;
+            }
+            return MoveStatus::IllegalMove;
+        case RoleId::Judge:
+            return victim.hasPending(ActionType::Bribe) ? MoveStatus::Ok : MoveStatus::IllegalMove;
+        case RoleId::General:
+            if (!victim.hasPending(ActionType::Coup)) return MoveStatus::IllegalMove;
+            return self.coins < 5 ? MoveStatus::NotEnoughCoins : MoveStatus::Ok;
+        case RoleId::Spy:
+            return self.spyTarget == target ? MoveStatus::Ok : MoveStatus::IllegalMove;
+        default:
+            return MoveStatus::IllegalMove;
+    }
+}
+
+void applyUndo(GameState& state, SeatState& self, int target) {
+    SeatState& victim = state.seat(target);
+    switch (self.role) {
+        case RoleId::Governor: {
+            int amount = victim.role == RoleId::Governor ? 3 : 2;
+            victim.coins -= amount;
+            state.bank += amount;
+            clearPending(victim, ActionType::Tax);
+            break;
+        }
+        case RoleId::Judge:
+            clearPending(victim, ActionType::Bribe);
+            break;
+        case RoleId::General:
+            self.coins -= 5;
+            state.bank += 5;
+            victim.flags |= SEAT_ACTIVE;
+            clearPending(victim, ActionType::Coup);
+            break;
+        case RoleId::Spy:
+            clearPending(self, ActionType::BlockArrest);
+            break;
+        default:
+            break;
+    }
+}
+
+} // namespace
+
+GameState initialState(const RoleId* roles, int playerCount) {
+    GameState state{};
+    state.bank = 100;
+    state.playerCount = static_cast<std::uint8_t>(playerCount);
+    state.currentTurn = 0;
+    state.started = 1;
+    for (int i = 0; i < playerCount; ++i) {
+        SeatState& seat = state.seat(i);
+        seat.role = roles[i];
+        seat.flags = SEAT_ACTIVE | SEAT_CAN_GATHER | SEAT_CAN_TAX;
+        seat.lastArrested = -1;
+        seat.spyTarget = -1;
+    }
+    return state;
+}
+
+MoveStatus check(const GameState& state, int seat, const Move& move) {
+    if (seat < 0 || seat >= state.playerCount) return MoveStatus::IllegalMove;
+    if (isTargeted(move.type) && (move.target < 0 || move.target >= state.playerCount))
+        return MoveStatus::InvalidTarget;
+
+    const SeatState& self = state.seat(seat);
+    bool myTurn = isTurnOf(state, seat);
+
+    switch (move.type) {
+        case MoveType::Gather:
+        case MoveType::Tax: {
+            bool gather = move.type == MoveType::Gather;
+            if (!myTurn) return MoveStatus::NotYourTurn;
+            if (self.sanctioned()) return MoveStatus::Sanctioned;
+            if (!(self.flags & (gather ? SEAT_CAN_GATHER : SEAT_CAN_TAX))) return MoveStatus::IllegalMove;
+            if (self.mustCoup()) return MoveStatus::MustCoup;
+            int amount = gather ? 1 : (self.role == RoleId::Governor ? 3 : 2);
+            if (state.bank < amount) return MoveStatus::BankEmpty;
+            return MoveStatus::Ok;
+        }
+        case MoveType::Bribe: {
+            if (!myTurn) return MoveStatus::NotYourTurn;
+            int cost = self.role == RoleId::Baron ? 3 : 4;
+            if (self.coins < cost) return MoveStatus::NotEnoughCoins;
+            if (self.mustCoup()) return MoveStatus::MustCoup;
+            return MoveStatus::Ok;
+        }
+        case MoveType::Arrest: {
+            const SeatState& target = state.seat(move.target);
+            bool outOfTurnSpyArrest = self.role == RoleId::Spy && target.role == RoleId::Merchant;
+            if (!outOfTurnSpyArrest && !myTurn) return MoveStatus::NotYourTurn;
+            if (self.mustCoup()) return MoveStatus::MustCoup;
+            if (!target.active()) return MoveStatus::TargetNotActive;
+            if (self.lastArrested == move.target) return MoveStatus::RepeatedArrest;
+            return MoveStatus::Ok;
+        }
+        case MoveType::Sanction: {
+            const SeatState& target = state.seat(move.target);
+            if (!myTurn) return MoveStatus::NotYourTurn;
+            if (self.coins < 3) return MoveStatus::NotEnoughCoins;
+            if (self.mustCoup()) return MoveStatus::MustCoup;
+            if (!target.active()) return MoveStatus::TargetNotActive;
+            // Sanctioning a Judge costs an extra coin. Player::sanction only
+            // notices this after paying the first 3; here it is refused upfront.
+            if (target.role == RoleId::Judge && self.coins < 4) return MoveStatus::NotEnoughCoins;
+            // A Baron's compensation coin comes out of the 3 just paid in, so
+            // the bank can always cover it
+            return MoveStatus::Ok;
+        }
+        case MoveType::Coup:
+            if (!myTurn) return MoveStatus::NotYourTurn;
+            if (self.coins < 7) return MoveStatus::NotEnoughCoins;
+            if (!state.seat(move.target).active()) return MoveStatus::TargetNotActive;
+            return MoveStatus::Ok;
+        case MoveType::Invest:
+            if (self.role != RoleId::Baron) return MoveStatus::WrongRole;
+            if (!myTurn) return MoveStatus::NotYourTurn;
+            if (self.coins < 3) return MoveStatus::NotEnoughCoins;
+            if (self.mustCoup()) return MoveStatus::MustCoup;
+            if (state.bank + 3 < 6) return MoveStatus::BankEmpty;
+            return MoveStatus::Ok;
+        case MoveType::SpyOn:
+            return self.role == RoleId::Spy ? MoveStatus::Ok : MoveStatus::WrongRole;
+        case MoveType::PrepareCoupDefense:
+            if (self.role != RoleId::General) return MoveStatus::WrongRole;
+            return self.coins < 5 ? MoveStatus::NotEnoughCoins : MoveStatus::Ok;
+        case MoveType::Undo:
+            return checkUndo(state, self, move.target);
+    }
+    return MoveStatus::IllegalMove;
+}
+
+void legalMoves(const GameState& state, int seat, MoveList& moves) {
+    moves.clear();
+    if (seat < 0 || seat >= state.playerCount || !state.seat(seat).active()) return;
+
+    const MoveType untargeted[] = {MoveType::Gather, MoveType::Tax, MoveType::Bribe, MoveType::Invest};
+    for (MoveType type : untargeted) {
+        Move move{type, -1};
+        if (check(state, seat, move) == MoveStatus::Ok) moves.push(move);
+    }
+
+    const MoveType targeted[] = {MoveType::Arrest, MoveType::Sanction, MoveType::Coup,
+                                 MoveType::SpyOn, MoveType::PrepareCoupDefense, MoveType::Undo};
+    for (MoveType type : targeted) {
+        if (type == MoveType::SpyOn && state.seat(seat).hasPending(ActionType::BlockArrest)) continue;
+        for (int target = 0; target < state.playerCount; ++target) {
+            if (target == seat && type != MoveType::PrepareCoupDefense) continue;
+            Move move{type, target};
+            if (check(state, seat, move) == MoveStatus::Ok) moves.push(move);
+        }
+    }
+}
+
+MoveStatus apply(GameState& state, int seat, const Move& move) {
+    MoveStatus status = check(state, seat, move);
+    if (status != MoveStatus::Ok) return status;
+
+    SeatState& self = state.seat(seat);
+    switch (move.type) {
+        case MoveType::Gather:
+            state.bank -= 1;
+            self.coins += 1;
+            setPending(self, ActionType::Gather);
+            nextTurn(state);
+            break;
+        case MoveType::Tax: {
+            int amount = self.role == RoleId::Governor ? 3 : 2;
+            state.bank -= amount;
+            self.coins += amount;
+            setPending(self, ActionType::Tax);
+            nextTurn(state);
+            break;
+        }
+        case MoveType::Bribe: {
+            int cost = self.role == RoleId::Baron ? 3 : 4;
+            self.coins -= cost;
+            state.bank += cost;
+            setPending(self, ActionType::Bribe);
+            break;
+        }
+        case MoveType::Arrest: {
+            SeatState& target = state.seat(move.target);
+            bool outOfTurnSpyArrest = self.role == RoleId::Spy && target.role == RoleId::Merchant;
+            setPending(self, ActionType::Arrest);
+            self.lastArrested = static_cast<std::int8_t>(move.target);
+            onArrested(state, target, self);
+            if (!outOfTurnSpyArrest) nextTurn(state);
+            break;
+        }
+        case MoveType::Sanction:
+            self.coins -= 3;
+            state.bank += 3;
+            setPending(self, ActionType::Sanction);
+            onSanctioned(state, state.seat(move.target), self);
+            nextTurn(state);
+            break;
+        case MoveType::Coup:
+            self.coins -= 7;
+            state.bank += 7;
+            setPending(self, ActionType::Coup);
+            state.seat(move.target).flags &= static_cast<std::uint8_t>(~SEAT_ACTIVE);
+            nextTurn(state);
+            break;
+        case MoveType::Invest:
+            self.coins += 3;
+            state.bank -= 3;
+            setPending(self, ActionType::Invest);
+            nextTurn(state);
+            break;
+        case MoveType::SpyOn:
+            self.spyTarget = static_cast<std::int8_t>(move.target);
+            setPending(self, ActionType::BlockArrest);
+            break;
+        case MoveType::PrepareCoupDefense:
+            self.coins -= 5;
+            state.bank += 5;
+            setPending(self, ActionType::BlockCoup);
+            break;
+        case MoveType::Undo:
+            applyUndo(state, self, move.target);
+            break;
+    }
+    return MoveStatus::Ok;
+}
+
+void nextTurn(GameState& state) {
+    if (isGameOver(state)) {
+        for (int i = 0; i < state.playerCount; ++i) {
+            if (state.seat(i).active()) {
+                state.currentTurn = static_cast<std::uint8_t>(i);
+                return;
+            }
+        }
+        return;
+    }
+
+    do {
+        state.currentTurn = static_cast<std::uint8_t>((state.currentTurn + 1) % state.playerCount);
+    } while (!state.seat(state.currentTurn).active());
+
+    // Same effects as Game::nextTurn: expire pending actions, then Player::startTurn
+    SeatState& current = state.seat(state.currentTurn);
+    current.pending = 0;
+    if (current.sanctioned()) setSanction(current, false);
+    if (current.role == RoleId::Merchant && current.coins >= 3 && state.bank >= 1) {
+        current.coins += 1;
+        state.bank -= 1;
+    }
+}
+
+int countActive(const GameState& state) {
+    int count = 0;
+    for (int i = 0; i < state.playerCount; ++i)
+        if (state.seat(i).active()) ++count;
+    return count;
+}
+
+bool isGameOver(const GameState& state) {
+    return countActive(state) <= 1;
+}
+
+int winner(const GameState& state) {
+    if (countActive(state) != 1) return -1;
+    for (int i = 0; i < state.playerCount; ++i)
+        if (state.seat(i).active()) return i;
+    return -1;
+}
+
+} // namespace rules
+
+} // namespace coup
@@ -2,16 +2,15 @@
 #include "../include/General.hpp"
 #include "../include/Game.hpp"
 #include "../include/Exceptions.hpp"
-#include <iostream>
 
 namespace coup {
 
 General::General(Game& game, const std::string& name)
-    : Player(game, name) {}
+    : Player(game, name, RoleId::General) {}
 
 void General::undo(Player& target) {
     // Check if there's a pending coup on the target
-    if (!_game->hasPendingAction(target.getName(), "coup")) {
+    if (!_game->hasPendingAction(target.seat(), ActionType::Coup)) {
         throw IllegalMoveException("No coup action to undo!");
     }
     
@@ -21,16 +20,16 @@ void General::undo(Player& target) {
     }
     
     // Pay 5 coins to bank
-    _coins -= 5;
+    removeCoins(5);
     _game->addToBank(5);
     
     // Reactivate the player if they were eliminated by coup
     target.setActive(true);
     
     // Clear the pending coup action
-    _game->clearPendingAction(target.getName(), "coup");
+    _game->clearPendingAction(target.seat(), ActionType::Coup);
     
-    std::cout << "General " << _name << " blocked the coup against " << target.getName() << std::endl;
+    _game->emit(EventType::CoupBlocked, _seat, target.seat());
 }
 
 void General::onArrested(Player& by) {
@@ -39,11 +38,11 @@ void General::onArrested(Player& by) {
         return; // No coins to take
     }
     
-    _coins -= 1;
+    removeCoins(1);
     by.addCoins(1);
     addCoins(1); // Refund to self
     
-    std::cout << "General " << _name << " got back the coin taken by " << by.getName() << std::endl;
+    _game->emit(EventType::ArrestRefund, _seat, by.seat());
 }
 
 void General::prepareCoupDefense(Player& target) {
@@ -53,13 +52,13 @@ void General::prepareCoupDefense(Player& target) {
     }
     
     // Pay 5 coins to bank
-    _coins -= 5;
+    removeCoins(5);
     _game->addToBank(5);
     
     // Create a pending block_coup action
-    _game->addPendingAction(_name, "block_coup", createSafePtr(&target), nullptr);
+    _game->addPendingAction(_seat, ActionType::BlockCoup, target.seat());
     
-    std::cout << "General " << _name << " prepared to defend " << target.getName() << " against a coup" << std::endl;
+    _game->emit(EventType::CoupDefensePrepared, _seat, target.seat());
 }
 
 } // namespace coup
\ No newline at end of file
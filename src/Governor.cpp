@@ -2,16 +2,15 @@
 #include "../include/Governor.hpp"
 #include "../include/Game.hpp"
 #include "../include/Exceptions.hpp"
-#include <iostream>
 
 namespace coup {
 
 Governor::Governor(Game& game, const std::string& name)
-    : Player(game, name) {}
+    : Player(game, name, RoleId::Governor) {}
 
 void Governor::tax() {
     // Check if it's the Governor's turn
-    if (!_game->isPlayerTurn(_name)) {
+    if (!_game->isPlayerTurn(_seat)) {
         throw NotYourTurnException();
     }
     
@@ -32,25 +31,24 @@ void Governor::tax() {
     
     // Special Governor ability: take 3 coins instead of 2
     _game->removeFromBank(3);
-    _coins += 3;
+    addCoins(3);
     
     // Add a pending action to track this tax collection
-    // FIX HERE: Changed *game->addPendingAction(*name, ...) to _game->addPendingAction(_name, ...)
-    _game->addPendingAction(_name, "tax", createSafePtr(this), nullptr);
+    _game->addPendingAction(_seat, ActionType::Tax, _seat);
     
     // End the Governor's turn
     _game->nextTurn();
     
-    std::cout << "Governor " << _name << " collected 3 coins in tax" << std::endl;
+    _game->emit(EventType::GovernorTax, _seat);
 }
 
 void Governor::undo(Player& target) {
     // Check if the target has a pending tax action
-    if (_game->hasPendingAction(target.getName(), "tax") && canUndoTax()) {
+    if (_game->hasPendingAction(target.seat(), ActionType::Tax) && canUndoTax()) {
         // Governor can undo tax actions
         
         // For Governor's tax (3 coins)
-        if (target.role() == "Governor") {
+        if (target.roleId() == RoleId::Governor) {
             target.removeCoins(3);
             _game->addToBank(3);
         }
@@ -61,9 +59,9 @@ void Governor::undo(Player& target) {
         }
         
         // Clear the pending tax action
-        _game->clearPendingAction(target.getName(), "tax");
+        _game->clearPendingAction(target.seat(), ActionType::Tax);
         
-        std::cout << "Governor " << _name << " undid the tax collection by " << target.getName() << std::endl;
+        _game->emit(EventType::TaxUndone, _seat, target.seat());
     }
     // Try the base class implementation for other types of actions
     else {
@@ -0,0 +1,212 @@
+//tomergal40@gmail.com
+#include "../include/Ismcts.hpp"
+#include "../include/Exceptions.hpp"
+#include "../include/Playout.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <thread>
+
+namespace coup {
+
+namespace {
+
+// Tree node; children form a singly linked list so the tree lives in one vector
+struct Node {
+    Move move;                   // Move that led here
+    int mover = -1;              // Seat that played it
+    int parent = -1;
+    int firstChild = -1;
+    int sibling = -1;
+    std::uint32_t visits = 0;
+    std::uint32_t available = 0; // Iterations in which this move was legal at its parent
+    double reward = 0.0;         // Sum of the mover's rewards
+};
+
+int findChild(const std::vector<Node>& nodes, int node, int mover, const Move& move) {
+    for (int child = nodes[static_cast<size_t>(node)].firstChild; child >= 0; child = nodes[static_cast<size_t>(child)].sibling) {
+        const Node& candidate = nodes[static_cast<size_t>(child)];
+        if (candidate.mover == mover && candidate.move == move) return child;
+    }
+    return -1;
+}
+
+// Grows one tree on the calling thread and returns its root statistics
+std::vector<MoveStats> searchTree(const GameState& root, int seat, const IsmctsConfig& config,
+                                  const Determinizer& determinizer, std::mt19937_64& rng,
+                                  std::uint64_t& playouts) {
+    const SearchBudget& budget = config.budget;
+    std::vector<Node> nodes;
+    nodes.reserve(static_cast<size_t>(std::min<std::uint64_t>(budget.iterations ? budget.iterations + 1 : 1 << 16, 1 << 20)));
+    nodes.emplace_back();
+
+    auto start = std::chrono::steady_clock::now();
+    MoveList legal;
+    double rewards[STATE_MAX_SEATS];
+    for (std::uint64_t iteration = 0;; ++iteration) {
+        if (budget.iterations && iteration >= budget.iterations) break;
+        if (budget.seconds > 0.0 && iteration % 64 == 0 &&
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= budget.seconds)
+            break;
+
+        GameState state = root;
+        determinizer.determinize(state, seat, rng);
+        int node = 0;
+        int plies = 0;
+        int turnActions = 0;
+        bool inTree = true;
+
+        while (!rules::isGameOver(state) && plies < config.maxPlies) {
+            int mover = state.currentTurn;
+            rules::legalMoves(state, mover, legal);
+            ++plies;
+            if (legal.empty()) {
+                rules::nextTurn(state);
+                turnActions = 0;
+                continue;
+            }
+            if (!inTree) {
+                advance(state, legal[static_cast<size_t>(randomBelow(rng, static_cast<int>(legal.size())))], turnActions);
+                continue;
+            }
+
+            // Selection among the moves legal in this determinization; the
+            // first untried one is expanded and ends the tree walk
+            Move untried[MAX_MOVES];
+            int untriedCount = 0;
+            int best = -1;
+            double bestValue = -1.0;
+            for (const Move& move : legal) {
+                int child = findChild(nodes, node, mover, move);
+                if (child < 0) {
+                    untried[untriedCount++] = move;
+                    continue;
+                }
+                Node& candidate = nodes[static_cast<size_t>(child)];
+                ++candidate.available;
+                double value = candidate.reward / candidate.visits +
+                               config.exploration * std::sqrt(std::log(static_cast<double>(candidate.available)) / candidate.visits);
+                if (value > bestValue) {
+                    bestValue = value;
+                    best = child;
+                }
+            }
+            if (untriedCount > 0) {
+                Node child;
+                child.move = untried[randomBelow(rng, untriedCount)];
+                child.mover = mover;
+                child.parent = node;
+                child.sibling = nodes[static_cast<size_t>(node)].firstChild;
+                child.available = 1;
+                nodes.push_back(child);
+                node = static_cast<int>(nodes.size()) - 1;
+                nodes[static_cast<size_t>(child.parent)].firstChild = node;
+                inTree = false;
+            } else {
+                node = best;
+            }
+            advance(state, nodes[static_cast<size_t>(node)].move, turnActions);
+        }
+
+        scoreOutcome(state, rewards);
+        for (int n = node; n > 0; n = nodes[static_cast<size_t>(n)].parent) {
+            Node& current = nodes[static_cast<size_t>(n)];
+            ++current.visits;
+            current.reward += rewards[current.mover];
+        }
+        ++nodes[0].visits;
+        ++playouts;
+    }
+
+    std::vector<MoveStats> stats;
+    for (int child = nodes[0].firstChild; child >= 0; child = nodes[static_cast<size_t>(child)].sibling) {
+        const Node& node = nodes[static_cast<size_t>(child)];
+        stats.push_back({node.move, node.visits, node.reward});
+    }
+    return stats;
+}
+
+} // namespace
+
+void HiddenCoinsDeterminizer::determinize(GameState& state, int viewer, std::mt19937_64& rng) const {
+    int hidden[STATE_MAX_SEATS];
+    int count = 0;
+    int total = 0;
+    int spied = state.seat(viewer).spyTarget;
+    for (int i = 0; i < state.playerCount; ++i) {
+        SeatState& seat = state.seat(i);
+        if (i == viewer || i == spied || !seat.active()) continue;
+        hidden[count++] = i;
+        total += seat.coins;
+        seat.coins = 0;
+    }
+    for (int coin = 0; coin < total; ++coin) ++state.seat(hidden[randomBelow(rng, count)]).coins;
+}
+
+Ismcts::Ismcts(IsmctsConfig config, std::shared_ptr<const Determinizer> determinizer)
+    : _config(config), _determinizer(std::move(determinizer)) {
+    if (!_determinizer) throw GameException("ISMCTS needs a determinizer!");
+    if (_config.budget.iterations == 0 && _config.budget.seconds <= 0.0)
+        throw GameException("Search budget needs an iteration or time limit!");
+    if (_config.maxPlies <= 0) throw GameException("Playout length must be positive!");
+    if (_config.threads == 0) _config.threads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+SearchResult Ismcts::search(const Game& game, int seat) const {
+    return search(game.snapshot(), seat);
+}
+
+SearchResult Ismcts::search(const GameState& state, int seat) const {
+    if (rules::isGameOver(state)) throw GameOverException();
+    if (seat != state.currentTurn) throw NotYourTurnException();
+    MoveList legal;
+    rules::legalMoves(state, seat, legal);
+    if (legal.empty()) throw IllegalMoveException("No legal move to search!");
+
+    unsigned threads = _config.threads;
+    std::vector<std::vector<MoveStats>> trees(threads);
+    std::vector<std::uint64_t> playouts(threads, 0);
+    std::vector<std::exception_ptr> errors(threads);
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([this, t, &state, seat, &trees, &playouts, &errors] {
+            try {
+                std::seed_seq seq{static_cast<std::uint32_t>(_config.seed),
+                                  static_cast<std::uint32_t>(_config.seed >> 32), t};
+                std::mt19937_64 rng(seq);
+                trees[t] = searchTree(state, seat, _config, *_determinizer, rng, playouts[t]);
+            } catch (...) {
+                errors[t] = std::current_exception();
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    for (const auto& error : errors)
+        if (error) std::rethrow_exception(error);
+
+    SearchResult result;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (unsigned t = 0; t < threads; ++t) {
+        result.playouts += playouts[t];
+        for (const MoveStats& stats : trees[t]) {
+            auto it = std::find_if(result.moves.begin(), result.moves.end(),
+                                   [&](const MoveStats& other) { return other.move == stats.move; });
+            if (it == result.moves.end()) {
+                result.moves.push_back(stats);
+            } else {
+                it->visits += stats.visits;
+                it->reward += stats.reward;
+            }
+        }
+    }
+    std::stable_sort(result.moves.begin(), result.moves.end(),
+                     [](const MoveStats& a, const MoveStats& b) { return a.visits > b.visits; });
+    result.best = result.moves.empty() ? legal[0] : result.moves.front().move;
+    return result;
+}
+
+} // namespace coup
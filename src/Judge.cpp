@@ -2,23 +2,21 @@
 #include "../include/Judge.hpp"
 #include "../include/Game.hpp"
 #include "../include/Exceptions.hpp"
-#include <iostream>
 
 namespace coup {
 
 Judge::Judge(Game& game, const std::string& name)
-    : Player(game, name) {}
+    : Player(game, name, RoleId::Judge) {}
 
 void Judge::undo(Player& target) {
     // Check if the target has a pending bribe action
-    if (_game->hasPendingAction(target.getName(), "bribe") && canUndoBribe()) {
+    if (_game->hasPendingAction(target.seat(), ActionType::Bribe) && canUndoBribe()) {
         // Judge can undo bribe actions, causing the target to lose the 4 coins they paid
         
         // Clear the pending bribe action
-        _game->clearPendingAction(target.getName(), "bribe");
+        _game->clearPendingAction(target.seat(), ActionType::Bribe);
         
-        std::cout << "Judge " << _name << " blocked the bribe by " << target.getName() 
-                  << ", making them lose the 4 coins they paid" << std::endl;
+        _game->emit(EventType::BribeBlocked, _seat, target.seat());
     } 
     // Try the base class implementation for other types of actions
     else {
@@ -34,8 +32,7 @@ void Judge::onSanctioned(Player& by) {
     by.removeCoins(1);
     _game->addToBank(1);
     
-    std::cout << "Judge " << _name << " was sanctioned by " << by.getName() 
-              << ", who had to pay an extra coin as penalty" << std::endl;
+    _game->emit(EventType::JudgeSanctioned, _seat, by.seat());
 }
 
 } // namespace coup
\ No newline at end of file
@@ -2,23 +2,23 @@
 #include "../include/Merchant.hpp"
 #include "../include/Game.hpp"
 #include "../include/Exceptions.hpp"
-#include <iostream>
 
 namespace coup {
 
 Merchant::Merchant(Game& game, const std::string& name)
-    : Player(game, name) {}
+    : Player(game, name, RoleId::Merchant) {}
 
 void Merchant::startTurn() {
     // First, apply the standard turn start behavior
     Player::startTurn();
     
     // Merchant's special ability: get an extra coin if starting turn with 3+ coins
-    if (_coins >= 3) {
-        _coins += 1;
+    // (skipped while the bank is empty, as in rules::nextTurn)
+    if (_coins >= 3 && _game->getBank() >= 1) {
         _game->removeFromBank(1);
+        addCoins(1);
         
-        std::cout << "Merchant " << _name << " received an extra coin at the start of their turn" << std::endl;
+        _game->emit(EventType::MerchantBonus, _seat);
     }
 }
 
@@ -28,15 +28,14 @@ void Merchant::onArrested(Player& by) {
     // Check if Merchant has enough coins
     if (_coins >= 2) {
         // Pay 2 coins to bank instead of giving 1 to the arrester
-        _coins -= 2;
+        removeCoins(2);
         _game->addToBank(2);
         
-        std::cout << "Merchant " << _name << " paid 2 coins to the treasury when arrested by " 
-                  << by.getName() << std::endl;
+        _game->emit(EventType::MerchantArrestFee, _seat, by.seat());
     } 
     // If not enough coins, nothing happens (merchant is broke)
     else {
-        std::cout << "Merchant " << _name << " doesn't have enough coins to pay the arrest fee" << std::endl;
+        _game->emit(EventType::MerchantCannotPay, _seat);
     }
     
     // Note: We're intentionally not calling Player::onArrested() since the behavior is completely different
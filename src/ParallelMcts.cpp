@@ -0,0 +1,232 @@
+//tomergal40@gmail.com
+#include "../include/ParallelMcts.hpp"
+#include "../include/Exceptions.hpp"
+#include "../include/Playout.hpp"
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <thread>
+#include <vector>
+
+namespace coup {
+
+namespace {
+
+// Rewards are accumulated in fixed point so they can use integer atomics
+const double REWARD_SCALE = 1 << 20;
+
+} // namespace
+
+TreeParallelMcts::TreeParallelMcts(ParallelMctsConfig config, std::shared_ptr<const Determinizer> determinizer)
+    : _config(config), _determinizer(std::move(determinizer)) {
+    if (!_determinizer) throw GameException("MCTS needs a determinizer!");
+    if (_config.budget.iterations == 0 && _config.budget.seconds <= 0.0)
+        throw GameException("Search budget needs an iteration or time limit!");
+    if (_config.maxPlies <= 0) throw GameException("Playout length must be positive!");
+    if (_config.arenaNodes < 2) throw GameException("Node arena is too small!");
+    if (_config.virtualLoss < 0) throw GameException("Virtual loss cannot be negative!");
+    if (_config.threads == 0) _config.threads = std::max(1u, std::thread::hardware_concurrency());
+    _nodes = std::make_unique<Node[]>(_config.arenaNodes);
+}
+
+int TreeParallelMcts::allocate(const Move& move, int mover, int parent) {
+    std::size_t index = _used.fetch_add(1, std::memory_order_relaxed);
+    if (index >= _config.arenaNodes) return -1;
+    Node& node = _nodes[index];
+    node.move = move;
+    node.mover = static_cast<std::int8_t>(mover);
+    node.parent = parent;
+    node.sibling = -1;
+    node.firstChild.store(-1, std::memory_order_relaxed);
+    node.visits.store(0, std::memory_order_relaxed);
+    node.available.store(0, std::memory_order_relaxed);
+    node.virtualLoss.store(0, std::memory_order_relaxed);
+    node.reward.store(0, std::memory_order_relaxed);
+    return static_cast<int>(index);
+}
+
+int TreeParallelMcts::childFor(int node, int mover, const Move& move, bool& created) {
+    std::atomic<int>& head = _nodes[node].firstChild;
+    int first = head.load(std::memory_order_acquire);
+    int scannedFrom = -1; // Children from here on were already checked
+    int mine = -1;
+    while (true) {
+        for (int child = first; child != scannedFrom; child = _nodes[child].sibling) {
+            if (_nodes[child].mover == mover && _nodes[child].move == move) {
+                created = false;
+                return child; // Published by another thread; `mine` (if any) stays unused
+            }
+        }
+        if (mine < 0) {
+            mine = allocate(move, mover, node);
+            if (mine < 0) return -1;
+        }
+        _nodes[mine].sibling = first;
+        scannedFrom = first;
+        if (head.compare_exchange_weak(first, mine, std::memory_order_release, std::memory_order_acquire)) {
+            created = true;
+            return mine;
+        }
+    }
+}
+
+std::uint64_t TreeParallelMcts::runIterations(const GameState& root, int seat, std::atomic<std::uint64_t>& claimed,
+                                              std::chrono::steady_clock::time_point start, std::mt19937_64& rng) {
+    const SearchBudget& budget = _config.budget;
+    const int virtualLoss = _config.virtualLoss;
+    std::vector<int> path;
+    path.reserve(static_cast<size_t>(_config.maxPlies));
+    MoveList legal;
+    double rewards[STATE_MAX_SEATS];
+    std::uint64_t playouts = 0;
+
+    while (true) {
+        if (budget.iterations && claimed.fetch_add(1, std::memory_order_relaxed) >= budget.iterations) break;
+        if (budget.seconds > 0.0 && playouts % 64 == 0 &&
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= budget.seconds)
+            break;
+
+        GameState state = root;
+        _determinizer->determinize(state, seat, rng);
+        path.clear();
+        int node = 0;
+        int plies = 0;
+        int turnActions = 0;
+        bool inTree = true;
+
+        while (!rules::isGameOver(state) && plies < _config.maxPlies) {
+            int mover = state.currentTurn;
+            rules::legalMoves(state, mover, legal);
+            ++plies;
+            if (legal.empty()) {
+                rules::nextTurn(state);
+                turnActions = 0;
+                continue;
+            }
+            if (!inTree) {
+                advance(state, legal[static_cast<size_t>(randomBelow(rng, static_cast<int>(legal.size())))], turnActions);
+                continue;
+            }
+
+            // UCB over the children legal in this determinization, counting
+            // other threads' pending visits as losses
+            Move untried[MAX_MOVES];
+            int untriedCount = 0;
+            int best = -1;
+            double bestValue = -1.0;
+            for (const Move& move : legal) {
+                int child = -1;
+                for (int c = _nodes[node].firstChild.load(std::memory_order_acquire); c >= 0; c = _nodes[c].sibling) {
+                    if (_nodes[c].mover == mover && _nodes[c].move == move) {
+                        child = c;
+                        break;
+                    }
+                }
+                if (child < 0) {
+                    untried[untriedCount++] = move;
+                    continue;
+                }
+                Node& candidate = _nodes[child];
+                std::uint32_t available = candidate.available.fetch_add(1, std::memory_order_relaxed) + 1;
+                double visits = candidate.visits.load(std::memory_order_relaxed) +
+                                candidate.virtualLoss.load(std::memory_order_relaxed);
+                double value = std::numeric_limits<double>::infinity();
+                if (visits > 0) {
+                    double reward = static_cast<double>(candidate.reward.load(std::memory_order_relaxed)) / REWARD_SCALE;
+                    value = reward / visits + _config.exploration * std::sqrt(std::log(static_cast<double>(available)) / visits);
+                }
+                if (value > bestValue) {
+                    bestValue = value;
+                    best = child;
+                }
+            }
+
+            Move move;
+            if (untriedCount > 0) {
+                move = untried[randomBelow(rng, untriedCount)];
+                bool created = false;
+                int child = childFor(node, mover, move, created);
+                inTree = false; // At most one expansion per iteration
+                if (child >= 0) {
+                    if (created) _nodes[child].available.fetch_add(1, std::memory_order_relaxed);
+                    node = child;
+                    path.push_back(node);
+                    _nodes[node].virtualLoss.fetch_add(virtualLoss, std::memory_order_relaxed);
+                }
+            } else {
+                node = best;
+                move = _nodes[node].move;
+                path.push_back(node);
+                _nodes[node].virtualLoss.fetch_add(virtualLoss, std::memory_order_relaxed);
+            }
+            advance(state, move, turnActions);
+        }
+
+        scoreOutcome(state, rewards);
+        for (int n : path) {
+            Node& current = _nodes[n];
+            current.reward.fetch_add(static_cast<std::uint64_t>(rewards[current.mover] * REWARD_SCALE), std::memory_order_relaxed);
+            current.visits.fetch_add(1, std::memory_order_relaxed);
+            current.virtualLoss.fetch_sub(virtualLoss, std::memory_order_relaxed);
+        }
+        _nodes[0].visits.fetch_add(1, std::memory_order_relaxed);
+        ++playouts;
+    }
+    return playouts;
+}
+
+SearchResult TreeParallelMcts::search(const Game& game, int seat) {
+    return search(game.snapshot(), seat);
+}
+
+SearchResult TreeParallelMcts::search(const GameState& state, int seat) {
+    if (rules::isGameOver(state)) throw GameOverException();
+    if (seat != state.currentTurn) throw NotYourTurnException();
+    MoveList legal;
+    rules::legalMoves(state, seat, legal);
+    if (legal.empty()) throw IllegalMoveException("No legal move to search!");
+
+    _used.store(0, std::memory_order_relaxed);
+    allocate(Move{}, -1, -1); // Root
+
+    unsigned threads = _config.threads;
+    std::atomic<std::uint64_t> claimed{0};
+    std::vector<std::uint64_t> playouts(threads, 0);
+    std::vector<std::exception_ptr> errors(threads);
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([this, t, &state, seat, &claimed, start, &playouts, &errors] {
+            try {
+                std::seed_seq seq{static_cast<std::uint32_t>(_config.seed),
+                                  static_cast<std::uint32_t>(_config.seed >> 32), t};
+                std::mt19937_64 rng(seq);
+                playouts[t] = runIterations(state, seat, claimed, start, rng);
+            } catch (...) {
+                errors[t] = std::current_exception();
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    for (const auto& error : errors)
+        if (error) std::rethrow_exception(error);
+    if (_used.load(std::memory_order_relaxed) > _config.arenaNodes) _used.store(_config.arenaNodes, std::memory_order_relaxed);
+
+    SearchResult result;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (std::uint64_t count : playouts) result.playouts += count;
+    for (int child = _nodes[0].firstChild.load(std::memory_order_acquire); child >= 0; child = _nodes[child].sibling) {
+        const Node& node = _nodes[child];
+        result.moves.push_back({node.move, node.visits.load(std::memory_order_relaxed),
+                                static_cast<double>(node.reward.load(std::memory_order_relaxed)) / REWARD_SCALE});
+    }
+    std::stable_sort(result.moves.begin(), result.moves.end(),
+                     [](const MoveStats& a, const MoveStats& b) { return a.visits > b.visits; });
+    result.best = result.moves.empty() ? legal[0] : result.moves.front().move;
+    return result;
+}
+
+} // namespace coup
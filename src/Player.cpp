@@ -2,15 +2,18 @@
 #include "../include/Player.hpp"
 #include "../include/Game.hpp"
 #include "../include/Exceptions.hpp"
-#include <iostream>
+#include "../include/Zobrist.hpp"
 
 namespace coup {
 
 Player::Player(Game& game, const std::string& name)
+    : Player(game, name, RoleId::Player) {}
+
+Player::Player(Game& game, const std::string& name, RoleId roleId)
     : _name(name), _coins(0), _active(true), _canGather(true), _canTax(true),
-      _underSanction(false), _game(&game), _lastArrested(nullptr) {}
+      _underSanction(false), _game(&game), _lastArrested(nullptr), _roleId(roleId), _seat(-1) {}
 
-std::string Player::getName() const { return _name; }
+const std::string& Player::getName() const { return _name; }
 int Player::coins() const { return _coins; }
 bool Player::isActive() const { return _active; }
 bool Player::canGather() const { return _canGather; }
@@ -19,109 +22,142 @@ bool Player::isUnderSanction() const { return _underSanction; }
 bool Player::mustCoup() const { return _coins >= 10; }
 
 void Player::gather() {
-    if (!_game->isPlayerTurn(_name)) throw NotYourTurnException();
+    if (!_game->isPlayerTurn(_seat)) throw NotYourTurnException();
     if (_underSanction) throw SanctionedPlayerException("You are under sanction and cannot gather resources!");
     if (!_canGather) throw IllegalMoveException("You cannot gather resources at this time!");
     if (mustCoup()) throw TooManyCoinsException();
     _game->removeFromBank(1);
-    _coins += 1;
-    _game->addPendingAction(_name, "gather");
+    addCoins(1);
+    _game->addPendingAction(_seat, ActionType::Gather);
     _game->nextTurn();
 }
 
 void Player::tax() {
-    if (!_game->isPlayerTurn(_name)) throw NotYourTurnException();
+    if (!_game->isPlayerTurn(_seat)) throw NotYourTurnException();
     if (_underSanction) throw SanctionedPlayerException("You are under sanction and cannot collect tax!");
     if (!_canTax) throw IllegalMoveException("You cannot collect tax at this time!");
     if (mustCoup()) throw TooManyCoinsException();
     _game->removeFromBank(2);
-    _coins += 2;
-    _game->addPendingAction(_name, "tax");
+    addCoins(2);
+    _game->addPendingAction(_seat, ActionType::Tax);
     _game->nextTurn();
 }
 
 void Player::bribe() {
-    if (!_game->isPlayerTurn(_name)) throw NotYourTurnException();
-    bool isBaron = (this->role() == "Baron");
+    if (!_game->isPlayerTurn(_seat)) throw NotYourTurnException();
+    bool isBaron = (_roleId == RoleId::Baron);
     int requiredCoins = isBaron ? 3 : 4;
     if (_coins < requiredCoins)
         throw NotEnoughCoinsException(isBaron ? "Baron requires 3 coins for a bribe!" : "Bribe requires 4 coins!");
     if (mustCoup()) throw TooManyCoinsException();
-    _coins -= requiredCoins;
+    removeCoins(requiredCoins);
     _game->addToBank(requiredCoins);
-    _game->addPendingAction(_name, "bribe");
+    _game->addPendingAction(_seat, ActionType::Bribe);
 }
 
 void Player::arrest(Player& target) {
-    bool isSpy = (this->role() == "Spy");
-    bool isMerchant = (target.role() == "Merchant");
+    bool isSpy = (_roleId == RoleId::Spy);
+    bool isMerchant = (target.roleId() == RoleId::Merchant);
     bool outOfTurnSpyArrest = isSpy && isMerchant;
-    if (!outOfTurnSpyArrest && !_game->isPlayerTurn(_name)) throw NotYourTurnException();
+    if (!outOfTurnSpyArrest && !_game->isPlayerTurn(_seat)) throw NotYourTurnException();
     if (mustCoup()) throw TooManyCoinsException();
     if (!target.isActive()) throw PlayerNotActiveException();
     if (&target == _lastArrested) throw IllegalMoveException("Cannot arrest the same player twice in a row!");
 
-    _game->addPendingAction(_name, "arrest", createSafePtr(&target));
-    _lastArrested = &target;
+    _game->addPendingAction(_seat, ActionType::Arrest, target.seat());
+    setLastArrested(&target);
     target.onArrested(*this);
     if (!outOfTurnSpyArrest) _game->nextTurn();
 }
 
 void Player::sanction(Player& target) {
-    if (!_game->isPlayerTurn(_name)) throw NotYourTurnException();
+    if (!_game->isPlayerTurn(_seat)) throw NotYourTurnException();
     if (_coins < 3) throw NotEnoughCoinsException("Sanction requires 3 coins!");
     if (mustCoup()) throw TooManyCoinsException();
     if (!target.isActive()) throw PlayerNotActiveException();
 
-    _coins -= 3;
+    removeCoins(3);
     _game->addToBank(3);
-    _game->addPendingAction(_name, "sanction", createSafePtr(&target));
+    _game->addPendingAction(_seat, ActionType::Sanction, target.seat());
     target.onSanctioned(*this);
     _game->nextTurn();
 }
 
 void Player::coup(Player& target) {
-    if (!_game->isPlayerTurn(_name)) throw NotYourTurnException();
+    if (!_game->isPlayerTurn(_seat)) throw NotYourTurnException();
     if (_coins < 7) throw NotEnoughCoinsException("Coup requires 7 coins!");
     if (!target.isActive()) throw PlayerNotActiveException();
 
-    _coins -= 7;
+    removeCoins(7);
     _game->addToBank(7);
-    _game->addPendingAction(_name, "coup", createSafePtr(this), createSafePtr(&target));
+    _game->addPendingAction(_seat, ActionType::Coup, _seat, target.seat());
     target.setActive(false);
     _game->nextTurn();
 }
 
 void Player::undo(Player& target) {
-    if (_game->hasPendingAction(target.getName(), "tax") && canUndoTax()) {
+    if (_game->hasPendingAction(target.seat(), ActionType::Tax) && canUndoTax()) {
         target.removeCoins(2);
         _game->addToBank(2);
-        _game->clearPendingAction(target.getName(), "tax");
-    } else if (_game->hasPendingAction(target.getName(), "bribe") && canUndoBribe()) {
-        _game->clearPendingAction(target.getName(), "bribe");
+        _game->clearPendingAction(target.seat(), ActionType::Tax);
+    } else if (_game->hasPendingAction(target.seat(), ActionType::Bribe) && canUndoBribe()) {
+        _game->clearPendingAction(target.seat(), ActionType::Bribe);
     } else {
         throw IllegalMoveException("Cannot undo this action or no action to undo!");
     }
 }
 
-void Player::setActive(bool active) { _active = active; }
+// Every change of hashed state goes through the setters below, which keep
+// the game's Zobrist hash up to date. Players not seated in a game (seat -1)
+// have nothing to update.
+void Player::setActive(bool active) {
+    std::uint8_t before = stateFlags();
+    _active = active;
+    if (_seat >= 0) _game->updateHash(zobrist::flags(_seat, before) ^ zobrist::flags(_seat, stateFlags()));
+}
+
 void Player::setSanction(bool sanctioned) {
+    std::uint8_t before = stateFlags();
     _underSanction = sanctioned;
     _canGather = !sanctioned;
     _canTax = !sanctioned;
+    if (_seat >= 0) _game->updateHash(zobrist::flags(_seat, before) ^ zobrist::flags(_seat, stateFlags()));
 }
 
-void Player::addCoins(int amount) { _coins += amount; }
+void Player::addCoins(int amount) { setCoins(_coins + amount); }
 void Player::removeCoins(int amount) {
     if (_coins < amount) throw NotEnoughCoinsException();
-    _coins -= amount;
+    setCoins(_coins - amount);
+}
+
+void Player::setCoins(int amount) {
+    if (_seat >= 0) _game->updateHash(zobrist::coins(_seat, _coins) ^ zobrist::coins(_seat, amount));
+    _coins = amount;
+}
+
+Player* Player::lastArrested() const { return _lastArrested; }
+void Player::setLastArrested(Player* target) {
+    if (_seat >= 0) {
+        int before = _lastArrested ? _lastArrested->seat() : -1;
+        int after = target ? target->seat() : -1;
+        _game->updateHash(zobrist::lastArrested(_seat, before) ^ zobrist::lastArrested(_seat, after));
+    }
+    _lastArrested = target;
+}
+
+int Player::seat() const { return _seat; }
+void Player::setSeat(int seat) { _seat = seat; }
+
+std::uint8_t Player::stateFlags() const {
+    return static_cast<std::uint8_t>((_active ? SEAT_ACTIVE : 0) | (_underSanction ? SEAT_SANCTIONED : 0) |
+                                     (_canGather ? SEAT_CAN_GATHER : 0) | (_canTax ? SEAT_CAN_TAX : 0));
 }
 
 void Player::onSanctioned(Player&) { setSanction(true); }
 
 void Player::onArrested(Player& by) {
     if (_coins < 1) return;
-    _coins -= 1;
+    removeCoins(1);
     by.addCoins(1);
 }
 
@@ -132,7 +168,7 @@ bool Player::canUndoSanction() const { return false; }
 bool Player::canUndoArrest() const { return false; }
 
 void Player::startTurn() {
-    if (mustCoup()) std::cout << "You have 10+ coins and must perform a coup this turn!" << std::endl;
+    if (mustCoup()) _game->emit(EventType::MustCoup, _seat);
     if (_underSanction) setSanction(false); 
 }
 
@@ -0,0 +1,46 @@
+//tomergal40@gmail.com
+#include "../include/Playout.hpp"
+
+namespace coup {
+
+void advance(GameState& state, const Move& move, int& turnActions) {
+    int before = state.currentTurn;
+    if (rules::apply(state, before, move) != MoveStatus::Ok) {
+        // Callers pass legal moves, so this only guards against a refused
+        // move stalling the playout: the turn passes
+        rules::nextTurn(state);
+        turnActions = 0;
+    } else if (state.currentTurn != before) {
+        turnActions = 0;
+    } else if (++turnActions >= MAX_ACTIONS_PER_TURN) {
+        rules::nextTurn(state);
+        turnActions = 0;
+    }
+}
+
+void scoreOutcome(const GameState& state, double rewards[STATE_MAX_SEATS]) {
+    int winner = rules::winner(state);
+    int active = rules::countActive(state);
+    for (int i = 0; i < state.playerCount; ++i) {
+        if (winner >= 0) rewards[i] = i == winner ? 1.0 : 0.0;
+        else rewards[i] = state.seat(i).active() ? 1.0 / active : 0.0;
+    }
+}
+
+int randomPlayout(GameState& state, int maxPlies, int turnActions, std::mt19937_64& rng) {
+    MoveList legal;
+    int plies = 0;
+    while (!rules::isGameOver(state) && plies < maxPlies) {
+        ++plies;
+        rules::legalMoves(state, state.currentTurn, legal);
+        if (legal.empty()) {
+            rules::nextTurn(state);
+            turnActions = 0;
+            continue;
+        }
+        advance(state, legal[static_cast<size_t>(randomBelow(rng, static_cast<int>(legal.size())))], turnActions);
+    }
+    return plies;
+}
+
+} // namespace coup
@@ -0,0 +1,99 @@
+//tomergal40@gmail.com
+#include "../include/Protocol.hpp"
+#include "../include/Exceptions.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace coup {
+
+namespace protocol {
+
+FrameWriter::FrameWriter(std::string& out, MessageType type, std::uint32_t request) : _out(out), _start(out.size()) {
+    _out.append(HEADER_BYTES, '\0');
+    u8(static_cast<std::uint8_t>(type));
+    u32(request);
+}
+
+FrameWriter& FrameWriter::u8(std::uint8_t value) {
+    _out.push_back(static_cast<char>(value));
+    return *this;
+}
+
+FrameWriter& FrameWriter::u16(std::uint16_t value) {
+    u8(static_cast<std::uint8_t>(value));
+    return u8(static_cast<std::uint8_t>(value >> 8));
+}
+
+FrameWriter& FrameWriter::u32(std::uint32_t value) {
+    u16(static_cast<std::uint16_t>(value));
+    return u16(static_cast<std::uint16_t>(value >> 16));
+}
+
+FrameWriter& FrameWriter::bytes(const void* data, std::size_t size) {
+    _out.append(static_cast<const char*>(data), size);
+    return *this;
+}
+
+FrameWriter& FrameWriter::text(const std::string& value) {
+    std::size_t size = std::min<std::size_t>(value.size(), 255);
+    u8(static_cast<std::uint8_t>(size));
+    return bytes(value.data(), size);
+}
+
+void FrameWriter::finish() {
+    std::size_t body = _out.size() - _start - HEADER_BYTES;
+    if (body > MAX_BODY_BYTES) throw GameException("Protocol message too long!");
+    _out[_start] = static_cast<char>(body & 0xff);
+    _out[_start + 1] = static_cast<char>(body >> 8);
+}
+
+FrameReader::FrameReader(const char* body, std::size_t size)
+    : _data(reinterpret_cast<const unsigned char*>(body)), _size(size) {}
+
+bool FrameReader::need(std::size_t bytes) {
+    if (_size - _pos < bytes) _ok = false;
+    return _ok;
+}
+
+std::uint8_t FrameReader::u8() {
+    return need(1) ? _data[_pos++] : 0;
+}
+
+std::uint16_t FrameReader::u16() {
+    if (!need(2)) return 0;
+    std::uint16_t value = static_cast<std::uint16_t>(_data[_pos] | (_data[_pos + 1] << 8));
+    _pos += 2;
+    return value;
+}
+
+std::uint32_t FrameReader::u32() {
+    std::uint32_t low = u16();
+    std::uint32_t high = u16();
+    return low | (high << 16);
+}
+
+bool FrameReader::bytes(void* out, std::size_t size) {
+    if (!need(size)) return false;
+    std::memcpy(out, _data + _pos, size);
+    _pos += size;
+    return true;
+}
+
+std::string FrameReader::text() {
+    std::size_t size = u8();
+    if (!need(size)) return std::string();
+    std::string value(reinterpret_cast<const char*>(_data + _pos), size);
+    _pos += size;
+    return value;
+}
+
+std::size_t frameLength(const char* data, std::size_t size) {
+    if (size < HEADER_BYTES) return 0;
+    std::size_t body = static_cast<unsigned char>(data[0]) | (static_cast<std::size_t>(static_cast<unsigned char>(data[1])) << 8);
+    if (body > MAX_BODY_BYTES) throw GameException("Protocol message too long!");
+    return size >= HEADER_BYTES + body ? HEADER_BYTES + body : 0;
+}
+
+} // namespace protocol
+
+} // namespace coup
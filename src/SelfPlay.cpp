@@ -0,0 +1,318 @@
+//tomergal40@gmail.com
+#include "../include/SelfPlay.hpp"
+#include "../include/Agent.hpp"
+#include "../include/Exceptions.hpp"
+#include "../include/Playout.hpp"
+#include "../include/Simulator.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace coup {
+
+namespace {
+
+const char MAGIC[8] = {'C', 'O', 'U', 'P', 'S', 'P', '0', '1'};
+
+template <typename T>
+void appendColumn(std::string& out, const std::vector<T>& column) {
+    out.append(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(T));
+}
+
+template <typename T>
+bool readColumn(std::ifstream& in, std::vector<T>& column, std::size_t size) {
+    column.resize(size);
+    in.read(reinterpret_cast<char*>(column.data()), static_cast<std::streamsize>(size * sizeof(T)));
+    return static_cast<bool>(in);
+}
+
+std::string serialize(const SelfPlayChunk& chunk) {
+    const std::uint64_t size = chunk.size();
+    std::string out;
+    out.reserve(sizeof(size) + size * (8 + 2 + 1 + 2 * FEATURE_COUNT + 8 + 8 + 1 + 1));
+    out.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    appendColumn(out, chunk.game);
+    appendColumn(out, chunk.ply);
+    appendColumn(out, chunk.seat);
+    for (const auto& column : chunk.features) appendColumn(out, column);
+    appendColumn(out, chunk.legalLow);
+    appendColumn(out, chunk.legalHigh);
+    appendColumn(out, chunk.move);
+    appendColumn(out, chunk.outcome);
+    return out;
+}
+
+// Writes queued chunks to the file from its own thread. Producers only move
+// a finished chunk into the queue; the writer swaps the whole queue out and
+// writes it without holding the lock.
+class ChunkWriter {
+private:
+    std::ofstream _file;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::vector<std::string> _queue;
+    bool _stopping = false;
+    std::uint64_t _bytes = 0;
+    std::thread _writer;
+
+    void writerLoop() {
+        std::vector<std::string> batch;
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true) {
+            _wake.wait(lock, [this] { return _stopping || !_queue.empty(); });
+            batch.swap(_queue);
+            bool stopping = _stopping;
+            lock.unlock();
+            for (const auto& chunk : batch) {
+                _file.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+                _bytes += chunk.size();
+            }
+            batch.clear();
+            if (stopping) return;
+            lock.lock();
+        }
+    }
+
+public:
+    explicit ChunkWriter(const std::string& path) : _file(path, std::ios::binary | std::ios::trunc) {
+        if (!_file) throw GameException("Cannot open self-play file: " + path);
+        const std::uint32_t widths[2] = {FEATURE_COUNT, MOVE_INDEX_COUNT};
+        _file.write(MAGIC, sizeof(MAGIC));
+        _file.write(reinterpret_cast<const char*>(widths), sizeof(widths));
+        _bytes = sizeof(MAGIC) + sizeof(widths);
+        _writer = std::thread(&ChunkWriter::writerLoop, this);
+    }
+
+    ~ChunkWriter() {
+        if (_writer.joinable()) finish();
+    }
+
+    ChunkWriter(const ChunkWriter&) = delete;
+    ChunkWriter& operator=(const ChunkWriter&) = delete;
+
+    void submit(std::string chunk) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _queue.push_back(std::move(chunk));
+        }
+        _wake.notify_one();
+    }
+
+    // Write everything still queued, close the file and return its size
+    std::uint64_t finish() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _wake.notify_one();
+        _writer.join();
+        _file.close();
+        if (!_file) throw GameException("Writing the self-play file failed!");
+        return _bytes;
+    }
+};
+
+// Results counted by one thread
+struct Tally {
+    std::uint64_t games = 0;
+    std::uint64_t draws = 0;
+    std::uint64_t records = 0;
+    std::uint64_t chunks = 0;
+};
+
+} // namespace
+
+void extractFeatures(const GameState& state, int seat, int turnActions, std::int16_t features[FEATURE_COUNT]) {
+    const int n = state.playerCount;
+    auto relative = [seat, n](int other) { return static_cast<std::int16_t>(other < 0 ? -1 : (other - seat + n) % n); };
+    features[0] = state.bank;
+    features[1] = static_cast<std::int16_t>(n);
+    features[2] = static_cast<std::int16_t>(turnActions);
+    for (int k = 0; k < static_cast<int>(STATE_MAX_SEATS); ++k) {
+        std::int16_t* out = features + 3 + k * FEATURES_PER_SEAT;
+        if (k >= n) {
+            out[0] = 0;
+            out[1] = -1;
+            out[2] = out[3] = out[4] = out[5] = 0;
+            continue;
+        }
+        const SeatState& s = state.seat((seat + k) % n);
+        out[0] = s.coins;
+        out[1] = static_cast<std::int16_t>(s.role);
+        out[2] = s.flags;
+        out[3] = static_cast<std::int16_t>(s.pending);
+        out[4] = relative(s.lastArrested);
+        out[5] = relative(s.spyTarget);
+    }
+}
+
+void SelfPlayChunk::clear() {
+    game.clear();
+    ply.clear();
+    seat.clear();
+    for (auto& column : features) column.clear();
+    legalLow.clear();
+    legalHigh.clear();
+    move.clear();
+    outcome.clear();
+}
+
+SelfPlayGenerator::SelfPlayGenerator(SelfPlayConfig config) : _config(std::move(config)) {
+    if (_config.players < 2 || _config.players > 6)
+        throw GameException("Self-play needs between 2 and 6 players!");
+    if (!_config.roles.empty() && _config.roles.size() != static_cast<size_t>(_config.players))
+        throw GameException("Role list must name one role per seat!");
+    if (_config.agents.size() > static_cast<size_t>(_config.players))
+        throw GameException("More agents than seats!");
+    for (const auto& role : _config.roles)
+        if (roleIdFromName(role) == RoleId::Player) throw GameException("Unknown role: " + role);
+    for (const auto& agent : _config.agents) makeAgentFactory(agent);
+    if (_config.maxTurns <= 0) throw GameException("Turn limit must be positive!");
+    if (_config.chunkRecords == 0) throw GameException("Chunks need at least one record!");
+}
+
+SelfPlayResult SelfPlayGenerator::run(std::uint64_t games, unsigned threads) const {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::max<std::uint64_t>(1, std::min<std::uint64_t>(threads, games)));
+
+    ChunkWriter writer(_config.path);
+    std::vector<Tally> tallies(threads);
+    std::vector<std::exception_ptr> errors(threads);
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    std::atomic<std::uint64_t> nextGame{0};
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([this, t, games, &writer, &nextGame, &tallies, &errors] {
+            try {
+                Tally& tally = tallies[t];
+                std::vector<std::unique_ptr<Agent>> agents;
+                for (int seat = 0; seat < _config.players; ++seat) {
+                    std::size_t index = static_cast<std::size_t>(seat);
+                    agents.push_back(makeAgentFactory(index < _config.agents.size() ? _config.agents[index] : "random")());
+                }
+
+                SelfPlayChunk chunk;
+                MoveList legal;
+                std::int16_t features[FEATURE_COUNT];
+                RoleId roles[STATE_MAX_SEATS];
+                while (true) {
+                    std::uint64_t g = nextGame.fetch_add(1, std::memory_order_relaxed);
+                    if (g >= games) break;
+
+                    // The stream depends on the game only, so the records do not depend on the thread count
+                    std::seed_seq seq{static_cast<std::uint32_t>(_config.seed), static_cast<std::uint32_t>(_config.seed >> 32),
+                                      static_cast<std::uint32_t>(g), static_cast<std::uint32_t>(g >> 32)};
+                    std::mt19937_64 rng(seq);
+                    for (int seat = 0; seat < _config.players; ++seat) {
+                        roles[seat] = _config.roles.empty()
+                            ? static_cast<RoleId>(randomBelow(rng, static_cast<int>(PLAYABLE_ROLE_COUNT)))
+                            : roleIdFromName(_config.roles[static_cast<size_t>(seat)]);
+                    }
+                    GameState state = rules::initialState(roles, _config.players);
+
+                    const std::size_t first = chunk.size();
+                    int turns = 0;
+                    int turnActions = 0;
+                    std::uint16_t ply = 0;
+                    while (!rules::isGameOver(state) && turns < _config.maxTurns) {
+                        int seat = state.currentTurn;
+                        rules::legalMoves(state, seat, legal);
+                        if (legal.empty()) {
+                            rules::nextTurn(state);
+                            turnActions = 0;
+                            ++turns;
+                            continue;
+                        }
+                        Move move = agents[static_cast<size_t>(seat)]->decide(GameView{state, seat, legal, turnActions, rng});
+
+                        extractFeatures(state, seat, turnActions, features);
+                        std::uint64_t mask[2] = {0, 0};
+                        for (const Move& option : legal) {
+                            int index = moveIndex(option);
+                            mask[index / 64] |= std::uint64_t{1} << (index % 64);
+                        }
+                        chunk.game.push_back(g);
+                        chunk.ply.push_back(ply++);
+                        chunk.seat.push_back(static_cast<std::uint8_t>(seat));
+                        for (int f = 0; f < FEATURE_COUNT; ++f) chunk.features[static_cast<size_t>(f)].push_back(features[f]);
+                        chunk.legalLow.push_back(mask[0]);
+                        chunk.legalHigh.push_back(mask[1]);
+                        chunk.move.push_back(static_cast<std::uint8_t>(moveIndex(move)));
+
+                        advance(state, move, turnActions);
+                        if (state.currentTurn != seat) ++turns;
+                    }
+
+                    // Outcomes are known only now, so chunks are handed over between games
+                    int winner = rules::winner(state);
+                    for (std::size_t r = first; r < chunk.size(); ++r)
+                        chunk.outcome.push_back(static_cast<std::int8_t>(winner < 0 ? 0 : chunk.seat[r] == winner ? 1 : -1));
+                    ++tally.games;
+                    if (winner < 0) ++tally.draws;
+                    if (chunk.size() >= _config.chunkRecords) {
+                        tally.records += chunk.size();
+                        ++tally.chunks;
+                        writer.submit(serialize(chunk));
+                        chunk.clear();
+                    }
+                }
+                if (chunk.size() > 0) {
+                    tally.records += chunk.size();
+                    ++tally.chunks;
+                    writer.submit(serialize(chunk));
+                }
+            } catch (...) {
+                errors[t] = std::current_exception();
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    SelfPlayResult result;
+    result.bytes = writer.finish();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (const auto& error : errors)
+        if (error) std::rethrow_exception(error);
+    for (const Tally& tally : tallies) {
+        result.games += tally.games;
+        result.draws += tally.draws;
+        result.records += tally.records;
+        result.chunks += tally.chunks;
+    }
+    return result;
+}
+
+SelfPlayReader::SelfPlayReader(const std::string& path) : _file(path, std::ios::binary), _path(path) {
+    if (!_file) throw GameException("Cannot open self-play file: " + path);
+    char magic[sizeof(MAGIC)];
+    std::uint32_t widths[2];
+    _file.read(magic, sizeof(magic));
+    _file.read(reinterpret_cast<char*>(widths), sizeof(widths));
+    if (!_file || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+        throw GameException("Not a self-play file: " + path);
+    if (widths[0] != static_cast<std::uint32_t>(FEATURE_COUNT) || widths[1] != static_cast<std::uint32_t>(MOVE_INDEX_COUNT))
+        throw GameException("Self-play file has a different record layout: " + path);
+}
+
+bool SelfPlayReader::next(SelfPlayChunk& chunk) {
+    std::uint64_t size = 0;
+    _file.read(reinterpret_cast<char*>(&size), sizeof(size));
+    if (_file.gcount() == 0 && _file.eof()) return false;
+    if (size > std::uint64_t{1} << 32) throw GameException("Corrupt self-play file: " + _path);
+    bool ok = static_cast<bool>(_file) && readColumn(_file, chunk.game, size) && readColumn(_file, chunk.ply, size) &&
+              readColumn(_file, chunk.seat, size);
+    for (auto& column : chunk.features) ok = ok && readColumn(_file, column, size);
+    ok = ok && readColumn(_file, chunk.legalLow, size) && readColumn(_file, chunk.legalHigh, size) &&
+         readColumn(_file, chunk.move, size) && readColumn(_file, chunk.outcome, size);
+    if (!ok) throw GameException("Truncated self-play file: " + _path);
+    return true;
+}
+
+} // namespace coup
@@ -0,0 +1,180 @@
+//tomergal40@gmail.com
+#include "../include/Simulator.hpp"
+#include "../include/Player.hpp"
+#include "../include/Governor.hpp"
+#include "../include/Spy.hpp"
+#include "../include/Baron.hpp"
+#include "../include/General.hpp"
+#include "../include/Judge.hpp"
+#include "../include/Merchant.hpp"
+#include "../include/Exceptions.hpp"
+#include "../include/Playout.hpp"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <thread>
+
+namespace coup {
+
+const std::array<const char*, 6> ROLE_NAMES = {"Governor", "Spy", "Baron", "General", "Judge", "Merchant"};
+
+namespace {
+
+int roleIndex(const std::string& role) {
+    for (size_t i = 0; i < ROLE_NAMES.size(); ++i)
+        if (role == ROLE_NAMES[i]) return static_cast<int>(i);
+    return -1;
+}
+
+} // namespace
+
+std::shared_ptr<Player> createPlayer(Game& game, const std::string& role, const std::string& name) {
+    if (role == "Governor") return std::make_shared<Governor>(game, name);
+    if (role == "Spy") return std::make_shared<Spy>(game, name);
+    if (role == "Baron") return std::make_shared<Baron>(game, name);
+    if (role == "General") return std::make_shared<General>(game, name);
+    if (role == "Judge") return std::make_shared<Judge>(game, name);
+    if (role == "Merchant") return std::make_shared<Merchant>(game, name);
+    throw GameException("Unknown role: " + role);
+}
+
+SimulationResult& SimulationResult::operator+=(const SimulationResult& other) {
+    games += other.games;
+    draws += other.draws;
+    turns += other.turns;
+    actions += other.actions;
+    rejectedMoves += other.rejectedMoves;
+    forcedPasses += other.forcedPasses;
+    for (size_t i = 0; i < winsBySeat.size(); ++i) winsBySeat[i] += other.winsBySeat[i];
+    for (size_t i = 0; i < winsByRole.size(); ++i) winsByRole[i] += other.winsByRole[i];
+    return *this;
+}
+
+Simulator::Simulator(SimulationConfig config) : _config(std::move(config)) {
+    if (_config.players < 2 || _config.players > 6)
+        throw GameException("Simulations need between 2 and 6 players!");
+    if (!_config.roles.empty() && _config.roles.size() != static_cast<size_t>(_config.players))
+        throw GameException("Role list must name one role per seat!");
+    if (_config.agents.size() > static_cast<size_t>(_config.players))
+        throw GameException("More agents than seats!");
+    for (const auto& role : _config.roles)
+        if (roleIndex(role) < 0) throw GameException("Unknown role: " + role);
+    if (_config.maxTurns <= 0) throw GameException("Turn limit must be positive!");
+}
+
+std::vector<std::unique_ptr<Agent>> Simulator::createAgents() const {
+    std::vector<std::unique_ptr<Agent>> agents;
+    for (int seat = 0; seat < _config.players; ++seat) {
+        if (static_cast<size_t>(seat) < _config.agents.size() && _config.agents[static_cast<size_t>(seat)])
+            agents.push_back(_config.agents[static_cast<size_t>(seat)]());
+        else
+            agents.push_back(std::make_unique<RandomAgent>());
+    }
+    return agents;
+}
+
+void Simulator::playGame(std::vector<std::unique_ptr<Agent>>& agents, std::mt19937_64& rng,
+                         SimulationResult& result) const {
+    Game game;
+    game.setEventSink(_config.events);
+    std::vector<std::shared_ptr<Player>> players;
+    players.reserve(static_cast<size_t>(_config.players));
+    for (int seat = 0; seat < _config.players; ++seat) {
+        const std::string role = _config.roles.empty()
+            ? ROLE_NAMES[static_cast<size_t>(randomBelow(rng, static_cast<int>(ROLE_NAMES.size())))]
+            : _config.roles[static_cast<size_t>(seat)];
+        players.push_back(createPlayer(game, role, "P" + std::to_string(seat)));
+        game.addPlayer(players.back());
+    }
+    game.startGame();
+
+    int turns = 0;
+    while (!game.isGameOver() && turns < _config.maxTurns) {
+        Player* current = game.getCurrentPlayer().get();
+        int seat = 0;
+        while (players[static_cast<size_t>(seat)].get() != current) ++seat;
+        Agent& agent = *agents[static_cast<size_t>(seat)];
+
+        int actionsThisTurn = 0;
+        MoveList legal;
+        while (true) {
+            game.legalMoves(seat, legal);
+            if (legal.empty() || actionsThisTurn >= MAX_ACTIONS_PER_TURN) {
+                game.nextTurn();
+                ++result.forcedPasses;
+                break;
+            }
+            GameState state = game.snapshot();
+            Move move = agent.decide(GameView{state, seat, legal, actionsThisTurn, rng});
+            if (game.tryApply(seat, move) != MoveStatus::Ok) {
+                ++result.rejectedMoves;
+                ++actionsThisTurn;
+                continue;
+            }
+            ++result.actions;
+            ++actionsThisTurn;
+            if (game.isGameOver() || game.getCurrentPlayer().get() != current) break;
+        }
+        ++turns;
+    }
+
+    ++result.games;
+    result.turns += static_cast<std::uint64_t>(turns);
+    if (!game.isGameOver()) {
+        ++result.draws;
+        return;
+    }
+    for (size_t seat = 0; seat < players.size(); ++seat) {
+        if (!players[seat]->isActive()) continue;
+        ++result.winsBySeat[seat];
+        RoleId role = players[seat]->roleId();
+        if (role != RoleId::Player) ++result.winsByRole[static_cast<size_t>(role)];
+    }
+}
+
+SimulationResult Simulator::runGame(std::mt19937_64& rng) const {
+    auto agents = createAgents();
+    SimulationResult result;
+    auto start = std::chrono::steady_clock::now();
+    playGame(agents, rng, result);
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+SimulationResult Simulator::run(std::uint64_t games, unsigned threads) const {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    if (games < threads) threads = static_cast<unsigned>(std::max<std::uint64_t>(1, games));
+
+    std::vector<SimulationResult> partial(threads);
+    std::vector<std::exception_ptr> errors(threads);
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < threads; ++t) {
+        std::uint64_t share = games / threads + (t < games % threads ? 1 : 0);
+        workers.emplace_back([this, t, share, &partial, &errors] {
+            try {
+                // Independent RNG stream per thread, reproducible from the base seed
+                std::seed_seq seq{static_cast<std::uint32_t>(_config.seed),
+                                  static_cast<std::uint32_t>(_config.seed >> 32), t};
+                std::mt19937_64 rng(seq);
+                auto agents = createAgents();
+                for (std::uint64_t g = 0; g < share; ++g) playGame(agents, rng, partial[t]);
+            } catch (...) {
+                errors[t] = std::current_exception();
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    SimulationResult total;
+    for (unsigned t = 0; t < threads; ++t) {
+        if (errors[t]) std::rethrow_exception(errors[t]);
+        total += partial[t];
+    }
+    total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return total;
+}
+
+} // namespace coup
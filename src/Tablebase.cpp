@@ -0,0 +1,450 @@
+//tomergal40@gmail.com
+#include "../include/Tablebase.hpp"
+#include "../include/Exceptions.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace coup {
+
+namespace tablebase {
+
+namespace {
+
+const char MAGIC[8] = {'C', 'O', 'U', 'P', 'T', 'B', '\0', '\0'};
+const std::uint32_t VERSION = 1;
+const int MAX_PLIES = 127;
+const std::uint32_t SAME_SIDE = 1u << 31; // Edge flag: the move kept the turn
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t sections;
+    std::uint64_t offsets[SECTION_COUNT];   // From the start of the file
+    std::uint32_t lengths[SECTION_COUNT];   // 0 for sections not generated
+};
+
+// Optional fields of a section's key, which depend on the two roles
+struct Layout {
+    bool moverSpy;          // Spy target and arrest block of the mover
+    bool otherSpy;          // Spy target of the other side
+    bool moverBribe;        // Mover's bribe, undone by a Judge
+    bool otherUndoable;     // Other side's action the mover can undo
+    ActionType undoable;
+    int bits;
+};
+
+Layout layoutFor(RoleId mover, RoleId other) {
+    Layout layout{};
+    layout.moverSpy = mover == RoleId::Spy;
+    layout.otherSpy = other == RoleId::Spy;
+    layout.moverBribe = other == RoleId::Judge;
+    layout.otherUndoable = true;
+    switch (mover) {
+        case RoleId::Governor: layout.undoable = ActionType::Tax; break;
+        case RoleId::Judge: layout.undoable = ActionType::Bribe; break;
+        case RoleId::General: layout.undoable = ActionType::Coup; break;
+        default: layout.otherUndoable = false; break;
+    }
+    layout.bits = 4 + 1 + (layout.moverSpy ? 2 : 0) + (layout.moverBribe ? 1 : 0) +
+                  4 + 1 + 1 + (layout.otherSpy ? 1 : 0) + (layout.otherUndoable ? 1 : 0);
+    return layout;
+}
+
+std::size_t sectionOf(RoleId mover, RoleId other) {
+    return static_cast<std::size_t>(mover) * PLAYABLE_ROLE_COUNT + static_cast<std::size_t>(other);
+}
+
+std::uint32_t sectionLength(std::size_t section) {
+    Layout layout = layoutFor(static_cast<RoleId>(section / PLAYABLE_ROLE_COUNT),
+                              static_cast<RoleId>(section % PLAYABLE_ROLE_COUNT));
+    return 1u << layout.bits;
+}
+
+unsigned clampCoins(int coins) {
+    return static_cast<unsigned>(std::clamp(coins, 0, MAX_COINS));
+}
+
+// Key of the position seen from seat `m`, the seat to move, against seat `o`
+std::uint32_t encode(const GameState& state, int m, int o, const Layout& layout) {
+    const SeatState& self = state.seat(m);
+    const SeatState& other = state.seat(o);
+    std::uint32_t key = 0;
+    int shift = 0;
+    auto put = [&key, &shift](unsigned value, int bits) {
+        key |= value << shift;
+        shift += bits;
+    };
+    put(clampCoins(self.coins), 4);
+    put(self.lastArrested == o, 1);
+    if (layout.moverSpy) {
+        put(self.spyTarget >= 0, 1);
+        put(self.hasPending(ActionType::BlockArrest), 1);
+    }
+    if (layout.moverBribe) put(self.hasPending(ActionType::Bribe), 1);
+    put(clampCoins(other.coins), 4);
+    put(other.sanctioned(), 1);
+    put(other.lastArrested == m, 1);
+    if (layout.otherSpy) put(other.spyTarget >= 0, 1);
+    if (layout.otherUndoable) put(other.hasPending(layout.undoable), 1);
+    return key;
+}
+
+void setPending(SeatState& seat, ActionType type, bool on) {
+    if (on) seat.pending = static_cast<std::uint16_t>(seat.pending | (1u << static_cast<unsigned>(type)));
+}
+
+// Two seat position for a key: the mover sits in seat 0
+GameState decode(RoleId mover, RoleId other, const Layout& layout, std::uint32_t key) {
+    const RoleId roles[] = {mover, other};
+    GameState state = rules::initialState(roles, 2);
+    state.bank = GENERATOR_BANK;
+    auto take = [&key](int bits) {
+        unsigned value = key & ((1u << bits) - 1);
+        key >>= bits;
+        return value;
+    };
+    SeatState& self = state.seat(0);
+    SeatState& opponent = state.seat(1);
+    self.coins = static_cast<std::int16_t>(take(4));
+    if (take(1)) self.lastArrested = 1;
+    if (layout.moverSpy) {
+        if (take(1)) self.spyTarget = 1;
+        setPending(self, ActionType::BlockArrest, take(1));
+    }
+    if (layout.moverBribe) setPending(self, ActionType::Bribe, take(1));
+    opponent.coins = static_cast<std::int16_t>(take(4));
+    if (take(1)) opponent.flags = SEAT_ACTIVE | SEAT_SANCTIONED;
+    if (take(1)) opponent.lastArrested = 0;
+    if (layout.otherSpy && take(1)) opponent.spyTarget = 0;
+    if (layout.otherUndoable) setPending(opponent, layout.undoable, take(1));
+    return state;
+}
+
+std::uint8_t winIn(int plies) {
+    if (plies > MAX_PLIES) throw GameException("Tablebase distance exceeds 127 plies!");
+    return static_cast<std::uint8_t>(plies);
+}
+
+std::uint8_t lossIn(int plies) {
+    if (plies > MAX_PLIES) throw GameException("Tablebase distance exceeds 127 plies!");
+    return static_cast<std::uint8_t>(128 + plies);
+}
+
+bool isWin(std::uint8_t value) { return value != 0 && value < 128; }
+bool isLoss(std::uint8_t value) { return value > 128; }
+int pliesOf(std::uint8_t value) { return value < 128 ? value : value - 128; }
+
+// One of the sections solved together
+struct Part {
+    RoleId mover;
+    RoleId other;
+    Layout layout;
+    std::uint32_t base;
+};
+
+// Retrograde analysis of (a, b) and its mirror (b, a). Every position gets
+// the list of positions its moves lead to; positions where a coup is legal
+// are wins in one, and values then spread backwards in breadth first order:
+// a position is a win as soon as one move reaches a loss for the side that
+// moves next, and a loss once every move reaches a win for it. Whatever is
+// left unresolved can be kept going forever by both sides and is a draw.
+void solvePair(RoleId a, RoleId b, std::vector<std::uint8_t>& valuesAB, std::vector<std::uint8_t>& valuesBA) {
+    std::vector<Part> parts;
+    parts.push_back({a, b, layoutFor(a, b), 0});
+    if (a != b) parts.push_back({b, a, layoutFor(b, a), 1u << parts[0].layout.bits});
+    std::uint32_t total = 0;
+    for (const Part& part : parts) total += 1u << part.layout.bits;
+
+    auto indexOf = [&parts](const GameState& state) {
+        int m = state.currentTurn;
+        int o = 1 - m;
+        const Part& part = state.seat(m).role == parts[0].mover ? parts[0] : parts.back();
+        return part.base + encode(state, m, o, part.layout);
+    };
+
+    // Forward edges in compressed rows
+    std::vector<std::uint32_t> edgeStart(static_cast<std::size_t>(total) + 1, 0);
+    std::vector<std::uint32_t> edges;
+    std::vector<std::uint8_t> values(total, 0);
+    std::vector<std::uint32_t> queue;
+    queue.reserve(total);
+    MoveList moves;
+    for (const Part& part : parts) {
+        std::uint32_t size = 1u << part.layout.bits;
+        for (std::uint32_t key = 0; key < size; ++key) {
+            std::uint32_t index = part.base + key;
+            edgeStart[index] = static_cast<std::uint32_t>(edges.size());
+            GameState state = decode(part.mover, part.other, part.layout, key);
+            if (state.seat(0).coins >= 7) {
+                values[index] = winIn(1);
+                queue.push_back(index);
+                continue;
+            }
+            rules::legalMoves(state, 0, moves);
+            if (moves.empty()) {
+                GameState next = state;
+                rules::nextTurn(next);
+                edges.push_back(indexOf(next));
+                continue;
+            }
+            for (const Move& move : moves) {
+                GameState next = state;
+                rules::apply(next, 0, move);
+                std::uint32_t child = indexOf(next);
+                edges.push_back(next.currentTurn == 0 ? child | SAME_SIDE : child);
+            }
+        }
+    }
+    edgeStart[total] = static_cast<std::uint32_t>(edges.size());
+
+    // Reverse edges, so a resolved position can update its predecessors
+    std::vector<std::uint32_t> predStart(static_cast<std::size_t>(total) + 1, 0);
+    for (std::uint32_t edge : edges) ++predStart[(edge & ~SAME_SIDE) + 1];
+    for (std::uint32_t i = 0; i < total; ++i) predStart[i + 1] += predStart[i];
+    std::vector<std::uint32_t> preds(edges.size());
+    std::vector<std::uint32_t> fill(predStart.begin(), predStart.end() - 1);
+    std::vector<std::uint32_t> remaining(total);
+    for (std::uint32_t parent = 0; parent < total; ++parent) {
+        remaining[parent] = edgeStart[parent + 1] - edgeStart[parent];
+        for (std::uint32_t e = edgeStart[parent]; e < edgeStart[parent + 1]; ++e)
+            preds[fill[edges[e] & ~SAME_SIDE]++] = parent | (edges[e] & SAME_SIDE);
+    }
+
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        std::uint32_t child = queue[head];
+        std::uint8_t value = values[child];
+        int plies = pliesOf(value);
+        for (std::uint32_t p = predStart[child]; p < predStart[child + 1]; ++p) {
+            std::uint32_t parent = preds[p] & ~SAME_SIDE;
+            if (values[parent] != 0) continue;
+            bool winsParent = (preds[p] & SAME_SIDE) ? isWin(value) : isLoss(value);
+            if (winsParent) {
+                values[parent] = winIn(plies + 1);
+                queue.push_back(parent);
+            } else if (--remaining[parent] == 0) {
+                values[parent] = lossIn(plies + 1);
+                queue.push_back(parent);
+            }
+        }
+    }
+
+    valuesAB.assign(values.begin(), values.begin() + (1u << parts[0].layout.bits));
+    if (a != b) valuesBA.assign(values.begin() + parts[1].base, values.end());
+}
+
+} // namespace
+
+std::vector<std::pair<RoleId, RoleId>> allPairings() {
+    std::vector<std::pair<RoleId, RoleId>> pairings;
+    for (std::size_t mover = 0; mover < PLAYABLE_ROLE_COUNT; ++mover)
+        for (std::size_t other = 0; other < PLAYABLE_ROLE_COUNT; ++other)
+            pairings.emplace_back(static_cast<RoleId>(mover), static_cast<RoleId>(other));
+    return pairings;
+}
+
+std::vector<TablebaseSection> generate(const std::string& path, const std::vector<std::pair<RoleId, RoleId>>& pairings) {
+    std::vector<std::vector<std::uint8_t>> tables(SECTION_COUNT);
+    for (const auto& [mover, other] : pairings) {
+        if (static_cast<std::size_t>(mover) >= PLAYABLE_ROLE_COUNT || static_cast<std::size_t>(other) >= PLAYABLE_ROLE_COUNT)
+            throw GameException("Tablebase pairings must use playable roles!");
+        if (!tables[sectionOf(mover, other)].empty()) continue;
+        solvePair(mover, other, tables[sectionOf(mover, other)], tables[sectionOf(other, mover)]);
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.sections = static_cast<std::uint32_t>(SECTION_COUNT);
+    std::uint64_t offset = sizeof(FileHeader);
+    std::vector<TablebaseSection> sections;
+    for (std::size_t section = 0; section < SECTION_COUNT; ++section) {
+        const std::vector<std::uint8_t>& table = tables[section];
+        header.offsets[section] = offset;
+        header.lengths[section] = static_cast<std::uint32_t>(table.size());
+        offset += table.size();
+        if (table.empty()) continue;
+
+        TablebaseSection stats;
+        stats.mover = static_cast<RoleId>(section / PLAYABLE_ROLE_COUNT);
+        stats.other = static_cast<RoleId>(section % PLAYABLE_ROLE_COUNT);
+        stats.positions = table.size();
+        for (std::uint8_t value : table) {
+            if (isWin(value)) ++stats.wins;
+            else if (isLoss(value)) ++stats.losses;
+            else ++stats.draws;
+        }
+        sections.push_back(stats);
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) throw GameException("Cannot create tablebase file " + path);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto& table : tables)
+        out.write(reinterpret_cast<const char*>(table.data()), static_cast<std::streamsize>(table.size()));
+    if (!out) throw GameException("Cannot write tablebase file " + path);
+    return sections;
+}
+
+} // namespace tablebase
+
+Tablebase::Tablebase(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw GameException("Cannot open tablebase file " + path);
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(tablebase::FileHeader)) {
+        ::close(fd);
+        throw GameException("Tablebase file is truncated: " + path);
+    }
+    _size = static_cast<std::size_t>(info.st_size);
+    void* mapped = ::mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // The mapping stays valid
+    if (mapped == MAP_FAILED) throw GameException("Cannot map tablebase file " + path);
+    _data = static_cast<const std::uint8_t*>(mapped);
+
+    tablebase::FileHeader header;
+    std::memcpy(&header, _data, sizeof(header));
+    if (std::memcmp(header.magic, tablebase::MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != tablebase::VERSION || header.sections != tablebase::SECTION_COUNT) {
+        release();
+        throw GameException("Not a tablebase file of this version: " + path);
+    }
+    for (std::size_t section = 0; section < tablebase::SECTION_COUNT; ++section) {
+        std::uint32_t length = header.lengths[section];
+        if ((length != 0 && length != tablebase::sectionLength(section)) || header.offsets[section] > _size ||
+            length > _size - header.offsets[section]) {
+            release();
+            throw GameException("Tablebase file is corrupt: " + path);
+        }
+        _offsets[section] = header.offsets[section];
+        _lengths[section] = length;
+    }
+}
+
+Tablebase::~Tablebase() { release(); }
+
+Tablebase::Tablebase(Tablebase&& other) noexcept { *this = std::move(other); }
+
+Tablebase& Tablebase::operator=(Tablebase&& other) noexcept {
+    if (this != &other) {
+        release();
+        _data = other._data;
+        _size = other._size;
+        std::copy(std::begin(other._offsets), std::end(other._offsets), _offsets);
+        std::copy(std::begin(other._lengths), std::end(other._lengths), _lengths);
+        other._data = nullptr;
+        other._size = 0;
+    }
+    return *this;
+}
+
+void Tablebase::release() {
+    if (_data) ::munmap(const_cast<std::uint8_t*>(_data), _size);
+    _data = nullptr;
+    _size = 0;
+}
+
+std::size_t Tablebase::positions() const {
+    std::size_t total = 0;
+    for (std::uint32_t length : _lengths) total += length;
+    return total;
+}
+
+bool Tablebase::hasSection(RoleId mover, RoleId other) const {
+    if (static_cast<std::size_t>(mover) >= PLAYABLE_ROLE_COUNT || static_cast<std::size_t>(other) >= PLAYABLE_ROLE_COUNT)
+        return false;
+    return _lengths[tablebase::sectionOf(mover, other)] != 0;
+}
+
+int Tablebase::locate(const GameState& state, std::uint32_t& key) const {
+    if (!_data || rules::countActive(state) != 2) return -1;
+    int m = state.currentTurn;
+    int o = -1;
+    bool general = false;
+    for (int i = 0; i < state.playerCount; ++i) {
+        const SeatState& seat = state.seat(i);
+        if (seat.active() && i != m) o = i;
+        if (seat.active() && seat.role == RoleId::General) general = true;
+    }
+    if (m >= state.playerCount || !state.seat(m).active() || o < 0) return -1;
+    // A General can revive an eliminated seat whose coup is still pending
+    if (general) {
+        for (int i = 0; i < state.playerCount; ++i)
+            if (!state.seat(i).active() && state.seat(i).hasPending(ActionType::Coup)) return -1;
+    }
+
+    const SeatState& self = state.seat(m);
+    const SeatState& other = state.seat(o);
+    if (!hasSection(self.role, other.role)) return -1;
+    const std::uint8_t unsanctioned = SEAT_ACTIVE | SEAT_CAN_GATHER | SEAT_CAN_TAX;
+    if (self.flags != unsanctioned) return -1;
+    if (other.flags != unsanctioned && other.flags != (SEAT_ACTIVE | SEAT_SANCTIONED)) return -1;
+
+    std::size_t section = tablebase::sectionOf(self.role, other.role);
+    key = tablebase::encode(state, m, o, tablebase::layoutFor(self.role, other.role));
+    return static_cast<int>(section);
+}
+
+TablebaseEntry Tablebase::entry(int section, std::uint32_t key) const {
+    std::uint8_t value = _data[_offsets[section] + key];
+    TablebaseEntry result;
+    if (value == 0) result.value = TablebaseValue::Draw;
+    else result.value = tablebase::isWin(value) ? TablebaseValue::Win : TablebaseValue::Loss;
+    result.plies = tablebase::pliesOf(value);
+    return result;
+}
+
+bool Tablebase::covers(const GameState& state) const {
+    std::uint32_t key;
+    return state.bank >= tablebase::MIN_BANK && locate(state, key) >= 0;
+}
+
+TablebaseEntry Tablebase::probe(const GameState& state) const {
+    std::uint32_t key;
+    if (state.bank < tablebase::MIN_BANK) return TablebaseEntry{};
+    int section = locate(state, key);
+    return section < 0 ? TablebaseEntry{} : entry(section, key);
+}
+
+TablebaseEntry Tablebase::probe(const Game& game) const {
+    return probe(game.snapshot());
+}
+
+bool Tablebase::bestMove(const GameState& state, Move& move) const {
+    if (!covers(state)) return false;
+    MoveList moves;
+    rules::legalMoves(state, state.currentTurn, moves);
+
+    // Higher is better: wins by fewest plies, then draws, then losses by most plies
+    int bestScore = -1000;
+    for (const Move& candidate : moves) {
+        GameState next = state;
+        rules::apply(next, state.currentTurn, candidate);
+        int score;
+        if (rules::isGameOver(next)) {
+            score = 1000;
+        } else {
+            std::uint32_t key;
+            int section = locate(next, key);
+            if (section < 0) continue;
+            TablebaseEntry child = entry(section, key);
+            bool sameSide = next.currentTurn == state.currentTurn;
+            TablebaseValue value = child.value;
+            if (!sameSide && value == TablebaseValue::Win) value = TablebaseValue::Loss;
+            else if (!sameSide && value == TablebaseValue::Loss) value = TablebaseValue::Win;
+            score = value == TablebaseValue::Win ? 1000 - child.plies
+                  : value == TablebaseValue::Draw ? 0 : -1000 + child.plies;
+        }
+        if (score > bestScore) {
+            bestScore = score;
+            move = candidate;
+        }
+    }
+    return bestScore > -1000;
+}
+
+} // namespace coup
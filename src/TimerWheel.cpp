@@ -0,0 +1,115 @@
+//tomergal40@gmail.com
+#include "../include/TimerWheel.hpp"
+#include "../include/Exceptions.hpp"
+
+namespace coup {
+
+TimerWheel::TimerWheel(std::function<void(std::uint64_t data)> expire, std::uint64_t now)
+    : _expire(std::move(expire)), _now(now) {
+    if (!_expire) throw GameException("A timer wheel needs an expiry handler!");
+    _slots.fill(NIL);
+}
+
+void TimerWheel::link(std::uint32_t index) {
+    Timer& timer = _timers[index];
+    std::uint64_t delta = timer.deadline - _now;
+    unsigned level = 0;
+    while (level + 1 < LEVELS && delta >= (std::uint64_t(1) << (SLOT_BITS * (level + 1)))) ++level;
+    std::uint64_t tick = timer.deadline;
+    if (delta >> (SLOT_BITS * LEVELS)) {
+        // Beyond the top level's reach: park in its last slot and come back
+        // down (still early) when that slot is cascaded
+        tick = _now + (std::uint64_t(SLOTS - 1) << (SLOT_BITS * (LEVELS - 1)));
+    }
+    unsigned slot = level * SLOTS + static_cast<unsigned>((tick >> (SLOT_BITS * level)) & (SLOTS - 1));
+    timer.slot = static_cast<std::uint16_t>(slot);
+    timer.prev = NIL;
+    timer.next = _slots[slot];
+    if (timer.next != NIL) _timers[timer.next].prev = index;
+    _slots[slot] = index;
+}
+
+void TimerWheel::unlink(std::uint32_t index) {
+    Timer& timer = _timers[index];
+    if (timer.prev != NIL) _timers[timer.prev].next = timer.next;
+    else _slots[timer.slot] = timer.next;
+    if (timer.next != NIL) _timers[timer.next].prev = timer.prev;
+}
+
+void TimerWheel::release(std::uint32_t index) {
+    Timer& timer = _timers[index];
+    timer.live = false;
+    ++timer.generation;
+    timer.next = _free;
+    _free = index;
+    --_size;
+}
+
+TimerId TimerWheel::schedule(std::uint64_t deadline, std::uint64_t data) {
+    std::uint32_t index;
+    if (_free != NIL) {
+        index = _free;
+        _free = _timers[index].next;
+    } else {
+        if (_timers.size() >= NIL) throw GameException("Too many timers!");
+        index = static_cast<std::uint32_t>(_timers.size());
+        _timers.emplace_back();
+    }
+    Timer& timer = _timers[index];
+    timer.deadline = deadline > _now ? deadline : _now + 1;
+    timer.data = data;
+    timer.live = true;
+    ++_size;
+    link(index);
+    return (static_cast<TimerId>(timer.generation) << 32) | (index + 1);
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    std::uint32_t low = static_cast<std::uint32_t>(id);
+    if (low == 0 || low > _timers.size()) return false;
+    std::uint32_t index = low - 1;
+    Timer& timer = _timers[index];
+    if (!timer.live || timer.generation != static_cast<std::uint32_t>(id >> 32)) return false;
+    unlink(index);
+    release(index);
+    return true;
+}
+
+void TimerWheel::cascade(unsigned level) {
+    unsigned slot = level * SLOTS + static_cast<unsigned>((_now >> (SLOT_BITS * level)) & (SLOTS - 1));
+    std::uint32_t index = _slots[slot];
+    _slots[slot] = NIL;
+    while (index != NIL) {
+        std::uint32_t next = _timers[index].next;
+        link(index);
+        index = next;
+    }
+}
+
+void TimerWheel::advance(std::uint64_t now) {
+    while (_now < now) {
+        if (_size == 0) {
+            _now = now;
+            return;
+        }
+        ++_now;
+        // When level 0 wraps, bring down the slots of every level that wrapped,
+        // highest first, so timers can fall through several levels at once
+        if ((_now & (SLOTS - 1)) == 0) {
+            unsigned top = 1;
+            while (top + 1 < LEVELS && (_now & ((std::uint64_t(1) << (SLOT_BITS * (top + 1))) - 1)) == 0) ++top;
+            for (unsigned level = top; level >= 1; --level) cascade(level);
+        }
+
+        unsigned slot = static_cast<unsigned>(_now & (SLOTS - 1));
+        while (_slots[slot] != NIL) {
+            std::uint32_t index = _slots[slot];
+            std::uint64_t data = _timers[index].data;
+            unlink(index);
+            release(index);
+            _expire(data);
+        }
+    }
+}
+
+} // namespace coup
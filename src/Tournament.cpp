@@ -0,0 +1,239 @@
+//tomergal40@gmail.com
+#include "../include/Tournament.hpp"
+#include "../include/Exceptions.hpp"
+#include "../include/Game.hpp"
+#include "../include/Playout.hpp"
+#include "../include/Simulator.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <memory>
+#include <random>
+#include <thread>
+
+namespace coup {
+
+namespace {
+
+// One match: agents[s] plays seat s with role roles[s]
+struct MatchPlan {
+    int agents[2];
+    int roles[2];                // Indices into TournamentConfig::roles
+};
+
+// Results counted by one thread
+struct Tally {
+    std::uint64_t games = 0;
+    std::uint64_t draws = 0;
+    std::vector<std::uint64_t> wins;
+    std::vector<std::uint64_t> drawn;
+};
+
+// Plays one game from the position the game is in; returns the winning
+// seat, or -1 if the turn limit is reached
+int playGame(Game& game, Agent* const seats[2], std::mt19937_64& rng, int maxTurns) {
+    MoveList legal;
+    int turns = 0;
+    while (!game.isGameOver() && turns < maxTurns) {
+        GameState state = game.snapshot();
+        int seat = state.currentTurn;
+        int actions = 0;
+        while (true) {
+            rules::legalMoves(state, seat, legal);
+            if (legal.empty() || actions >= MAX_ACTIONS_PER_TURN) {
+                game.nextTurn();
+                break;
+            }
+            Move move = seats[seat]->decide(GameView{state, seat, legal, actions, rng});
+            ++actions;
+            MoveStatus status = game.tryApply(seat, move);
+            if (status == MoveStatus::Ok && game.isGameOver()) break;
+            state = game.snapshot();
+            if (state.currentTurn != seat) break;
+        }
+        ++turns;
+    }
+    return rules::winner(game.snapshot());
+}
+
+} // namespace
+
+Tournament::Tournament(TournamentConfig config) : _config(std::move(config)) {
+    if (_config.agents.size() < 2) throw GameException("A tournament needs at least two agents!");
+    if (_config.roles.empty()) throw GameException("A tournament needs at least one role!");
+    for (RoleId role : _config.roles)
+        if (static_cast<std::size_t>(role) >= PLAYABLE_ROLE_COUNT) throw GameException("Tournament roles must be playable roles!");
+    if (_config.gamesPerMatch == 0) throw GameException("Matches need at least one game!");
+    if (_config.maxTurns <= 0) throw GameException("Turn limit must be positive!");
+    for (const auto& name : _config.agents) _factories.push_back(makeAgentFactory(name));
+    if (_config.threads == 0) _config.threads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+std::uint64_t Tournament::totalGames() const {
+    std::uint64_t agents = _config.agents.size();
+    std::uint64_t roles = _config.roles.size();
+    return agents * (agents - 1) * roles * roles * _config.gamesPerMatch;
+}
+
+TournamentResult Tournament::run() const {
+    const std::size_t agentCount = _config.agents.size();
+    const std::size_t roleCount = _config.roles.size();
+    std::vector<MatchPlan> matches;
+    for (std::size_t a = 0; a < agentCount; ++a)
+        for (std::size_t b = 0; b < agentCount; ++b)
+            for (std::size_t r0 = 0; r0 < roleCount && a != b; ++r0)
+                for (std::size_t r1 = 0; r1 < roleCount; ++r1)
+                    matches.push_back({{static_cast<int>(a), static_cast<int>(b)}, {static_cast<int>(r0), static_cast<int>(r1)}});
+
+    unsigned threads = static_cast<unsigned>(std::min<std::size_t>(_config.threads, matches.size()));
+    std::vector<Tally> tallies(threads);
+    std::vector<std::exception_ptr> errors(threads);
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    std::atomic<std::size_t> nextMatch{0};
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([this, t, agentCount, roleCount, &matches, &nextMatch, &tallies, &errors] {
+            try {
+                Tally& tally = tallies[t];
+                tally.wins.assign(agentCount * agentCount, 0);
+                tally.drawn.assign(agentCount * agentCount, 0);
+                std::vector<std::unique_ptr<Agent>> agents;
+                for (const auto& factory : _factories) agents.push_back(factory());
+
+                // One reusable game per role assignment, with its opening position
+                std::vector<std::unique_ptr<Game>> games(roleCount * roleCount);
+                std::vector<GameState> openings(roleCount * roleCount);
+
+                while (true) {
+                    std::size_t m = nextMatch.fetch_add(1, std::memory_order_relaxed);
+                    if (m >= matches.size()) break;
+                    const MatchPlan& plan = matches[m];
+                    std::size_t slot = static_cast<std::size_t>(plan.roles[0]) * roleCount + static_cast<std::size_t>(plan.roles[1]);
+                    if (!games[slot]) {
+                        games[slot] = std::make_unique<Game>();
+                        Game& game = *games[slot];
+                        game.setEventSink(nullptr);
+                        for (int seat = 0; seat < 2; ++seat) {
+                            RoleId role = _config.roles[static_cast<std::size_t>(plan.roles[seat])];
+                            game.addPlayer(createPlayer(game, toString(role), "P" + std::to_string(seat)));
+                        }
+                        game.startGame();
+                        openings[slot] = game.snapshot();
+                    }
+                    Game& game = *games[slot];
+                    Agent* const seats[2] = {agents[static_cast<std::size_t>(plan.agents[0])].get(),
+                                             agents[static_cast<std::size_t>(plan.agents[1])].get()};
+
+                    // The stream depends on the match only, so results do not depend on the thread count
+                    std::seed_seq seq{static_cast<std::uint32_t>(_config.seed), static_cast<std::uint32_t>(_config.seed >> 32),
+                                      static_cast<std::uint32_t>(m)};
+                    std::mt19937_64 rng(seq);
+                    std::size_t a = static_cast<std::size_t>(plan.agents[0]);
+                    std::size_t b = static_cast<std::size_t>(plan.agents[1]);
+                    for (std::uint64_t g = 0; g < _config.gamesPerMatch; ++g) {
+                        game.restore(openings[slot]);
+                        int winner = playGame(game, seats, rng, _config.maxTurns);
+                        ++tally.games;
+                        if (winner == 0) {
+                            ++tally.wins[a * agentCount + b];
+                        } else if (winner == 1) {
+                            ++tally.wins[b * agentCount + a];
+                        } else {
+                            ++tally.draws;
+                            ++tally.drawn[a * agentCount + b];
+                            ++tally.drawn[b * agentCount + a];
+                        }
+                    }
+                }
+            } catch (...) {
+                errors[t] = std::current_exception();
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    for (const auto& error : errors)
+        if (error) std::rethrow_exception(error);
+
+    TournamentResult result;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.agentCount = agentCount;
+    result.wins.assign(agentCount * agentCount, 0);
+    result.drawn.assign(agentCount * agentCount, 0);
+    for (const Tally& tally : tallies) {
+        result.games += tally.games;
+        result.draws += tally.draws;
+        for (std::size_t i = 0; i < tally.wins.size(); ++i) {
+            result.wins[i] += tally.wins[i];
+            result.drawn[i] += tally.drawn[i];
+        }
+    }
+
+    result.standings.resize(agentCount);
+    for (std::size_t a = 0; a < agentCount; ++a) {
+        AgentStanding& standing = result.standings[a];
+        standing.name = _config.agents[a];
+        for (std::size_t b = 0; b < agentCount; ++b) {
+            standing.wins += result.winsOf(a, b);
+            standing.losses += result.winsOf(b, a);
+            standing.draws += result.drawn[a * agentCount + b];
+        }
+        standing.games = standing.wins + standing.losses + standing.draws;
+    }
+    rate(result);
+    return result;
+}
+
+void Tournament::rate(TournamentResult& result) {
+    const std::size_t n = result.agentCount;
+    if (result.standings.size() != n) result.standings.resize(n);
+    auto games = [&result, n](std::size_t a, std::size_t b) {
+        return static_cast<double>(result.wins[a * n + b] + result.wins[b * n + a] + result.drawn[a * n + b]) + 1.0;
+    };
+    std::vector<double> score(n, 0.0);
+    for (std::size_t a = 0; a < n; ++a) {
+        for (std::size_t b = 0; b < n; ++b) {
+            if (a == b) continue;
+            score[a] += static_cast<double>(result.wins[a * n + b]) + 0.5 * static_cast<double>(result.drawn[a * n + b]) + 0.5;
+        }
+    }
+
+    // Minorization-maximization updates of the strengths, kept at geometric mean 1
+    std::vector<double> strength(n, 1.0);
+    std::vector<double> next(n);
+    for (int iteration = 0; iteration < 10000; ++iteration) {
+        for (std::size_t a = 0; a < n; ++a) {
+            double denominator = 0.0;
+            for (std::size_t b = 0; b < n; ++b)
+                if (a != b) denominator += games(a, b) / (strength[a] + strength[b]);
+            next[a] = score[a] / denominator;
+        }
+        double logMean = 0.0;
+        for (double s : next) logMean += std::log(s);
+        logMean /= static_cast<double>(n);
+        double change = 0.0;
+        for (std::size_t a = 0; a < n; ++a) {
+            double updated = next[a] / std::exp(logMean);
+            change = std::max(change, std::fabs(updated - strength[a]) / strength[a]);
+            strength[a] = updated;
+        }
+        if (change < 1e-12) break;
+    }
+
+    const double scale = 400.0 / std::log(10.0);
+    for (std::size_t a = 0; a < n; ++a) {
+        double information = 0.0;
+        for (std::size_t b = 0; b < n; ++b) {
+            if (a == b) continue;
+            double p = strength[a] / (strength[a] + strength[b]);
+            information += games(a, b) * p * (1.0 - p);
+        }
+        result.standings[a].elo = 1500.0 + scale * std::log(strength[a]);
+        result.standings[a].eloMargin = information > 0.0 ? 1.96 * scale / std::sqrt(information) : 0.0;
+    }
+}
+
+} // namespace coup
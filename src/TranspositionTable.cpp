@@ -0,0 +1,64 @@
+//tomergal40@gmail.com
+#include "../include/TranspositionTable.hpp"
+
+namespace coup {
+
+// Data word layout:
+//   bits  0-31  value
+//   bits 32-39  depth
+//   bits 40-41  bound
+//   bits 42-45  best move type
+//   bits 46-49  best move target + 1
+std::uint64_t TranspositionTable::pack(std::int32_t value, int depth, Bound bound, const Move& best) {
+    return static_cast<std::uint64_t>(static_cast<std::uint32_t>(value)) |
+           (static_cast<std::uint64_t>(static_cast<std::uint8_t>(depth)) << 32) |
+           (static_cast<std::uint64_t>(bound) << 40) |
+           (static_cast<std::uint64_t>(best.type) << 42) |
+           (static_cast<std::uint64_t>(best.target + 1) << 46);
+}
+
+TranspositionTable::TranspositionTable(std::size_t megabytes) {
+    std::size_t entries = (megabytes * 1024 * 1024) / sizeof(Entry);
+    std::size_t capacity = 1;
+    while (capacity * 2 <= entries) capacity *= 2;
+    _entries = std::make_unique<Entry[]>(capacity);
+    _mask = capacity - 1;
+}
+
+bool TranspositionTable::probe(std::uint64_t key, TTHit& hit) const {
+    const Entry& entry = _entries[key & _mask];
+    std::uint64_t data = entry.data.load(std::memory_order_relaxed);
+    std::uint64_t check = entry.check.load(std::memory_order_relaxed);
+    if ((check ^ data) != key) return false;
+
+    Bound bound = static_cast<Bound>((data >> 40) & 0x3);
+    if (bound == Bound::None) return false; // Never stored
+    hit.value = static_cast<std::int32_t>(static_cast<std::uint32_t>(data));
+    hit.depth = static_cast<std::int8_t>(static_cast<std::uint8_t>(data >> 32));
+    hit.bound = bound;
+    hit.best.type = static_cast<MoveType>((data >> 42) & 0xF);
+    hit.best.target = static_cast<int>((data >> 46) & 0xF) - 1;
+    return true;
+}
+
+void TranspositionTable::store(std::uint64_t key, std::int32_t value, int depth, Bound bound, const Move& best) {
+    Entry& entry = _entries[key & _mask];
+    std::uint64_t oldData = entry.data.load(std::memory_order_relaxed);
+    std::uint64_t oldCheck = entry.check.load(std::memory_order_relaxed);
+    if ((oldCheck ^ oldData) == key) {
+        int oldDepth = static_cast<std::int8_t>(static_cast<std::uint8_t>(oldData >> 32));
+        if (oldDepth > depth) return;
+    }
+    std::uint64_t data = pack(value, depth, bound, best);
+    entry.data.store(data, std::memory_order_relaxed);
+    entry.check.store(key ^ data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear() {
+    for (std::size_t i = 0; i <= _mask; ++i) {
+        _entries[i].data.store(0, std::memory_order_relaxed);
+        _entries[i].check.store(0, std::memory_order_relaxed);
+    }
+}
+
+} // namespace coup
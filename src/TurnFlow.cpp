@@ -0,0 +1,338 @@
+//tomergal40@gmail.com
+#include "../include/TurnFlow.hpp"
+#include "../include/Exceptions.hpp"
+#include "../include/GameState.hpp"
+#include <utility>
+
+namespace coup {
+
+FlowTask& FlowTask::operator=(FlowTask&& other) noexcept {
+    if (this != &other) {
+        if (_handle) _handle.destroy();
+        _handle = std::exchange(other._handle, nullptr);
+    }
+    return *this;
+}
+
+FlowTask::~FlowTask() {
+    if (_handle) _handle.destroy();
+}
+
+struct TurnFlow::FlowGame {
+    enum class Wait : std::uint8_t { None, Move, Reactions };
+
+    GameId id = 0;
+    Game* game = nullptr;
+    Wait wait = Wait::None;
+    int seat = -1;                  // Seat whose move is awaited
+    std::uint32_t blockers = 0;     // Seats that may still block, while Wait::Reactions
+    Move proposed;
+    MoveCallback done;              // Reply for the proposed move
+    std::coroutine_handle<> handle; // Where the loop is suspended
+    TimerId timer = 0;              // Clock of the current wait
+    FlowTask task;
+};
+
+struct TurnFlow::MoveAwaiter {
+    TurnFlow& owner;
+    FlowGame& flow;
+    int seat;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) {
+        flow.wait = FlowGame::Wait::Move;
+        flow.seat = seat;
+        flow.handle = handle;
+        owner._waiting.fetch_add(1, std::memory_order_relaxed);
+        owner.arm(flow, owner._config.turnMillis, false);
+        if (owner._config.onAwaitMove) owner._config.onAwaitMove(flow.id, *flow.game, seat);
+    }
+    Move await_resume() const noexcept { return flow.proposed; }
+};
+
+struct TurnFlow::WindowAwaiter {
+    TurnFlow& owner;
+    FlowGame& flow;
+    std::uint32_t blockers;
+
+    bool await_ready() const noexcept { return blockers == 0; }
+    void await_suspend(std::coroutine_handle<> handle) {
+        flow.wait = FlowGame::Wait::Reactions;
+        flow.blockers = blockers;
+        flow.handle = handle;
+        owner._waiting.fetch_add(1, std::memory_order_relaxed);
+        owner.arm(flow, owner._config.reactionMillis, true);
+        if (owner._config.onReactionWindow) owner._config.onReactionWindow(flow.id, *flow.game, blockers);
+    }
+    void await_resume() const noexcept {}
+};
+
+namespace {
+
+// Seats other than `actor` able to undo the move it just played
+std::uint32_t blockersOf(const GameState& state, int actor, const Move& move) {
+    RoleId blocker;
+    switch (move.type) {
+        case MoveType::Tax: blocker = RoleId::Governor; break;
+        case MoveType::Bribe: blocker = RoleId::Judge; break;
+        case MoveType::Coup: blocker = RoleId::General; break;
+        default: return 0;
+    }
+    std::uint32_t seats = 0;
+    for (int seat = 0; seat < state.playerCount; ++seat) {
+        if (seat == actor || state.seat(seat).role != blocker) continue;
+        if (rules::check(state, seat, Move{MoveType::Undo, actor}) == MoveStatus::Ok) seats |= 1u << seat;
+    }
+    return seats;
+}
+
+// Move played for a seat whose clock ran out
+Move defaultMove(const Game& game, int seat) {
+    MoveList legal;
+    game.legalMoves(seat, legal);
+    if (legal.empty()) return Move{MoveType::Gather, -1};
+    bool mustCoup = game.snapshot().seat(seat).mustCoup();
+    for (const Move& move : legal)
+        if (move.type == (mustCoup ? MoveType::Coup : MoveType::Gather)) return move;
+    return legal[0];
+}
+
+const std::uint64_t WINDOW_TIMER = std::uint64_t(1) << 32;   // Timer payload: game id, plus this for windows
+
+} // namespace
+
+TurnFlow::TurnFlow(GameHost& host, TurnFlowConfig config)
+    : _host(host), _config(std::move(config)), _flows(host.shardCount()), _epoch(std::chrono::steady_clock::now()) {
+    if (_config.tickMillis == 0) throw GameException("The clock tick must be at least 1 ms!");
+    for (unsigned s = 0; s < host.shardCount(); ++s)
+        _wheels.push_back(std::make_unique<TimerWheel>([this](std::uint64_t data) { expire(data); }));
+    if (_config.turnMillis || _config.reactionMillis) _ticker = std::thread([this] { tick(); });
+}
+
+TurnFlow::~TurnFlow() {
+    if (_ticker.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(_tickerMutex);
+            _stopping = true;
+        }
+        _tickerWake.notify_all();
+        _ticker.join();
+    }
+    // Games outliving the flow must not call back into it when closed
+    for (unsigned s = 0; s < _host.shardCount(); ++s)
+        _host.postToShard(s, [this, s] {
+            for (const std::unique_ptr<FlowGame>& flow : _flows[s])
+                if (flow) _host.forgetClose(flow->id, this);
+        });
+    _host.drain();
+}
+
+std::uint64_t TurnFlow::currentTick() const {
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _epoch);
+    return static_cast<std::uint64_t>(elapsed.count()) / _config.tickMillis;
+}
+
+void TurnFlow::tick() {
+    std::unique_lock<std::mutex> lock(_tickerMutex);
+    while (!_tickerWake.wait_for(lock, std::chrono::milliseconds(_config.tickMillis), [this] { return _stopping; })) {
+        for (unsigned s = 0; s < _host.shardCount(); ++s)
+            _host.postToShard(s, [this, s] { _wheels[s]->advance(currentTick()); });
+    }
+}
+
+void TurnFlow::arm(FlowGame& flow, unsigned millis, bool window) {
+    if (millis == 0) return;
+    std::uint64_t ticks = (millis + _config.tickMillis - 1) / _config.tickMillis;
+    TimerWheel& wheel = *_wheels[_host.shardOf(flow.id)];
+    flow.timer = wheel.schedule(currentTick() + ticks, flow.id | (window ? WINDOW_TIMER : 0));
+}
+
+void TurnFlow::disarm(FlowGame& flow) {
+    if (flow.timer == 0) return;
+    _wheels[_host.shardOf(flow.id)]->cancel(flow.timer);
+    flow.timer = 0;
+}
+
+void TurnFlow::expire(std::uint64_t data) {
+    FlowGame* flow = find(static_cast<GameId>(data));
+    if (!flow) return;
+    flow->timer = 0;
+    if ((data & WINDOW_TIMER) && flow->wait == FlowGame::Wait::Reactions) {
+        flow->blockers = 0;
+    } else if (!(data & WINDOW_TIMER) && flow->wait == FlowGame::Wait::Move) {
+        flow->proposed = defaultMove(*flow->game, flow->seat);
+        flow->done = nullptr;
+    } else {
+        return;
+    }
+    _timeouts.fetch_add(1, std::memory_order_relaxed);
+    resume(*flow);
+}
+
+std::unique_ptr<TurnFlow::FlowGame>& TurnFlow::slotOf(GameId game) {
+    std::vector<std::unique_ptr<FlowGame>>& shard = _flows[_host.shardOf(game)];
+    std::size_t slot = game / _host.shardCount();
+    if (shard.size() <= slot) shard.resize(slot + 1);
+    return shard[slot];
+}
+
+TurnFlow::FlowGame* TurnFlow::find(GameId game) {
+    const std::vector<std::unique_ptr<FlowGame>>& shard = _flows[_host.shardOf(game)];
+    std::size_t slot = game / _host.shardCount();
+    return slot < shard.size() ? shard[slot].get() : nullptr;
+}
+
+FlowTask TurnFlow::run(FlowGame& flow) {
+    Game& game = *flow.game;
+    unsigned actions = 0;   // Moves accepted in the current turn
+    int lastSeat = -1;
+    int passes = 0;         // Turns passed in a row because the seat could not move
+    MoveList legal;
+    while (!game.isGameOver()) {
+        int seat = game.snapshot().currentTurn;
+        if (seat != lastSeat) {
+            actions = 0;
+            lastSeat = seat;
+        }
+        if (_config.maxActionsPerTurn && actions >= _config.maxActionsPerTurn) {
+            game.nextTurn();
+            continue;
+        }
+        game.legalMoves(seat, legal);
+        if (legal.empty()) {
+            if (++passes >= rules::countActive(game.snapshot())) {
+                _stuck.fetch_add(1, std::memory_order_relaxed);
+                if (_config.onStuck) _config.onStuck(flow.id, game);
+                co_return;
+            }
+            game.nextTurn();
+            continue;
+        }
+
+        Move move = co_await MoveAwaiter{*this, flow, seat};
+        MoveStatus status = game.tryApply(seat, move);
+        MoveCallback done = std::move(flow.done);
+        flow.done = nullptr;
+        if (done) done(status);
+        if (status != MoveStatus::Ok) continue;
+        ++actions;
+        passes = 0;
+
+        if (_config.reactionWindows) co_await WindowAwaiter{*this, flow, blockersOf(game.snapshot(), seat, move)};
+    }
+    _finished.fetch_add(1, std::memory_order_relaxed);
+    if (_config.onGameOver) _config.onGameOver(flow.id, game);
+}
+
+void TurnFlow::resume(FlowGame& flow) {
+    disarm(flow);
+    flow.wait = FlowGame::Wait::None;
+    _waiting.fetch_sub(1, std::memory_order_relaxed);
+    flow.handle.resume();
+}
+
+void TurnFlow::start(GameId game) {
+    _host.post(game, [this, game](Game& state, MoveStatus) {
+        std::unique_ptr<FlowGame>& slot = slotOf(game);
+        if (slot) return;
+        slot = std::make_unique<FlowGame>();
+        slot->id = game;
+        slot->game = &state;
+        // The frame holds on to the game: it goes before the game does
+        _host.onClose(game, this, [this, game] { discard(game); });
+        slot->task = run(*slot);
+    });
+}
+
+void TurnFlow::play(GameId game, int seat, const Move& move, MoveCallback done) {
+    MoveCallback missing = done;
+    _host.post(game, [this, game, seat, move, done = std::move(done)](Game&, MoveStatus) mutable {
+        FlowGame* flow = find(game);
+        if (!flow || flow->task.done()) {
+            if (done) done(MoveStatus::IllegalMove);
+            return;
+        }
+        if (flow->wait != FlowGame::Wait::Move || flow->seat != seat) {
+            if (done) done(MoveStatus::NotYourTurn);
+            return;
+        }
+        flow->proposed = move;
+        flow->done = std::move(done);
+        resume(*flow);
+    }, [missing = std::move(missing)] {
+        if (missing) missing(MoveStatus::IllegalMove);
+    });
+}
+
+void TurnFlow::react(GameId game, int seat, const Move& move, MoveCallback done) {
+    MissingCallback gone = [done] {
+        if (done) done(MoveStatus::IllegalMove);
+    };
+    GameCallback reacted = [this, game, seat, done](Game&, MoveStatus status) {
+        if (done) done(status);
+        if (FlowGame* flow = find(game)) answer(*flow, seat);
+    };
+    switch (move.type) {
+        case MoveType::Undo:
+        case MoveType::SpyOn:
+            // Neither ends a turn, whoever plays it
+            _host.react(game, seat, move, std::move(reacted), std::move(gone));
+            return;
+        case MoveType::Arrest:
+            // Whether an arrest leaves the turn alone depends on the roles,
+            // so it is judged on the shard
+            _host.post(game, [seat, move, reacted = std::move(reacted), done](Game& state, MoveStatus) {
+                GameState snapshot = state.snapshot();
+                bool inRange = seat >= 0 && seat < snapshot.playerCount && move.target >= 0 && move.target < snapshot.playerCount;
+                if (inRange && snapshot.seat(seat).role == RoleId::Spy && snapshot.seat(move.target).role == RoleId::Merchant)
+                    reacted(state, state.tryApply(seat, move));
+                else if (done)
+                    done(MoveStatus::NotYourTurn);
+            }, std::move(gone));
+            return;
+        default:
+            _host.post(game, [done](Game&, MoveStatus) {
+                if (done) done(MoveStatus::NotYourTurn);
+            }, std::move(gone));
+            return;
+    }
+}
+
+void TurnFlow::pass(GameId game, int seat) {
+    _host.post(game, [this, game, seat](Game&, MoveStatus) {
+        if (FlowGame* flow = find(game)) answer(*flow, seat);
+    });
+}
+
+void TurnFlow::answer(FlowGame& flow, int seat) {
+    if (flow.wait != FlowGame::Wait::Reactions || seat < 0 || static_cast<std::size_t>(seat) >= MAX_PLAYERS) return;
+    flow.blockers &= ~(1u << seat);
+    if (flow.blockers == 0) resume(flow);
+}
+
+void TurnFlow::closeWindow(GameId game) {
+    _host.post(game, [this, game](Game&, MoveStatus) {
+        FlowGame* flow = find(game);
+        if (flow && flow->wait == FlowGame::Wait::Reactions) {
+            flow->blockers = 0;
+            resume(*flow);
+        }
+    });
+}
+
+void TurnFlow::stop(GameId game) {
+    _host.post(game, [this, game](Game&, MoveStatus) {
+        _host.forgetClose(game, this);
+        discard(game);
+    });
+}
+
+void TurnFlow::discard(GameId game) {
+    std::unique_ptr<FlowGame>& slot = slotOf(game);
+    if (!slot) return;
+    disarm(*slot);
+    if (slot->wait != FlowGame::Wait::None) _waiting.fetch_sub(1, std::memory_order_relaxed);
+    slot.reset();
+}
+
+} // namespace coup
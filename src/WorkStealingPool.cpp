@@ -0,0 +1,90 @@
+//tomergal40@gmail.com
+#include "../include/WorkStealingPool.hpp"
+#include "../include/Exceptions.hpp"
+#include <algorithm>
+
+namespace coup {
+
+namespace {
+
+// Pool and worker index of the calling thread, so pushes from inside a job
+// stay on the worker's own deque
+thread_local const WorkStealingPool* currentPool = nullptr;
+thread_local unsigned currentWorker = 0;
+
+} // namespace
+
+WorkStealingPool::WorkStealingPool(unsigned threads, std::function<void(std::uint32_t)> run) : _run(std::move(run)) {
+    if (!_run) throw GameException("A thread pool needs a job function!");
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned t = 0; t < threads; ++t) _workers.push_back(std::make_unique<Worker>());
+    _threads.reserve(threads);
+    for (unsigned t = 0; t < threads; ++t) _threads.emplace_back(&WorkStealingPool::workerLoop, this, t);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(_idleMutex);
+        _stopping = true;
+    }
+    _idle.notify_all();
+    for (auto& thread : _threads) thread.join();
+}
+
+void WorkStealingPool::push(std::uint32_t job) {
+    unsigned target = currentPool == this
+        ? currentWorker
+        : _nextWorker.fetch_add(1, std::memory_order_relaxed) % static_cast<unsigned>(_workers.size());
+    {
+        std::lock_guard<std::mutex> lock(_workers[target]->mutex);
+        _workers[target]->jobs.push_back(job);
+    }
+    {
+        // Counted under the idle lock so a worker about to sleep cannot miss it
+        std::lock_guard<std::mutex> lock(_idleMutex);
+        _queued.fetch_add(1, std::memory_order_relaxed);
+    }
+    _idle.notify_one();
+}
+
+bool WorkStealingPool::take(unsigned self, std::uint32_t& job) {
+    {
+        Worker& own = *_workers[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.jobs.empty()) {
+            job = own.jobs.back();
+            own.jobs.pop_back();
+            return true;
+        }
+    }
+    const unsigned count = static_cast<unsigned>(_workers.size());
+    for (unsigned offset = 1; offset < count; ++offset) {
+        Worker& victim = *_workers[(self + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            job = victim.jobs.front();
+            victim.jobs.pop_front();
+            _steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(unsigned self) {
+    currentPool = this;
+    currentWorker = self;
+    std::uint32_t job = 0;
+    while (true) {
+        if (take(self, job)) {
+            _queued.fetch_sub(1, std::memory_order_relaxed);
+            _run(job);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(_idleMutex);
+        _idle.wait(lock, [this] { return _stopping || _queued.load(std::memory_order_relaxed) > 0; });
+        if (_stopping) return;
+    }
+}
+
+} // namespace coup
@@ -0,0 +1,25 @@
+//tomergal40@gmail.com
+#include "../include/Zobrist.hpp"
+
+namespace coup {
+
+namespace zobrist {
+
+std::uint64_t seat(int index, const SeatState& state) {
+    std::uint64_t h = coins(index, state.coins) ^ role(index, state.role) ^ flags(index, state.flags) ^
+                      lastArrested(index, state.lastArrested) ^ spyTarget(index, state.spyTarget);
+    for (std::size_t type = 0; type < ACTION_TYPE_COUNT; ++type)
+        if (state.hasPending(static_cast<ActionType>(type))) h ^= pending(index, static_cast<ActionType>(type));
+    return h;
+}
+
+std::uint64_t hash(const GameState& state) {
+    std::uint64_t h = bank(state.bank);
+    if (state.playerCount > 0) h ^= turn(state.currentTurn);
+    for (int i = 0; i < state.playerCount; ++i) h ^= seat(i, state.seat(i));
+    return h;
+}
+
+} // namespace zobrist
+
+} // namespace coup
@@ -2,29 +2,35 @@
 #include "../include/Spy.hpp"
 #include "../include/Game.hpp"
 #include "../include/Exceptions.hpp"
-#include <iostream>
+#include "../include/Zobrist.hpp"
 
 namespace coup {
 
 Spy::Spy(Game& game, const std::string& name)
-    : Player(game, name), lastTargetName("") {}
+    : Player(game, name, RoleId::Spy), lastTargetName(""), lastTargetSeat(-1) {}
 
 void Spy::spyOn(Player& target) {
     // Spy ability: reveal target's coin count
-    std::cout << "Spy " << _name << " spied on " << target.getName()
-              << " and discovered they have " << target.coins() << " coins." << std::endl;
+    _game->emit(EventType::SpiedOn, _seat, target.seat(), target.coins());
     
-    lastTargetName = target.getName();
+    setLastTarget(&target);
     
     // Register a pending action to block arrest
-    _game->addPendingAction(_name, "block_arrest", createSafePtr(&target), nullptr);
+    _game->addPendingAction(_seat, ActionType::BlockArrest, target.seat());
+}
+
+void Spy::setLastTarget(const Player* target) {
+    int seat = target ? target->seat() : -1;
+    if (_seat >= 0) _game->updateHash(zobrist::spyTarget(_seat, lastTargetSeat) ^ zobrist::spyTarget(_seat, seat));
+    lastTargetName = target ? target->getName() : "";
+    lastTargetSeat = seat;
 }
 
 void Spy::undo(Player& target) {
-    if (target.getName() == lastTargetName) {
-        std::cout << "Spy prevents " << target.getName() << " from arresting this turn." << std::endl;
+    if (lastTargetSeat >= 0 && target.seat() == lastTargetSeat) {
+        _game->emit(EventType::ArrestBlocked, _seat, target.seat());
         
-        _game->clearPendingAction(_name, "block_arrest");
+        _game->clearPendingAction(_seat, ActionType::BlockArrest);
     } else {
         throw IllegalMoveException("No valid target to undo arrest for.");
     }
@@ -14,7 +14,35 @@
 #include "../include/Merchant.hpp"
 #include "../include/Game.hpp"
 #include "../include/Exceptions.hpp"
+#include "../include/Simulator.hpp"
+#include "../include/GameState.hpp"
+#include "../include/Zobrist.hpp"
+#include "../include/TranspositionTable.hpp"
+#include "../include/EventSink.hpp"
+#include "../include/Ismcts.hpp"
+#include "../include/ParallelMcts.hpp"
+#include "../include/AlphaBeta.hpp"
+#include "../include/Tablebase.hpp"
+#include "../include/Cfr.hpp"
+#include "../include/Agent.hpp"
+#include "../include/Playout.hpp"
+#include "../include/Belief.hpp"
+#include "../include/Evaluation.hpp"
+#include "../include/GameHost.hpp"
+#include "../include/CoupServer.hpp"
+#include "../include/TurnFlow.hpp"
+#include "../include/TimerWheel.hpp"
+#include "../include/SelfPlay.hpp"
+#include "../include/Tournament.hpp"
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <new>
+#include <unistd.h>
 
 using namespace coup;
 
@@ -735,3 +763,1509 @@ TEST_CASE("Merchant bonus timing - FIXED") {
     while (game.turn() != "Merchant") game.nextTurn();
     merchant->gather();
 }
+
+TEST_CASE("Simulator plays complete games") {
+    SimulationConfig config;
+    config.players = 3;
+    config.roles = {"Governor", "Baron", "Merchant"};
+    config.agents = {makeAgentFactory("greedy"), makeAgentFactory("random")};
+    config.seed = 42;
+    Simulator simulator(config);
+
+    SimulationResult result = simulator.run(200, 2);
+    CHECK(result.games == 200);
+    uint64_t wins = 0;
+    for (auto w : result.winsBySeat) wins += w;
+    CHECK(wins + result.draws == result.games);
+    CHECK(result.actions > 0);
+
+    // Same seed, same stream: batches are reproducible
+    CHECK(simulator.run(200, 2).winsBySeat == result.winsBySeat);
+
+    CHECK_THROWS_AS(makeAgentFactory("nope"), GameException);
+    config.players = 7;
+    CHECK_THROWS_AS(Simulator{config}, GameException);
+}
+
+TEST_CASE("Pending action journal") {
+    Game game;
+    auto governor = std::make_shared<Governor>(game, "Gov");
+    auto judge = std::make_shared<Judge>(game, "Judge");
+    auto spy = std::make_shared<Spy>(game, "Spy");
+    game.addPlayer(governor);
+    game.addPlayer(judge);
+    game.addPlayer(spy);
+    game.startGame();
+
+    governor->tax();
+    judge->tax();
+    CHECK(game.hasPendingAction("Gov", ActionType::Tax));
+    CHECK(game.hasPendingAction("Judge", "tax")); // String adapter
+    CHECK_FALSE(game.hasPendingAction("Gov", ActionType::Bribe));
+    CHECK_FALSE(game.hasPendingAction("Nobody", ActionType::Tax));
+    CHECK(std::string(toString(game.getPendingAction("Gov", ActionType::Tax).type)) == "tax");
+    CHECK(game.getPendingActions().size() == 2);
+
+    game.clearPendingAction("Judge", "tax");
+    CHECK_FALSE(game.hasPendingAction("Judge", ActionType::Tax));
+    CHECK(game.getPendingActions().size() == 1);
+    CHECK_THROWS_AS(game.getPendingAction("Judge", ActionType::Tax), GameException);
+
+    game.clearAllPendingActions("Gov");
+    CHECK(game.getPendingActions().empty());
+    CHECK_THROWS_AS(game.addPendingAction("Gov", "not_an_action"), GameException);
+}
+
+TEST_CASE("Pending actions refer to players by seat") {
+    Game game;
+    auto governor = std::make_shared<Governor>(game, "Gov");
+    auto general = std::make_shared<General>(game, "Gen");
+    auto judge = std::make_shared<Judge>(game, "Judge");
+    game.addPlayer(governor);
+    game.addPlayer(general);
+    game.addPlayer(judge);
+    game.startGame();
+
+    governor->tax();
+    Game::PendingAction tax = game.getPendingAction("Gov", ActionType::Tax);
+    CHECK(tax.actor == 0);
+    CHECK(tax.target == 0);
+    general->addCoins(7);
+    general->coup(*judge);
+    Game::PendingAction coup = game.getPendingAction("Gen", ActionType::Coup);
+    CHECK(coup.actor == 1);
+    CHECK(coup.target == 1);
+    CHECK(coup.victim == 2);
+    CHECK_THROWS_AS(game.addPendingAction(7, ActionType::Tax), PlayerNotFoundException);
+}
+
+TEST_CASE("Players are identified by seat") {
+    Game game;
+    auto governor = std::make_shared<Governor>(game, "Gov");
+    auto spy = std::make_shared<Spy>(game, "Spy");
+    Baron outsider(game, "Outsider"); // Never added to the game
+    game.addPlayer(governor);
+    game.addPlayer(spy);
+    game.startGame();
+
+    CHECK(game.getPlayer("Spy") == spy);
+    CHECK(game.getPlayer(1) == spy);
+    CHECK_THROWS_AS(game.getPlayer(2), PlayerNotFoundException);
+    CHECK_THROWS_AS(game.getPlayer("Nobody"), PlayerNotFoundException);
+    CHECK(game.isPlayerTurn(0));
+    CHECK(game.isPlayerTurn("Gov"));
+    CHECK_FALSE(game.isPlayerTurn(spy->seat()));
+    CHECK_FALSE(game.isPlayerTurn(outsider.seat()));
+    CHECK_THROWS_AS(outsider.gather(), NotYourTurnException);
+
+    governor->tax();
+    CHECK(game.hasPendingAction(0, ActionType::Tax));
+    game.clearPendingAction(0, ActionType::Tax);
+    CHECK_FALSE(game.hasPendingAction("Gov", ActionType::Tax));
+}
+
+TEST_CASE("Role ids match the role classes") {
+    Game game;
+    CHECK((Governor(game, "a").roleId() == RoleId::Governor));
+    CHECK((Spy(game, "b").roleId() == RoleId::Spy));
+    CHECK((Baron(game, "c").roleId() == RoleId::Baron));
+    CHECK((General(game, "d").roleId() == RoleId::General));
+    CHECK((Judge(game, "e").roleId() == RoleId::Judge));
+    CHECK((Merchant(game, "f").roleId() == RoleId::Merchant));
+    CHECK((Player(game, "g").roleId() == RoleId::Player));
+
+    // The display name stays consistent with the id
+    for (const char* role : ROLE_NAMES) {
+        auto player = createPlayer(game, role, role);
+        CHECK(player->role() == toString(player->roleId()));
+    }
+}
+
+TEST_CASE("Pending actions expire when their author plays again") {
+    Game game;
+    auto governor = std::make_shared<Governor>(game, "Gov");
+    auto spy = std::make_shared<Spy>(game, "Spy");
+    game.addPlayer(governor);
+    game.addPlayer(spy);
+    game.startGame();
+
+    governor->tax();
+    CHECK(game.hasPendingAction("Gov", ActionType::Tax));
+    spy->gather(); // Governor's turn starts, closing the undo window of the tax
+    CHECK_FALSE(game.hasPendingAction("Gov", ActionType::Tax));
+    CHECK(game.hasPendingAction("Spy", ActionType::Gather));
+
+    // Long games keep a flat journal
+    for (int turn = 0; turn < 10000; ++turn) {
+        game.addPendingAction(game.turn(), ActionType::Arrest);
+        game.nextTurn();
+    }
+    CHECK(game.getPendingActions().size() <= PENDING_LOG_CAPACITY);
+}
+
+TEST_CASE("GameState snapshot and rules engine") {
+    Game game;
+    auto governor = std::make_shared<Governor>(game, "Gov");
+    auto baron = std::make_shared<Baron>(game, "Baron");
+    auto merchant = std::make_shared<Merchant>(game, "Merchant");
+    auto judge = std::make_shared<Judge>(game, "Judge");
+    game.addPlayer(governor);
+    game.addPlayer(baron);
+    game.addPlayer(merchant);
+    game.addPlayer(judge);
+    game.startGame();
+
+    GameState state = game.snapshot();
+    CHECK(state.playerCount == 4);
+    CHECK(state.bank == 100);
+    CHECK((state.seats[1].role == RoleId::Baron));
+
+    // Play the same moves on the Game and on the plain state
+    auto both = [&](Player& player, int seat, Move move, auto action) {
+        action(player);
+        CHECK((rules::apply(state, seat, move) == MoveStatus::Ok));
+        CHECK((game.snapshot() == state));
+    };
+    both(*governor, 0, {MoveType::Tax, -1}, [](Player& p) { p.tax(); });
+    both(*baron, 1, {MoveType::Tax, -1}, [](Player& p) { p.tax(); });
+    both(*merchant, 2, {MoveType::Tax, -1}, [](Player& p) { p.tax(); });
+    both(*judge, 3, {MoveType::Gather, -1}, [](Player& p) { p.gather(); });
+    both(*governor, 0, {MoveType::Undo, 1}, [&](Player& p) { p.undo(*baron); });
+    both(*governor, 0, {MoveType::Sanction, 1}, [&](Player& p) { p.sanction(*baron); });
+    both(*baron, 1, {MoveType::Arrest, 2}, [&](Player& p) { p.arrest(*merchant); }); // Merchant bonus, then arrest fee
+    CHECK((rules::check(state, 2, {MoveType::Invest, -1}) == MoveStatus::WrongRole));
+    CHECK((rules::check(state, 1, {MoveType::Gather, -1}) == MoveStatus::NotYourTurn));
+
+    // Copies are plain memcpy and restore round-trips
+    GameState copy;
+    std::memcpy(&copy, &state, sizeof(GameState));
+    CHECK((copy == state));
+    merchant->gather();
+    game.restore(copy);
+    CHECK((game.snapshot() == copy));
+    CHECK(game.turn() == "Merchant");
+}
+
+TEST_CASE("Zobrist hash follows the game incrementally") {
+    Game game;
+    auto spy = std::make_shared<Spy>(game, "Spy");
+    auto merchant = std::make_shared<Merchant>(game, "Merchant");
+    auto general = std::make_shared<General>(game, "General");
+    game.addPlayer(spy);
+    game.addPlayer(merchant);
+    game.addPlayer(general);
+    game.startGame();
+    uint64_t start = game.hash();
+    CHECK(start == zobrist::hash(game.snapshot()));
+
+    spy->tax();
+    merchant->tax();
+    general->gather();
+    spy->spyOn(*general);
+    spy->arrest(*merchant); // Out of turn arrest of a Merchant keeps the turn
+    spy->gather();
+    merchant->gather();
+    CHECK(game.hash() == zobrist::hash(game.snapshot()));
+    CHECK(game.hash() != start);
+
+    // Identical positions hash identically, whatever the path
+    GameState state = game.snapshot();
+    general->gather();
+    game.restore(state);
+    CHECK(game.hash() == zobrist::hash(state));
+}
+
+TEST_CASE("Transposition table") {
+    TranspositionTable table(1);
+    CHECK(table.capacity() == 65536);
+
+    TTHit hit{};
+    CHECK_FALSE(table.probe(12345, hit));
+    table.store(12345, -42, 5, Bound::Lower, Move{MoveType::Coup, 2});
+    REQUIRE(table.probe(12345, hit));
+    CHECK(hit.value == -42);
+    CHECK(hit.depth == 5);
+    CHECK((hit.bound == Bound::Lower));
+    CHECK((hit.best == Move{MoveType::Coup, 2}));
+
+    // Shallower results do not replace deeper ones for the same position
+    table.store(12345, 7, 3, Bound::Exact);
+    REQUIRE(table.probe(12345, hit));
+    CHECK(hit.value == -42);
+
+    // A colliding position overwrites the slot and the old key misses
+    table.store(12345 + table.capacity(), 1, 1, Bound::Exact);
+    CHECK_FALSE(table.probe(12345, hit));
+    table.clear();
+    CHECK_FALSE(table.probe(12345 + table.capacity(), hit));
+}
+
+TEST_CASE("Legal move generation and tryApply") {
+    Game game;
+    auto baron = std::make_shared<Baron>(game, "Baron");
+    auto spy = std::make_shared<Spy>(game, "Spy");
+    auto general = std::make_shared<General>(game, "General");
+    game.addPlayer(baron);
+    game.addPlayer(spy);
+    game.addPlayer(general);
+    game.startGame();
+
+    MoveList moves;
+    game.legalMoves(0, moves);
+    CHECK(moves.contains({MoveType::Gather, -1}));
+    CHECK(moves.contains({MoveType::Arrest, 1}));
+    CHECK_FALSE(moves.contains({MoveType::Invest, -1}));  // Needs 3 coins
+    CHECK_FALSE(moves.contains({MoveType::Arrest, 0}));   // Not against oneself
+
+    // Out of turn, a Spy can still spy and arrest nobody but a Merchant
+    game.legalMoves(1, moves);
+    CHECK(moves.contains({MoveType::SpyOn, 0}));
+    CHECK_FALSE(moves.contains({MoveType::Gather, -1}));
+
+    CHECK((game.tryApply(1, {MoveType::Gather, -1}) == MoveStatus::NotYourTurn));
+    CHECK((game.tryApply(0, {MoveType::Coup, 1}) == MoveStatus::NotEnoughCoins));
+    CHECK((game.tryApply(0, {MoveType::SpyOn, 1}) == MoveStatus::WrongRole));
+    CHECK((game.tryApply(0, {MoveType::Arrest, 7}) == MoveStatus::InvalidTarget));
+    CHECK(game.turn() == "Baron");
+
+    CHECK((game.tryApply(0, {MoveType::Tax, -1}) == MoveStatus::Ok));
+    CHECK(baron->coins() == 2);
+    CHECK(game.turn() == "Spy");
+
+    // Every generated move is accepted by the throwing API as well
+    game.legalMoves(1, moves);
+    REQUIRE_FALSE(moves.empty());
+    for (const Move& move : moves) CHECK((game.checkMove(1, move) == MoveStatus::Ok));
+    spy->spyOn(*general);
+    game.legalMoves(1, moves);
+    CHECK_FALSE(moves.contains({MoveType::SpyOn, 2})); // Once per turn
+
+    // A move that passes checkMove is applied in full, even when the bank
+    // cannot pay the next player's start-of-turn bonus
+    Game dry;
+    auto gatherer = std::make_shared<Baron>(dry, "Baron");
+    auto merchant = std::make_shared<Merchant>(dry, "Merchant");
+    dry.addPlayer(gatherer);
+    dry.addPlayer(merchant);
+    dry.startGame();
+    GameState state = dry.snapshot();
+    state.seat(1).coins = 3;
+    state.bank = 1;
+    dry.restore(state);
+    CHECK((rules::apply(state, 0, {MoveType::Gather, -1}) == MoveStatus::Ok));
+    CHECK((dry.tryApply(0, {MoveType::Gather, -1}) == MoveStatus::Ok));
+    CHECK(dry.snapshot() == state);
+    CHECK(dry.getBank() == 0);
+    CHECK(merchant->coins() == 3);
+    CHECK(dry.turn() == "Merchant");
+
+    // Rule: a Merchant gets no start-of-turn bonus while the bank is empty,
+    // through the throwing API as well; with a coin left it is paid as before
+    state = dry.snapshot();
+    state.currentTurn = 0;
+    state.bank = 1;
+    dry.restore(state);
+    CHECK_NOTHROW(gatherer->gather());
+    CHECK(merchant->coins() == 3);
+    state.bank = 2;
+    dry.restore(state);
+    gatherer->gather();
+    CHECK(merchant->coins() == 4);
+    CHECK(dry.getBank() == 0);
+}
+
+TEST_CASE("Rules engine and Player methods agree on random positions") {
+    // Every move the rules call legal, from any seat, is played by the
+    // Player methods without throwing and to the position rules::apply gives
+    const RoleId pool[] = {RoleId::Governor, RoleId::Spy, RoleId::Baron, RoleId::General, RoleId::Judge, RoleId::Merchant};
+    std::mt19937_64 rng(11);
+    MoveList legal;
+    int tried = 0;
+    int mismatches = 0;
+    for (int g = 0; g < 30; ++g) {
+        int players = 2 + static_cast<int>(rng() % 5);
+        RoleId roles[MAX_PLAYERS];
+        for (int i = 0; i < players; ++i) roles[i] = pool[rng() % 6];
+        Game game;
+        game.setEventSink(nullptr);
+        for (int i = 0; i < players; ++i) game.addPlayer(createPlayer(game, toString(roles[i]), "P" + std::to_string(i)));
+        game.startGame();
+
+        GameState state = rules::initialState(roles, players);
+        if (g % 3 == 0) state.bank = static_cast<std::int16_t>(rng() % 4);   // Short banks too
+        for (int ply = 0; ply < 120 && !rules::isGameOver(state); ++ply) {
+            for (int seat = 0; seat < players; ++seat) {
+                rules::legalMoves(state, seat, legal);
+                for (const Move& move : legal) {
+                    GameState expected = state;
+                    rules::apply(expected, seat, move);
+                    game.restore(state);
+                    ++tried;
+                    if (game.tryApply(seat, move) != MoveStatus::Ok || !(game.snapshot() == expected)) ++mismatches;
+                }
+            }
+            rules::legalMoves(state, state.currentTurn, legal);
+            if (legal.empty()) rules::nextTurn(state);
+            else rules::apply(state, state.currentTurn, legal[static_cast<std::size_t>(rng() % legal.size())]);
+        }
+    }
+    CHECK(tried > 10000);
+    CHECK(mismatches == 0);
+}
+
+TEST_CASE("Event sinks") {
+    BufferedEventSink buffer;
+    Game game;
+    game.setEventSink(&buffer);
+    auto governor = std::make_shared<Governor>(game, "Gov");
+    auto spy = std::make_shared<Spy>(game, "Spy");
+    game.addPlayer(governor);
+    game.addPlayer(spy);
+    game.startGame();
+    governor->tax();
+    spy->spyOn(*governor);
+
+    CHECK(buffer.eventCount() == 4);
+    CHECK(buffer.buffered() == "Added player: Gov\n"
+                               "Added player: Spy\n"
+                               "Governor Gov collected 3 coins in tax\n"
+                               "Spy Spy spied on Gov and discovered they have 3 coins.\n");
+
+    // The null sink drops everything
+    game.setEventSink(nullptr);
+    spy->gather();
+    CHECK(buffer.eventCount() == 4);
+
+    // The async sink has written every event once it is destroyed
+    const char* path = "event_sink_test.log";
+    std::remove(path);
+    {
+        AsyncFileEventSink file(path);
+        game.setEventSink(&file);
+        governor->tax();
+        game.setEventSink(nullptr);
+    }
+    std::ifstream log(path);
+    std::string line;
+    REQUIRE(std::getline(log, line));
+    CHECK(line == "Governor Gov collected 3 coins in tax");
+    log.close();
+    std::remove(path);
+}
+
+TEST_CASE("ISMCTS search") {
+    // Hidden coins are redistributed without changing their total
+    const RoleId three[] = {RoleId::General, RoleId::Judge, RoleId::Merchant};
+    GameState state = rules::initialState(three, 3);
+    state.seat(0).coins = 4;
+    state.seat(1).coins = 6;
+    state.seat(2).coins = 3;
+    std::mt19937_64 rng(7);
+    HiddenCoinsDeterminizer hidden;
+    bool changed = false;
+    for (int i = 0; i < 20; ++i) {
+        GameState sample = state;
+        hidden.determinize(sample, 0, rng);
+        CHECK(sample.seat(0).coins == 4);
+        CHECK(sample.seat(1).coins + sample.seat(2).coins == 9);
+        changed = changed || sample.seat(1).coins != 6;
+    }
+    CHECK(changed);
+
+    // With 7 coins against a lone opponent, the coup wins on the spot
+    const RoleId two[] = {RoleId::General, RoleId::Judge};
+    state = rules::initialState(two, 2);
+    state.seat(0).coins = 7;
+    IsmctsConfig config;
+    config.threads = 2;
+    config.budget.iterations = 300;
+    SearchResult result = Ismcts(config).search(state, 0);
+    CHECK((result.best == Move{MoveType::Coup, 1}));
+    CHECK(result.playouts == 600);
+    CHECK(result.moves.front().mean() == doctest::Approx(1.0));
+
+    CHECK_THROWS_AS(Ismcts(config).search(state, 1), NotYourTurnException);
+    config.budget.iterations = 0;
+    CHECK_THROWS_AS(Ismcts{config}, GameException);
+}
+
+TEST_CASE("Tree parallel MCTS") {
+    const RoleId roles[] = {RoleId::General, RoleId::Judge};
+    GameState state = rules::initialState(roles, 2);
+    state.seat(0).coins = 7;
+
+    ParallelMctsConfig config;
+    config.threads = 4;
+    config.budget.iterations = 400;
+    TreeParallelMcts search(config);
+    SearchResult result = search.search(state, 0);
+    CHECK((result.best == Move{MoveType::Coup, 1}));
+    CHECK(result.playouts == 400);
+    CHECK(search.treeSize() > 1);
+
+    // The arena is reused by the next search, and a full arena only stops growth
+    config.arenaNodes = 8;
+    TreeParallelMcts small(config);
+    result = small.search(state, 0);
+    CHECK(result.playouts == 400);
+    CHECK(small.treeSize() == 8);
+    result = small.search(state, 0);
+    CHECK(result.playouts == 400);
+}
+
+// Move sequences counted by copying the position at every ply
+static std::uint64_t copyPerft(const GameState& state, int depth) {
+    if (depth == 0 || rules::isGameOver(state)) return 1;
+    MoveList moves;
+    rules::legalMoves(state, state.currentTurn, moves);
+    if (moves.empty()) {
+        GameState next = state;
+        rules::nextTurn(next);
+        return copyPerft(next, depth - 1);
+    }
+    std::uint64_t count = 0;
+    for (const Move& move : moves) {
+        GameState next = state;
+        rules::apply(next, state.currentTurn, move);
+        count += copyPerft(next, depth - 1);
+    }
+    return count;
+}
+
+TEST_CASE("Alpha-beta duel search") {
+    const RoleId roles[] = {RoleId::Spy, RoleId::Merchant, RoleId::General};
+    GameState state = rules::initialState(roles, 3);
+    state.seat(2).flags &= static_cast<std::uint8_t>(~SEAT_ACTIVE); // Eliminated
+    state.seat(0).coins = 3;
+    state.seat(1).coins = 4;
+    state.bank = 93;
+
+    // Make/unmake visits exactly the positions that copying does
+    AlphaBeta search;
+    CHECK(search.perft(state, 4) == copyPerft(state, 4));
+
+    // A coup is a win in one
+    state.seat(0).coins = 7;
+    AlphaBetaResult result = search.search(state, 0);
+    CHECK((result.best == Move{MoveType::Coup, 1}));
+    CHECK(result.provenWin());
+    CHECK(result.nodes > 0);
+
+    // The search leaves the position it was given untouched and can be repeated
+    AlphaBetaConfig config;
+    config.maxDepth = 5;
+    AlphaBeta limited(config);
+    state.seat(0).coins = 2;
+    GameState before = state;
+    result = limited.search(state, 0);
+    CHECK(result.depth == 5);
+    CHECK((state == before));
+    CHECK((limited.search(state, 0).best == result.best));
+
+    state.seat(2).flags |= SEAT_ACTIVE;
+    CHECK_THROWS_AS(limited.search(state, 0), GameException);
+}
+
+TEST_CASE("Endgame tablebase") {
+    const char* path = "test_tablebase.tb";
+    std::vector<TablebaseSection> sections =
+        tablebase::generate(path, {{RoleId::Governor, RoleId::Spy}, {RoleId::Baron, RoleId::Baron}});
+    CHECK(sections.size() == 3); // Governor vs Spy is solved with its mirror
+    {
+        Tablebase table(path);
+        CHECK(table.hasSection(RoleId::Spy, RoleId::Governor));
+        CHECK(table.hasSection(RoleId::Baron, RoleId::Baron));
+        CHECK_FALSE(table.hasSection(RoleId::Judge, RoleId::Merchant));
+        std::size_t positions = 0;
+        for (const TablebaseSection& section : sections) {
+            positions += section.positions;
+            CHECK(section.wins + section.losses + section.draws == section.positions);
+        }
+        CHECK(table.positions() == positions);
+
+        // Seat indices do not matter, only which two seats are still active
+        const RoleId roles[] = {RoleId::Spy, RoleId::Judge, RoleId::Governor};
+        GameState state = rules::initialState(roles, 3);
+        state.seat(1).flags &= static_cast<std::uint8_t>(~SEAT_ACTIVE);
+        state.bank = 90;
+        state.seat(0).coins = 7;
+        TablebaseEntry entry = table.probe(state);
+        CHECK((entry.value == TablebaseValue::Win));
+        CHECK(entry.plies == 1);
+        Move move;
+        CHECK(table.bestMove(state, move));
+        CHECK((move == Move{MoveType::Coup, 2}));
+
+        // Agrees with alpha-beta wherever the search proves a result
+        AlphaBetaConfig config;
+        config.maxDepth = 6;
+        AlphaBeta search(config);
+        int proven = 0;
+        for (int mine = 0; mine < 7; ++mine) {
+            for (int theirs = 0; theirs < 12; theirs += 3) {
+                state.seat(0).coins = static_cast<std::int16_t>(mine);
+                state.seat(2).coins = static_cast<std::int16_t>(theirs);
+                entry = table.probe(state);
+                REQUIRE((entry.value != TablebaseValue::Unknown));
+                AlphaBetaResult result = search.search(state, 0);
+                if (result.provenWin()) CHECK((entry.value == TablebaseValue::Win));
+                if (result.provenLoss()) CHECK((entry.value == TablebaseValue::Loss));
+                if (result.provenWin() || result.provenLoss()) ++proven;
+                if (entry.value == TablebaseValue::Win && entry.plies <= config.maxDepth) CHECK(result.provenWin());
+            }
+        }
+        CHECK(proven > 0);
+
+        // The bank only has to hold MIN_BANK coins for the generated values
+        int compared = 0;
+        for (int mine = 0; mine <= tablebase::MAX_COINS; ++mine) {
+            for (int theirs = 0; theirs <= tablebase::MAX_COINS; ++theirs) {
+                state.seat(0).coins = static_cast<std::int16_t>(mine);
+                state.seat(2).coins = static_cast<std::int16_t>(theirs);
+                state.bank = tablebase::GENERATOR_BANK;
+                TablebaseEntry full = table.probe(state);
+                state.bank = tablebase::MIN_BANK;
+                TablebaseEntry low = table.probe(state);
+                CHECK((low.value == full.value));
+                CHECK(low.plies == full.plies);
+                if (full.value != TablebaseValue::Unknown) ++compared;
+                if (low.value != TablebaseValue::Win) continue;
+                // And the winning line, picked with a full bank, plays out
+                // from the short one (which soon drops below what probe accepts)
+                GameState guide = state;
+                guide.bank = tablebase::GENERATOR_BANK;
+                GameState line = state;
+                for (int ply = 0; ply < low.plies; ++ply) {
+                    REQUIRE(table.bestMove(guide, move));
+                    REQUIRE((rules::apply(guide, guide.currentTurn, move) == MoveStatus::Ok));
+                    REQUIRE((rules::apply(line, line.currentTurn, move) == MoveStatus::Ok));
+                }
+                CHECK(rules::isGameOver(line));
+            }
+        }
+        CHECK(compared == (tablebase::MAX_COINS + 1) * (tablebase::MAX_COINS + 1));
+        state.bank = tablebase::MIN_BANK - 1;
+        CHECK_FALSE(table.covers(state));
+
+        // Positions outside the table
+        state.bank = 10;
+        CHECK_FALSE(table.covers(state));
+        state.bank = 90;
+        CHECK(table.covers(state));
+        state.seat(1).flags |= SEAT_ACTIVE;
+        CHECK((table.probe(state).value == TablebaseValue::Unknown));
+        CHECK_FALSE(table.bestMove(state, move));
+    }
+    std::remove(path);
+
+    CHECK_THROWS_AS(Tablebase{path}, GameException);
+    {
+        std::ofstream garbage(path, std::ios::binary);
+        garbage << std::string(4096, 'x');
+    }
+    CHECK_THROWS_AS(Tablebase{path}, GameException);
+    std::remove(path);
+}
+
+TEST_CASE("MCCFR trainer") {
+    const RoleId roles[] = {RoleId::Governor, RoleId::Spy};
+    GameState root = rules::initialState(roles, 2);
+    root.seat(0).coins = 7;
+    root.seat(1).coins = 3;
+
+    CfrConfig config;
+    config.threads = 2;
+    config.horizon = 4;
+    config.checkpointPath = "test_cfr.ckpt";
+    config.checkpointEvery = 50;
+    CfrTrainer trainer(config);
+    CfrResult result = trainer.train(root, 120);
+    CHECK(result.iterations == 120);
+    CHECK(result.checkpoints == 3);
+    CHECK(result.nodes > 0);
+    CHECK(result.infoSets == trainer.table().size());
+    CHECK(result.infoSets > 0);
+
+    // Couping right away wins, so the average strategy settles on it
+    CHECK((trainer.bestMove(root) == Move{MoveType::Coup, 1}));
+    MoveList moves;
+    double probabilities[MAX_MOVES];
+    CHECK(trainer.averageStrategy(root, 0, moves, probabilities));
+    double total = 0.0;
+    for (std::size_t m = 0; m < moves.size(); ++m) total += probabilities[m];
+    CHECK(total == doctest::Approx(1.0));
+
+    // The opponent's coins are hidden from the seat to move
+    GameState other = root;
+    other.seat(1).coins = 5;
+    CHECK(CfrTrainer::infoSetKey(other, 0) == CfrTrainer::infoSetKey(root, 0));
+    CHECK(CfrTrainer::infoSetKey(root, 1) != CfrTrainer::infoSetKey(root, 0));
+    other.seat(0).spyTarget = 1;
+    other.seat(0).role = RoleId::Spy;
+    root.seat(0).spyTarget = 1;
+    root.seat(0).role = RoleId::Spy;
+    CHECK(CfrTrainer::infoSetKey(other, 0) != CfrTrainer::infoSetKey(root, 0));
+
+    // A checkpoint restores the same strategy
+    CfrTrainer restored(config);
+    restored.load(config.checkpointPath);
+    CHECK(restored.table().size() == trainer.table().size());
+    root.seat(0).role = RoleId::Governor;
+    root.seat(0).spyTarget = -1;
+    MoveList restoredMoves;
+    double restoredProbabilities[MAX_MOVES];
+    restored.averageStrategy(root, 0, restoredMoves, restoredProbabilities);
+    REQUIRE(restoredMoves.size() == moves.size());
+    for (std::size_t m = 0; m < moves.size(); ++m) CHECK(restoredProbabilities[m] == doctest::Approx(probabilities[m]));
+    CHECK_THROWS_AS(restored.load(config.checkpointPath), GameException);
+    std::remove(config.checkpointPath.c_str());
+
+    CfrConfig invalid;
+    invalid.horizon = 0;
+    CHECK_THROWS_AS(CfrTrainer{invalid}, GameException);
+}
+
+// Counts heap allocations made by the whole test binary, so a test can check
+// that a piece of code does not allocate
+static std::atomic<std::size_t> heapAllocations{0};
+
+void* operator new(std::size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+// Optimized builds inline these into callers and then take the malloc/free
+// pair for a mismatch with new/delete
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+#pragma GCC diagnostic pop
+
+TEST_CASE("Agents decide without allocating") {
+    const RoleId roles[] = {RoleId::Governor, RoleId::Spy, RoleId::Baron, RoleId::Merchant};
+    GameState state = rules::initialState(roles, 4);
+    std::mt19937_64 rng(7);
+    MoveList legal;
+
+    RandomAgent random;
+    GreedyCoinsAgent greedy;
+    CoupFirstAgent coupFirst;
+    RoleAwareAgent roleAware;
+    Agent* agents[] = {&random, &greedy, &coupFirst, &roleAware};
+
+    // Agents play each other; every decision must be one of the legal moves
+    std::size_t before = heapAllocations.load();
+    int illegal = 0;
+    int turnActions = 0;
+    for (int ply = 0; ply < 2000 && !rules::isGameOver(state); ++ply) {
+        int seat = state.currentTurn;
+        rules::legalMoves(state, seat, legal);
+        if (legal.empty()) {
+            rules::nextTurn(state);
+            turnActions = 0;
+            continue;
+        }
+        Move move = agents[seat]->decide(GameView{state, seat, legal, turnActions, rng});
+        if (!legal.contains(move)) ++illegal;
+        advance(state, move, turnActions);
+    }
+    std::size_t allocations = heapAllocations.load() - before;
+    CHECK(allocations == 0);
+    CHECK(illegal == 0);
+
+    // Role specific choices
+    const RoleId duel[] = {RoleId::Governor, RoleId::Baron};
+    state = rules::initialState(duel, 2);
+    state.seat(0).coins = 2;
+    state.seat(1).coins = 4;
+    state.seat(1).pending = 1u << static_cast<unsigned>(ActionType::Tax);
+    rules::legalMoves(state, 0, legal);
+    CHECK((roleAware.decide(GameView{state, 0, legal, 0, rng}) == Move{MoveType::Undo, 1}));
+    CHECK((coupFirst.decide(GameView{state, 0, legal, 0, rng}) == Move{MoveType::Tax, -1}));
+    state.seat(0).coins = 8;
+    rules::legalMoves(state, 0, legal);
+    CHECK((roleAware.decide(GameView{state, 0, legal, 0, rng}) == Move{MoveType::Coup, 1}));
+
+    state.currentTurn = 1;
+    state.seat(1).pending = 0;
+    state.seat(0).coins = 7;
+    rules::legalMoves(state, 1, legal);
+    CHECK((roleAware.decide(GameView{state, 1, legal, 0, rng}) == Move{MoveType::Arrest, 0}));
+    CHECK((coupFirst.decide(GameView{state, 1, legal, 0, rng}) == Move{MoveType::Invest, -1}));
+    // Arresting an 8-coin Governor would leave it able to coup
+    state.seat(0).coins = 8;
+    rules::legalMoves(state, 1, legal);
+    CHECK_FALSE((roleAware.decide(GameView{state, 1, legal, 0, rng}) == Move{MoveType::Arrest, 0}));
+
+    CHECK(std::string(makeAgentFactory("role-aware")()->name()) == "role-aware");
+    CHECK_THROWS_AS(makeAgentFactory("nobody"), GameException);
+}
+
+TEST_CASE("Round robin tournament") {
+    TournamentConfig config;
+    config.agents = {"random", "coup-first", "role-aware"};
+    config.roles = {RoleId::Governor, RoleId::Baron};
+    config.gamesPerMatch = 5;
+    config.threads = 3;
+    Tournament tournament(config);
+    CHECK(tournament.totalGames() == 3 * 2 * 2 * 2 * 5);
+
+    TournamentResult result = tournament.run();
+    CHECK(result.games == tournament.totalGames());
+    std::uint64_t decided = 0;
+    for (std::uint64_t wins : result.wins) decided += wins;
+    CHECK(decided + result.draws == result.games);
+    REQUIRE(result.standings.size() == 3);
+    for (const AgentStanding& standing : result.standings) {
+        CHECK(standing.games == 2 * 2 * 2 * 2 * 5); // Two opponents, both seats, four role assignments
+        CHECK(standing.eloMargin > 0.0);
+    }
+    double mean = (result.standings[0].elo + result.standings[1].elo + result.standings[2].elo) / 3.0;
+    CHECK(mean == doctest::Approx(1500.0));
+
+    // Matches are seeded by index, so the thread count does not change the results
+    config.threads = 1;
+    CHECK(Tournament(config).run().wins == result.wins);
+
+    // A stronger record gives a higher rating
+    TournamentResult synthetic;
+    synthetic.agentCount = 2;
+    synthetic.wins = {0, 30, 10, 0};
+    synthetic.drawn = {0, 0, 0, 0};
+    Tournament::rate(synthetic);
+    CHECK(synthetic.standings[0].elo > synthetic.standings[1].elo);
+    CHECK(synthetic.standings[0].elo - synthetic.standings[1].elo == doctest::Approx(400.0 * std::log10(30.5 / 10.5)));
+
+    config.agents = {"random"};
+    CHECK_THROWS_AS(Tournament{config}, GameException);
+}
+
+TEST_CASE("Self-play data generator") {
+    SelfPlayConfig config;
+    config.path = "test_selfplay.bin";
+    config.players = 3;
+    config.agents = {"role-aware", "greedy"};
+    config.chunkRecords = 500;
+    SelfPlayResult result = SelfPlayGenerator(config).run(40, 3);
+    CHECK(result.games == 40);
+    CHECK(result.records > 0);
+    CHECK(result.chunks > 1);
+
+    // Every record reads back whole, with a legal chosen move and one outcome per game
+    SelfPlayReader reader(config.path);
+    SelfPlayChunk chunk;
+    std::uint64_t records = 0;
+    std::uint64_t chunks = 0;
+    int illegal = 0;
+    int mixedOutcomes = 0;
+    while (reader.next(chunk)) {
+        ++chunks;
+        records += chunk.size();
+        for (std::size_t r = 0; r < chunk.size(); ++r) {
+            if (!chunk.isLegal(r, chunk.move[r])) ++illegal;
+            if (r > 0 && chunk.game[r] == chunk.game[r - 1] && chunk.seat[r] == chunk.seat[r - 1] &&
+                chunk.outcome[r] != chunk.outcome[r - 1])
+                ++mixedOutcomes;
+        }
+        CHECK(chunk.features[1][0] == 3);
+    }
+    CHECK(records == result.records);
+    CHECK(chunks == result.chunks);
+    CHECK(illegal == 0);
+    CHECK(mixedOutcomes == 0);
+
+    // The records do not depend on the thread count
+    CHECK(SelfPlayGenerator(config).run(40, 1).records == result.records);
+    std::remove(config.path.c_str());
+
+    // Features are relative to the mover
+    const RoleId roles[] = {RoleId::Governor, RoleId::Spy, RoleId::Baron};
+    GameState state = rules::initialState(roles, 3);
+    state.seat(2).coins = 5;
+    state.seat(2).lastArrested = 0;
+    std::int16_t features[FEATURE_COUNT];
+    extractFeatures(state, 2, 1, features);
+    CHECK(features[2] == 1);
+    CHECK(features[3] == 5);
+    CHECK(features[4] == static_cast<std::int16_t>(RoleId::Baron));
+    CHECK(features[7] == 1);
+    CHECK(features[3 + 3 * FEATURES_PER_SEAT + 1] == -1);
+    CHECK((moveFromIndex(moveIndex(Move{MoveType::Coup, 4})) == Move{MoveType::Coup, 4}));
+
+    config.players = 7;
+    CHECK_THROWS_AS(SelfPlayGenerator{config}, GameException);
+    CHECK_THROWS_AS(SelfPlayReader{"missing_selfplay.bin"}, GameException);
+}
+
+TEST_CASE("Batched linear evaluation") {
+    const RoleId roles[] = {RoleId::Governor, RoleId::Spy, RoleId::Baron};
+    GameState state = rules::initialState(roles, 3);
+    state.seat(0).coins = 10;
+    state.seat(1).coins = 7;
+    state.seat(1).flags |= SEAT_SANCTIONED;
+    state.seat(2).flags &= static_cast<std::uint8_t>(~SEAT_ACTIVE);
+
+    // Features come out in columns, one value per position
+    PositionBatch batch(37);
+    batch.add(state, 0);
+    CHECK(batch.feature(0, EvalFeature::Coins) == 10.0f);
+    CHECK(batch.feature(0, EvalFeature::CanCoup) == 1.0f);
+    CHECK(batch.feature(0, EvalFeature::MustCoup) == 1.0f);
+    CHECK(batch.feature(0, EvalFeature::Opponents) == 1.0f);
+    CHECK(batch.feature(0, EvalFeature::OpponentThreats) == 1.0f);
+    CHECK(batch.feature(0, EvalFeature::OpponentsSanctioned) == 1.0f);
+    CHECK(batch.feature(0, EvalFeature::Governor) == 1.0f);
+    CHECK(batch.feature(0, EvalFeature::Spy) == 0.0f);
+    Game game;
+    game.setEventSink(nullptr);
+    for (const char* role : {"Governor", "Spy", "Baron"}) game.addPlayer(createPlayer(game, role, role));
+    game.startGame();
+    game.restore(state);
+    batch.add(game, 1);
+    CHECK(batch.feature(1, EvalFeature::Sanctioned) == 1.0f);
+    CHECK(batch.feature(1, EvalFeature::RichestOpponent) == 10.0f);
+
+    // A batch that is not a multiple of the vector width scores the same on both paths
+    std::mt19937_64 rng(3);
+    while (!batch.full()) {
+        GameState position = rules::initialState(roles, 3);
+        randomPlayout(position, randomBelow(rng, 40), 0, rng);
+        batch.add(position, position.currentTurn);
+    }
+    CHECK_THROWS_AS(batch.add(state, 0), GameException);
+    EvalWeights weights = EvalWeights::defaults();
+    float fast[37];
+    float scalar[37];
+    evaluate(weights, batch, fast);
+    evaluateScalar(weights, batch, scalar);
+    for (std::size_t i = 0; i < batch.size(); ++i) CHECK(fast[i] == doctest::Approx(scalar[i]));
+    EvalWeights coins;
+    coins.bias = 2.0f;
+    coins[EvalFeature::Coins] = 0.5f;
+    evaluate(coins, batch, fast);
+    CHECK(fast[0] == doctest::Approx(7.0));
+
+    // The linear agent takes the coup and decides without allocating
+    LinearAgent agent;
+    state.seat(2).flags |= SEAT_ACTIVE;
+    state.seat(0).coins = 8;
+    MoveList legal;
+    rules::legalMoves(state, 0, legal);
+    std::size_t before = heapAllocations.load();
+    Move move = agent.decide(GameView{state, 0, legal, 0, rng});
+    CHECK(heapAllocations.load() == before);
+    CHECK((move.type == MoveType::Coup));
+    CHECK(std::string(makeAgentFactory("linear")()->name()) == "linear");
+}
+
+TEST_CASE("Particle filter beliefs over hidden coins") {
+    const RoleId roles[] = {RoleId::Spy, RoleId::Baron, RoleId::Merchant};
+    GameState truth = rules::initialState(roles, 3);
+    truth.seat(0).coins = 2;
+    truth.seat(1).coins = 8;
+    truth.seat(2).coins = 1;
+    truth.bank = 89;
+    truth.currentTurn = 1;
+
+    BeliefConfig config;
+    config.particles = 300;
+    BeliefTracker tracker(truth, 0, config);
+    CHECK(tracker.expectedCoins(1) + tracker.expectedCoins(2) == doctest::Approx(9.0));
+    CHECK(tracker.expectedCoins(0) == doctest::Approx(2.0));
+    double prior = tracker.probabilityAtLeast(1, 7);
+    CHECK(prior < 0.5);
+
+    // A coup proves the Baron had 7 coins or more
+    Move coup{MoveType::Coup, 2};
+    REQUIRE((rules::apply(truth, 1, coup) == MoveStatus::Ok));
+    tracker.observe(1, coup, truth);
+    CHECK(tracker.resets() == 0);
+    CHECK(tracker.resamples() == 1);
+    CHECK(tracker.effectiveSampleSize() == doctest::Approx(300.0));
+    int inconsistent = 0;
+    for (std::size_t i = 0; i < tracker.size(); ++i)
+        if (tracker.particle(i).seat(1).coins > 2 || tracker.particle(i).seat(2).active()) ++inconsistent;
+    CHECK(inconsistent == 0);
+
+    // Searches determinize from the beliefs; everything public is left alone
+    auto determinizer = tracker.determinizer();
+    std::mt19937_64 rng(5);
+    int mismatched = 0;
+    for (int draw = 0; draw < 50; ++draw) {
+        GameState sample = truth;
+        determinizer->determinize(sample, 0, rng);
+        if (sample.seat(1).coins + sample.seat(2).coins != 2 || !samePublicView(sample, truth, 0)) ++mismatched;
+    }
+    CHECK(mismatched == 0);
+    CHECK_THROWS_AS(determinizer->determinize(truth, 1, rng), GameException);
+    IsmctsConfig search;
+    search.budget.iterations = 200;
+    rules::apply(truth, 0, Move{MoveType::Gather, -1});
+    tracker.observe(0, Move{MoveType::Gather, -1}, truth);
+    rules::nextTurn(truth); // The Baron passes
+    tracker.observePass(truth);
+    CHECK(truth.currentTurn == 0);
+    MoveList legal;
+    rules::legalMoves(truth, 0, legal);
+    CHECK(legal.contains(Ismcts(search, tracker.determinizer()).search(truth, 0).best));
+
+    // Spying shows the exact purse
+    Move spy{MoveType::SpyOn, 1};
+    rules::apply(truth, 0, spy);
+    tracker.observe(0, spy, truth);
+    CHECK(tracker.expectedCoins(1) == doctest::Approx(truth.seat(1).coins));
+    CHECK(tracker.probabilityAtLeast(1, truth.seat(1).coins + 1) == 0.0);
+
+    // An observation nothing explains starts the beliefs over
+    GameState impossible = truth;
+    impossible.bank -= 1;
+    impossible.seat(1).coins += 1;
+    tracker.observePass(impossible);
+    CHECK(tracker.resets() == 1);
+
+    config.particles = 0;
+    CHECK_THROWS_AS(BeliefTracker(truth, 0, config), GameException);
+}
+
+TEST_CASE("Sharded game host") {
+    std::atomic<std::uint64_t> sum{0};
+    {
+        WorkStealingPool pool(3, [&sum](std::uint32_t job) { sum.fetch_add(job, std::memory_order_relaxed); });
+        CHECK(pool.threads() == 3);
+        for (std::uint32_t job = 1; job <= 1000; ++job) pool.push(job);
+        while (sum.load() != 500500) std::this_thread::yield();
+    }
+    CHECK(sum.load() == 500500);
+
+    GameHostConfig config;
+    config.threads = 3;
+    config.shards = 8;
+    GameHost host(config);
+    const std::vector<RoleId> roles = {RoleId::Governor, RoleId::Merchant};
+    const int games = 40;
+    for (int g = 0; g < games; ++g) CHECK(host.createGame(roles) == static_cast<GameId>(g));
+    host.drain();
+    CHECK(host.liveGames() == games);
+    CHECK(host.shardOf(13) == 5);
+
+    // Moves run on the game's shard and report their status there
+    std::atomic<int> accepted{0};
+    std::atomic<int> refused{0};
+    for (int g = 0; g < games; ++g) {
+        host.submit(static_cast<GameId>(g), 0, Move{MoveType::Gather, -1}, [&accepted](Game& game, MoveStatus status) {
+            if (status == MoveStatus::Ok && game.getBank() == 99 && game.getPlayer(0)->coins() == 1) ++accepted;
+        });
+        host.submit(static_cast<GameId>(g), 0, Move{MoveType::Gather, -1}, [&refused](Game&, MoveStatus status) {
+            if (status == MoveStatus::NotYourTurn) ++refused;
+        });
+    }
+    host.drain();
+    CHECK(accepted.load() == games);
+    CHECK(refused.load() == games);
+    CHECK(host.movesPlayed() == games);
+
+    // Per game state needs no locks, and commands keep their submission order
+    std::vector<std::vector<int>> order(games);
+    for (int i = 0; i < 100; ++i)
+        for (int g = 0; g < games; ++g)
+            host.post(static_cast<GameId>(g), [&order, g, i](Game&, MoveStatus) { order[static_cast<size_t>(g)].push_back(i); });
+    host.drain();
+    int outOfOrder = 0;
+    for (const auto& seen : order)
+        if (seen.size() != 100 || !std::is_sorted(seen.begin(), seen.end())) ++outOfOrder;
+    CHECK(outOfOrder == 0);
+
+    host.closeGame(3);
+    host.submit(3, 1, Move{MoveType::Gather, -1});
+    host.drain();
+    CHECK(host.liveGames() == games - 1);
+    CHECK(host.droppedCommands() == 1);
+    CHECK_THROWS_AS(host.createGame({RoleId::Spy}), GameException);
+
+    // A throwing callback is counted instead of taking its thread down
+    host.post(4, [](Game&, MoveStatus) { throw GameException("callback failed"); });
+    host.submit(4, 1, Move{MoveType::Gather, -1}, [](Game&, MoveStatus) { throw std::runtime_error("boom"); });
+    host.postToShard(0, [] { throw GameException("shard task failed"); });
+    host.drain();
+    CHECK(host.failedCallbacks() == 3);
+    CHECK(host.movesPlayed() == games + 1);
+    CHECK_THROWS_AS(host.post(4, nullptr), GameException);
+    CHECK_THROWS_AS(host.postToShard(0, nullptr), GameException);
+}
+
+TEST_CASE("Binary protocol game server") {
+    ServerConfig config;
+    config.port = 0;
+    config.loops = 2;
+    config.games.threads = 2;
+    config.maxPendingOutput = 64 * 1024;
+
+    // The same session over TCP and over a Unix domain socket
+    for (int transport = 0; transport < 2; ++transport) {
+        if (transport == 1) config.unixPath = "/tmp/coup_server_test_" + std::to_string(::getpid()) + ".sock";
+        CoupServer server(config);
+        server.start();
+        auto connect = [&]() {
+            return transport == 0 ? CoupClient::connectTcp("127.0.0.1", server.port()) : CoupClient::connectUnix(config.unixPath);
+        };
+        if (transport == 0) CHECK(server.port() > 0);
+
+        CoupClient client = connect();
+        GameId game = client.createGame({});
+        CHECK(client.addPlayer(game, RoleId::Governor, "A") == 0);
+        CHECK(client.addPlayer(game, RoleId::Spy, "B") == 1);
+        CHECK_THROWS_AS(client.addPlayer(game, RoleId::Judge, "A"), GameException);
+        CHECK_THROWS_AS(client.act(game, 0, Move{MoveType::Gather, -1}), GameException);
+        CHECK_THROWS_WITH(client.act(game, 1, Move{MoveType::Undo, 0}), "Game has not started");
+        client.startGame(game);
+        CHECK_THROWS_AS(client.startGame(game), GameException);
+
+        ActionReply reply = client.act(game, 0, Move{MoveType::Gather, -1});
+        CHECK((reply.status == MoveStatus::Ok));
+        CHECK(reply.currentTurn == 1);
+        CHECK(reply.bank == 99);
+        CHECK(reply.coins == 1);
+        CHECK((client.act(game, 0, Move{MoveType::Gather, -1}).status == MoveStatus::NotYourTurn));
+        CHECK((client.act(game, 1, Move{MoveType::SpyOn, 0}).status == MoveStatus::Ok));
+
+        // Any connection may play any game
+        CoupClient other = connect();
+        GameState state = other.state(game);
+        CHECK(state.started == 1);
+        CHECK(state.playerCount == 2);
+        CHECK(state.bank == 99);
+        CHECK(state.seat(0).coins == 1);
+        CHECK((state.seat(1).role == RoleId::Spy));
+        CHECK(state.seat(1).spyTarget == 0);
+        CHECK(state.seat(1).lastArrested == -1);
+        CHECK(state.seat(2).coins == 0);
+        CHECK_THROWS_AS(other.state(game + 1000), GameException);
+
+        // Many connections at once, each with a started game of its own
+        std::vector<CoupClient> clients;
+        for (int i = 0; i < 64; ++i) clients.push_back(connect());
+        int failures = 0;
+        for (CoupClient& c : clients) {
+            GameId own = c.createGame({RoleId::Baron, RoleId::General, RoleId::Merchant});
+            if (c.act(own, 0, Move{MoveType::Tax, -1}).coins != 2) ++failures;
+        }
+        CHECK(failures == 0);
+        CHECK(server.connections() == 66);
+
+        // A closed game is unknown to every connection, for actions and blocks alike
+        GameId closed = other.createGame({RoleId::Governor, RoleId::Merchant});
+        other.closeGame(closed);
+        CHECK_THROWS_WITH(client.state(closed), "Unknown game");
+        CHECK_THROWS_WITH(client.act(closed, 0, Move{MoveType::Gather, -1}), "Unknown game");
+        CHECK_THROWS_WITH(client.act(closed, 0, Move{MoveType::Undo, 1}), "Unknown game");
+        CHECK_THROWS_WITH(other.closeGame(closed), "Unknown game");
+
+        // A game is released once it is over and its last client has gone;
+        // an unfinished one stays for others to play
+        server.host().drain();
+        std::uint64_t live = server.host().liveGames();
+        GameId finished;
+        GameId unfinished;
+        {
+            CoupClient player = connect();
+            finished = player.createGame({RoleId::Governor, RoleId::Governor});
+            unfinished = player.createGame({RoleId::Governor, RoleId::Governor});
+            for (int turn = 0; turn < 6; ++turn) player.act(finished, turn % 2, Move{MoveType::Tax, -1});
+            CHECK(player.act(finished, 0, Move{MoveType::Coup, 1}).gameOver);
+            client.state(finished);     // Another client used it too
+        }
+        CHECK(server.host().liveGames() == live + 2);
+        client = connect();
+        for (int wait = 0; wait < 2000 && server.host().liveGames() != live + 1; ++wait)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        CHECK(server.host().liveGames() == live + 1);
+        CHECK_THROWS_WITH(other.state(finished), "Unknown game");
+        CHECK(other.state(unfinished).playerCount == 2);
+
+        // A body too short to carry a request id cannot be answered: the server hangs up
+        CoupClient garbled = connect();
+        garbled.sendRaw(std::string("\x02\x00\x05\x01", 4));
+        CHECK_THROWS_AS(garbled.state(game), GameException);
+
+        // A frame announcing a body over the limit loses framing: the server hangs up
+        CoupClient broken = connect();
+        broken.sendRaw(std::string("\xff\xff", 2));
+        CHECK_THROWS_AS(broken.state(game), GameException);
+
+        // A client that keeps asking but never reads is dropped once its
+        // replies pass maxPendingOutput
+        std::string requests;
+        for (std::uint32_t request = 1; request <= 1000; ++request) {
+            protocol::FrameWriter writer(requests, protocol::MessageType::GetState, request);
+            writer.u32(game);
+            writer.finish();
+        }
+        std::uint64_t before = server.connections();
+        CoupClient flooding = connect();
+        try {
+            for (int burst = 0; burst < 2000 && server.connections() != before; ++burst) flooding.sendRaw(requests);
+        } catch (const GameException&) {
+            // The server hung up mid-burst
+        }
+        for (int wait = 0; wait < 10000 && server.connections() != before; ++wait)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        CHECK(server.connections() == before);
+        server.stop();
+
+        // Stopping drains the games' replies, so the server starts again cleanly
+        server.start();
+        CoupClient restarted = connect();
+        CHECK(restarted.state(unfinished).playerCount == 2);
+        CHECK(restarted.act(unfinished, 0, Move{MoveType::Gather, -1}).coins == 1);
+        server.stop();
+    }
+}
+
+TEST_CASE("Lock-free reaction queue") {
+    // Several producers, one consumer: nothing is lost and each producer's
+    // nodes come out in the order it pushed them
+    struct Item : MpscNode {
+        int producer = 0;
+        int index = 0;
+    };
+    const int producers = 4;
+    const int perProducer = 2000;
+    std::vector<Item> items(static_cast<size_t>(producers * perProducer));
+    MpscQueue queue;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p)
+        threads.emplace_back([&items, &queue, p]() {
+            for (int i = 0; i < perProducer; ++i) {
+                Item& item = items[static_cast<size_t>(p * perProducer + i)];
+                item.producer = p;
+                item.index = i;
+                queue.push(&item);
+            }
+        });
+    std::vector<int> nextIndex(producers, 0);
+    int popped = 0;
+    int outOfOrder = 0;
+    while (popped < producers * perProducer) {
+        MpscNode* node = queue.pop();
+        if (!node) {
+            std::this_thread::yield();
+            continue;
+        }
+        const Item& item = *static_cast<Item*>(node);
+        if (item.index != nextIndex[static_cast<size_t>(item.producer)]++) ++outOfOrder;
+        ++popped;
+    }
+    for (auto& thread : threads) thread.join();
+    CHECK(outOfOrder == 0);
+    CHECK(queue.pop() == nullptr);
+
+    GameHostConfig config;
+    config.threads = 3;
+    config.shards = 4;
+    GameHost host(config);
+
+    // A Governor blocks a Merchant's tax while the Merchant's turn goes on.
+    // The block is pipelined behind the tax and still waits for it.
+    GameId game = host.createGame({RoleId::Merchant, RoleId::Governor});
+    host.submit(game, 0, Move{MoveType::Tax, -1});
+    MoveStatus undone = MoveStatus::IllegalMove;
+    int coinsAfter = -1;
+    host.react(game, 1, Move{MoveType::Undo, 0}, [&](Game& g, MoveStatus status) {
+        undone = status;
+        coinsAfter = g.getPlayer(0)->coins();
+    });
+    host.drain();
+    CHECK((undone == MoveStatus::Ok));
+    CHECK(coinsAfter == 0);
+
+    // The window closes once the blocked player starts its next turn
+    host.submit(game, 1, Move{MoveType::Gather, -1});
+    host.submit(game, 0, Move{MoveType::Tax, -1});
+    host.submit(game, 1, Move{MoveType::Gather, -1});
+    MoveStatus late = MoveStatus::Ok;
+    host.react(game, 1, Move{MoveType::Undo, 0}, [&late](Game&, MoveStatus status) { late = status; });
+    host.drain();
+    CHECK((late == MoveStatus::IllegalMove));
+
+    // Reactions from many threads race the turn player's moves; a reaction
+    // pushed before a move is submitted is judged before it
+    GameId spies = host.createGame({RoleId::Spy, RoleId::Spy, RoleId::Spy, RoleId::Spy});
+    std::vector<std::vector<int>> seen(3);
+    std::atomic<int> accepted{0};
+    threads.clear();
+    for (int t = 0; t < 3; ++t)
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < 500; ++i)
+                host.react(spies, t + 1, Move{MoveType::SpyOn, 0}, [&seen, &accepted, t, i](Game&, MoveStatus status) {
+                    if (status == MoveStatus::Ok) ++accepted;
+                    seen[static_cast<size_t>(t)].push_back(i);
+                });
+        });
+    for (auto& thread : threads) thread.join();
+    int before = -1;
+    host.submit(spies, 0, Move{MoveType::Gather, -1}, [&accepted, &before](Game&, MoveStatus) { before = accepted.load(); });
+    host.drain();
+    CHECK(accepted.load() == 1500);
+    CHECK(before == 1500);
+    int unordered = 0;
+    for (const auto& order : seen)
+        if (order.size() != 500 || !std::is_sorted(order.begin(), order.end())) ++unordered;
+    CHECK(unordered == 0);
+
+    // Reactions to games that are gone are dropped
+    std::uint64_t dropped = host.droppedCommands();
+    host.closeGame(game);
+    host.react(game, 1, Move{MoveType::Undo, 0});
+    host.react(host.gamesCreated() + 7, 1, Move{MoveType::Undo, 0});
+    host.drain();
+    CHECK(host.droppedCommands() == dropped + 2);
+}
+
+TEST_CASE("Coroutine turn flow") {
+    GameHostConfig hostConfig;
+    hostConfig.threads = 1;
+    GameHost host(hostConfig);
+
+    // Hooks run on the shard; the single thread makes plain containers safe
+    std::vector<std::pair<GameId, int>> awaited;
+    std::vector<std::uint32_t> windows;
+    int over = 0;
+    TurnFlow* driver = nullptr;
+    const GameId botsFrom = 1000;
+    std::mt19937_64 rng(7);
+    TurnFlowConfig config;
+    config.onAwaitMove = [&](GameId id, Game& game, int seat) {
+        if (id < botsFrom) {
+            awaited.emplace_back(id, seat);
+            return;
+        }
+        MoveList legal;
+        game.legalMoves(seat, legal);
+        driver->play(id, seat, legal[static_cast<size_t>(randomBelow(rng, static_cast<int>(legal.size())))]);
+    };
+    config.onReactionWindow = [&](GameId id, Game&, std::uint32_t blockers) {
+        if (id < botsFrom) windows.push_back(blockers);
+        else driver->closeWindow(id);
+    };
+    config.onGameOver = [&over](GameId, Game&) { ++over; };
+    TurnFlow flow(host, config);
+    driver = &flow;
+
+    GameId game = host.createGame({RoleId::Merchant, RoleId::Governor, RoleId::Judge});
+    flow.start(game);
+    host.drain();
+    REQUIRE(awaited.size() == 1);
+    CHECK(awaited.back().second == 0);
+    CHECK(flow.waitingGames() == 1);
+
+    std::vector<MoveStatus> replies;
+    auto record = [&replies](MoveStatus status) { replies.push_back(status); };
+    flow.play(game, 1, Move{MoveType::Gather, -1}, record);
+    flow.play(game, 0, Move{MoveType::Tax, -1}, record);
+    // The Governor may block the tax: seat 1 waits for the window to close
+    flow.play(game, 1, Move{MoveType::Gather, -1}, record);
+    host.drain();
+    REQUIRE(replies.size() == 3);
+    CHECK((replies[0] == MoveStatus::NotYourTurn));
+    CHECK((replies[1] == MoveStatus::Ok));
+    CHECK((replies[2] == MoveStatus::NotYourTurn));
+    REQUIRE(windows.size() == 1);
+    CHECK(windows[0] == 2u);
+    CHECK(awaited.size() == 1);
+
+    flow.react(game, 1, Move{MoveType::Undo, 0}, record);
+    int coins = -1;
+    host.post(game, [&coins](Game& g, MoveStatus) { coins = g.getPlayer(0)->coins(); });
+    host.drain();
+    CHECK((replies.back() == MoveStatus::Ok));
+    CHECK(coins == 0);
+    REQUIRE(awaited.size() == 2);
+    CHECK(awaited.back().second == 1);
+
+    // Turn moves cannot sneak in as reactions, not even from the awaited seat
+    int turn = -1;
+    flow.react(game, 1, Move{MoveType::Gather, -1}, record);
+    flow.react(game, 2, Move{MoveType::Arrest, 0}, record);
+    host.post(game, [&turn](Game& g, MoveStatus) { turn = g.snapshot().currentTurn; });
+    host.drain();
+    REQUIRE(replies.size() == 6);
+    CHECK((replies[4] == MoveStatus::NotYourTurn));
+    CHECK((replies[5] == MoveStatus::NotYourTurn));
+    CHECK(turn == 1);
+    CHECK(awaited.size() == 2);
+
+    // Passing or closing the window hands the turn on just as well
+    flow.play(game, 1, Move{MoveType::Gather, -1});
+    flow.play(game, 2, Move{MoveType::Gather, -1});
+    flow.play(game, 0, Move{MoveType::Tax, -1});
+    flow.pass(game, 1);
+    flow.play(game, 1, Move{MoveType::Gather, -1});
+    flow.play(game, 2, Move{MoveType::Gather, -1});
+    flow.play(game, 0, Move{MoveType::Tax, -1});
+    flow.closeWindow(game);
+    host.drain();
+    CHECK(windows.size() == 3);
+    CHECK(awaited.back().first == game);
+    CHECK(awaited.back().second == 1);
+
+    // Thousands of games wait at once without a thread each
+    for (GameId g = 1; g < botsFrom; ++g) flow.start(host.createGame({RoleId::Spy, RoleId::Baron}));
+    host.drain();
+    CHECK(flow.waitingGames() == botsFrom);
+
+    // Bots answer from the hooks, so their games run to the end
+    const int botGames = 100;
+    for (int g = 0; g < botGames; ++g) flow.start(host.createGame({RoleId::Governor, RoleId::Judge, RoleId::General}));
+    host.drain();
+    CHECK(over == botGames);
+    CHECK(flow.finishedGames() == botGames);
+    CHECK(flow.waitingGames() == botsFrom);
+
+    flow.stop(game);
+    host.drain();
+    CHECK(flow.waitingGames() == botsFrom - 1);
+    replies.clear();
+    flow.play(game, 1, Move{MoveType::Gather, -1}, record);
+    host.drain();
+    CHECK((replies.at(0) == MoveStatus::IllegalMove));
+
+    // Closing a driven game in the host stops its loop too, and moves for it
+    // are still answered
+    host.closeGame(1);
+    flow.play(1, 0, Move{MoveType::Gather, -1}, record);
+    host.drain();
+    CHECK(flow.waitingGames() == botsFrom - 2);
+    CHECK((replies.at(1) == MoveStatus::IllegalMove));
+
+    // A turn cap is opt-in, and a table where nobody can move is reported
+    // as stuck rather than finished
+    TurnFlowConfig cappedConfig;
+    cappedConfig.maxActionsPerTurn = 1;
+    std::vector<int> turns;
+    int stuck = 0;
+    cappedConfig.onAwaitMove = [&turns](GameId, Game&, int seat) { turns.push_back(seat); };
+    cappedConfig.onStuck = [&stuck](GameId, Game&) { ++stuck; };
+    TurnFlow capped(host, cappedConfig);
+    GameId spying = host.createGame({RoleId::Spy, RoleId::Baron});
+    capped.start(spying);
+    capped.play(spying, 0, Move{MoveType::SpyOn, 1});
+    host.drain();
+    CHECK(turns == std::vector<int>{0, 1});
+
+    GameId deadlocked = host.createGame({RoleId::Governor, RoleId::Governor});
+    host.post(deadlocked, [](Game& g, MoveStatus) {
+        GameState state = g.snapshot();
+        state.bank = 0;
+        state.seat(0).lastArrested = 1;
+        state.seat(1).lastArrested = 0;
+        g.restore(state);
+    });
+    capped.start(deadlocked);
+    host.drain();
+    CHECK(stuck == 1);
+    CHECK(capped.stuckGames() == 1);
+    CHECK(capped.finishedGames() == 0);
+}
+
+TEST_CASE("Timer wheel and turn clocks") {
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> fired;  // (tick, payload)
+    TimerWheel* current = nullptr;
+    TimerWheel wheel([&fired, &current](std::uint64_t data) { fired.emplace_back(current->now(), data); });
+    current = &wheel;
+
+    // Deadlines on every level fire on their tick, in deadline order
+    const std::uint64_t deadlines[] = {5, 1, 255, 256, 300, 70000, 65536, 20000000, 3};
+    for (std::uint64_t deadline : deadlines) wheel.schedule(deadline, deadline);
+    TimerId cancelled = wheel.schedule(1000, 1000);
+    CHECK(wheel.size() == 10);
+    CHECK(wheel.cancel(cancelled));
+    CHECK_FALSE(wheel.cancel(cancelled));
+    CHECK_FALSE(wheel.cancel(0));
+    wheel.advance(70000);
+    REQUIRE(fired.size() == 8);
+    int wrongTick = 0;
+    for (std::size_t i = 0; i < fired.size(); ++i) {
+        if (fired[i].first != fired[i].second) ++wrongTick;
+        if (i > 0 && fired[i].first < fired[i - 1].first) ++wrongTick;
+    }
+    CHECK(wrongTick == 0);
+    wheel.advance(20000000);
+    REQUIRE(fired.size() == 9);
+    CHECK(fired.back().first == 20000000);
+    CHECK(wheel.empty());
+
+    // Past deadlines fire on the next tick; a handle stays dead after firing
+    TimerId late = wheel.schedule(10, 42);
+    wheel.advance(20000001);
+    CHECK(fired.back() == std::make_pair(std::uint64_t(20000001), std::uint64_t(42)));
+    CHECK_FALSE(wheel.cancel(late));
+
+    // Churn: cancel half of many random timers, the rest fire exactly once
+    std::mt19937_64 rng(5);
+    std::vector<TimerId> ids;
+    fired.clear();
+    for (int i = 0; i < 5000; ++i) ids.push_back(wheel.schedule(wheel.now() + 1 + rng() % 100000, static_cast<std::uint64_t>(i)));
+    int cancelFailures = 0;
+    for (std::size_t i = 0; i < ids.size(); i += 2)
+        if (!wheel.cancel(ids[i])) ++cancelFailures;
+    CHECK(cancelFailures == 0);
+    wheel.advance(wheel.now() + 100000);
+    CHECK(fired.size() == 2500);
+    int evenFired = 0;
+    for (const auto& entry : fired)
+        if (entry.second % 2 == 0) ++evenFired;
+    CHECK(evenFired == 0);
+    CHECK_THROWS_AS(TimerWheel(nullptr), GameException);
+
+    // Hosted clocks play default moves: a coup when it is forced, else gather
+    GameHostConfig hostConfig;
+    hostConfig.threads = 1;
+    GameHost host(hostConfig);
+    TurnFlowConfig config;
+    config.turnMillis = 5;
+    config.reactionMillis = 5;
+    config.tickMillis = 1;
+    std::atomic<int> winner{-1};
+    config.onGameOver = [&winner](GameId, Game& game) { winner = rules::winner(game.snapshot()); };
+    TurnFlow flow(host, config);
+
+    GameId forced = host.createGame({RoleId::Spy, RoleId::Baron});
+    host.post(forced, [](Game& game, MoveStatus) {
+        GameState state = game.snapshot();
+        state.seat(0).coins = 10;
+        state.bank -= 10;
+        game.restore(state);
+    });
+    flow.start(forced);
+    GameId idle = host.createGame({RoleId::Merchant, RoleId::Governor});
+    flow.start(idle);
+    flow.play(idle, 0, Move{MoveType::Tax, -1});
+
+    auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while ((winner.load() < 0 || flow.timeouts() < 6) && std::chrono::steady_clock::now() < until)
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    CHECK(winner.load() == 0);
+    CHECK(flow.finishedGames() == 1);
+    CHECK(flow.timeouts() >= 6);
+
+    // The idle game's tax window closed on its own, then both seats gathered
+    std::atomic<int> bank{0};
+    std::atomic<int> governorCoins{0};
+    host.post(idle, [&](Game& game, MoveStatus) {
+        bank = game.getBank();
+        governorCoins = game.getPlayer(1)->coins();
+    });
+    host.drain();
+    CHECK(governorCoins.load() >= 1);
+    CHECK(bank.load() < 98);
+
+    // Closing a game whose clock is running disarms it
+    host.closeGame(idle);
+    host.drain();
+    std::uint64_t timeouts = flow.timeouts();
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    CHECK(flow.timeouts() == timeouts);
+    CHECK(flow.waitingGames() == 0);
+}